@@ -0,0 +1,264 @@
+/***
+* btree_map / btree_multimap：以 B-tree 为底层机制的 map，接口与 map.h 相同。
+* 每个节点连续存放多个 pair，查找只需访问少数几个节点，每个元素的内存开销也远小于 map。
+* 与 map 不同的是，任何插入、删除操作都会使所有迭代器失效。
+*/
+#ifndef _SIMPLE_STL_BTREE_MAP_H_
+#define _SIMPLE_STL_BTREE_MAP_H_
+
+#include <functional>
+#include "memory.h"
+#include "stl_btree.h"
+
+namespace SimpleSTL
+{
+    template <class Key, class T,
+              class Compare = less<Key>,
+              class Alloc = alloc2,
+              size_t NodeSlots = 0>
+    class btree_map
+    {
+    public:
+        typedef Key key_type;
+        typedef T data_type;
+        typedef T mapped_type;
+        typedef pair<const Key, T> value_type;
+        typedef Compare key_compare;
+
+        class value_compare
+            : public binary_function<value_type, value_type, bool>
+        {
+            friend class btree_map<Key, T, Compare, Alloc, NodeSlots>;
+            protected:
+                Compare comp;
+                value_compare(Compare c) : comp(c) {}
+            public:
+                bool operator()(const value_type &x, const value_type &y) const
+                {
+                    return comp(x.first, y.first);
+                }
+        };
+
+    private:
+        template <class X>
+        struct select1st : public unary_function<X, typename X::first_type> {
+        	const typename X::first_type& operator()(const X& x) const { return x.first; }
+        };
+        typedef btree<key_type, value_type,
+                      select1st<value_type>, key_compare, Alloc, NodeSlots> rep_type;
+        rep_type t;
+
+    public:
+        typedef typename rep_type::pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        // 与 map 相同，允许通过迭代器修改元素的实值
+        typedef typename rep_type::iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        btree_map() : t(Compare()) {}
+        explicit btree_map(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        btree_map(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_unique(first, last); }
+
+        template <class InputIterator>
+        btree_map(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_unique(first, last); }
+
+        btree_map(const btree_map<Key, T, Compare, Alloc, NodeSlots> &x) : t(x.t) {}
+        btree_map<Key, T, Compare, Alloc, NodeSlots> &
+        operator=(const btree_map<Key, T, Compare, Alloc, NodeSlots> &x)
+        {
+            t = x.t;
+            return *this;
+        }
+
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return value_compare(t.key_comp()); }
+        iterator begin() { return t.begin(); }
+        const_iterator begin() const { return t.begin(); }
+        iterator end() { return t.end(); }
+        const_iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+
+        T& operator[](const key_type &k)
+        {
+            return (*((insert(value_type(k, T()))).first)).second;
+        }
+        void swap(btree_map<Key, T, Compare, Alloc, NodeSlots> &x) { t.swap(x.t); }
+
+        pair<iterator, bool> insert(const value_type &x)
+        {
+            return t.insert_unique(x);
+        }
+
+        iterator insert(iterator position, const value_type &x)
+        {
+            return t.insert_unique(position, x);
+        }
+
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last) { t.erase(first, last); }
+        void clear() { t.clear(); }
+
+        iterator find(const key_type &x) { return t.find(x); }
+        const_iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) const
+        {
+            return t.lower_bound(x);
+        }
+        iterator upper_bound(const key_type &x) const
+        {
+            return t.upper_bound(x);
+        }
+        pair<iterator, iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const btree_map<Key, T, Compare, Alloc, NodeSlots> &x,
+                               const btree_map<Key, T, Compare, Alloc, NodeSlots> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const btree_map<Key, T, Compare, Alloc, NodeSlots> &x,
+                              const btree_map<Key, T, Compare, Alloc, NodeSlots> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+
+    // btree_multimap 允许键值重复，插入一律使用 insert_equal()，因此没有 operator[]
+    template <class Key, class T,
+              class Compare = less<Key>,
+              class Alloc = alloc2,
+              size_t NodeSlots = 0>
+    class btree_multimap
+    {
+    public:
+        typedef Key key_type;
+        typedef T data_type;
+        typedef T mapped_type;
+        typedef pair<const Key, T> value_type;
+        typedef Compare key_compare;
+
+        class value_compare
+            : public binary_function<value_type, value_type, bool>
+        {
+            friend class btree_multimap<Key, T, Compare, Alloc, NodeSlots>;
+            protected:
+                Compare comp;
+                value_compare(Compare c) : comp(c) {}
+            public:
+                bool operator()(const value_type &x, const value_type &y) const
+                {
+                    return comp(x.first, y.first);
+                }
+        };
+
+    private:
+        template <class X>
+        struct select1st : public unary_function<X, typename X::first_type> {
+        	const typename X::first_type& operator()(const X& x) const { return x.first; }
+        };
+        typedef btree<key_type, value_type,
+                      select1st<value_type>, key_compare, Alloc, NodeSlots> rep_type;
+        rep_type t;
+
+    public:
+        typedef typename rep_type::pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        btree_multimap() : t(Compare()) {}
+        explicit btree_multimap(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        btree_multimap(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_equal(first, last); }
+
+        template <class InputIterator>
+        btree_multimap(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_equal(first, last); }
+
+        btree_multimap(const btree_multimap<Key, T, Compare, Alloc, NodeSlots> &x) : t(x.t) {}
+        btree_multimap<Key, T, Compare, Alloc, NodeSlots> &
+        operator=(const btree_multimap<Key, T, Compare, Alloc, NodeSlots> &x)
+        {
+            t = x.t;
+            return *this;
+        }
+
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return value_compare(t.key_comp()); }
+        iterator begin() { return t.begin(); }
+        const_iterator begin() const { return t.begin(); }
+        iterator end() { return t.end(); }
+        const_iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+        void swap(btree_multimap<Key, T, Compare, Alloc, NodeSlots> &x) { t.swap(x.t); }
+
+        iterator insert(const value_type &x) { return t.insert_equal(x); }
+        iterator insert(iterator, const value_type &x) { return t.insert_equal(x); }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_equal(first, last);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last) { t.erase(first, last); }
+        void clear() { t.clear(); }
+
+        iterator find(const key_type &x) { return t.find(x); }
+        const_iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) const
+        {
+            return t.lower_bound(x);
+        }
+        iterator upper_bound(const key_type &x) const
+        {
+            return t.upper_bound(x);
+        }
+        pair<iterator, iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const btree_multimap<Key, T, Compare, Alloc, NodeSlots> &x,
+                               const btree_multimap<Key, T, Compare, Alloc, NodeSlots> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const btree_multimap<Key, T, Compare, Alloc, NodeSlots> &x,
+                              const btree_multimap<Key, T, Compare, Alloc, NodeSlots> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+}
+#endif
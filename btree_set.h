@@ -0,0 +1,231 @@
+/***
+* btree_set / btree_multiset：以 B-tree 为底层机制的 set，接口与 set.h 相同。
+* 元素连续存放在宽节点中，查找的 cache miss 与每个元素的内存开销都远小于 set。
+* 与 set 不同的是，任何插入、删除操作都会使所有迭代器失效。
+*/
+#ifndef _SIMPLE_STL_BTREE_SET_H_
+#define _SIMPLE_STL_BTREE_SET_H_
+
+#include "stl_btree.h"
+#include "memory.h"
+#include "stl_iterator.h"
+#include <utility>
+
+namespace SimpleSTL
+{
+    template <class Key, class Compare = less<Key>, class Alloc = alloc2,
+              size_t NodeSlots = 0>
+    class btree_set
+    {
+    public:
+        typedef Key key_type;
+        typedef Key value_type;
+        typedef Compare key_compare;
+        typedef Compare value_compare;
+
+    private:
+        template <class T>
+        struct identity : public unary_function<T, T> {
+            const T& operator()(const T& x) const { return x; }
+        };
+        typedef btree<key_type, value_type,
+                      identity<value_type>, key_compare, Alloc, NodeSlots> rep_type;
+        rep_type t; // 采用 B-tree 来表现 btree_set
+
+    public:
+        typedef typename rep_type::const_pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::const_reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        // 与 set 相同，iterator 即 const_iterator，不允许通过迭代器改写元素
+        typedef typename rep_type::const_iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        btree_set() : t(Compare()) {}
+        explicit btree_set(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        btree_set(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_unique(first, last); }
+
+        template <class InputIterator>
+        btree_set(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_unique(first, last); }
+
+        btree_set(const btree_set<Key, Compare, Alloc, NodeSlots> &x) : t(x.t) {}
+
+        btree_set<Key, Compare, Alloc, NodeSlots> &
+        operator=(const btree_set<Key, Compare, Alloc, NodeSlots> &x)
+        {
+            t = x.t;
+            return *this;
+        }
+
+        // accessors:
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return t.key_comp(); }
+        iterator begin() const { return t.begin(); }
+        iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+        void swap(btree_set<Key, Compare, Alloc, NodeSlots> &x) { t.swap(x.t); }
+
+        typedef pair<iterator, bool> pair_iterator_bool;
+        pair_iterator_bool insert(const value_type &x)
+        {
+            pair<typename rep_type::iterator, bool> p = t.insert_unique(x);
+            return pair<iterator, bool>(p.first, p.second);
+        }
+        iterator insert(iterator position, const value_type &x)
+        {
+            typedef typename rep_type::iterator rep_iterator;
+            return t.insert_unique((rep_iterator &)position, x);
+        }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+
+        void erase(iterator position)
+        {
+            typedef typename rep_type::iterator rep_iterator;
+            t.erase((rep_iterator &)position);
+        }
+        size_type erase(const key_type &x)
+        {
+            return t.erase(x);
+        }
+        void erase(iterator first, iterator last)
+        {
+            typedef typename rep_type::iterator rep_iterator;
+            t.erase((rep_iterator &)first, (rep_iterator &)last);
+        }
+
+        void clear() { t.clear(); }
+        iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        std::pair<iterator, iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const btree_set<Key, Compare, Alloc, NodeSlots> &x,
+                               const btree_set<Key, Compare, Alloc, NodeSlots> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const btree_set<Key, Compare, Alloc, NodeSlots> &x,
+                              const btree_set<Key, Compare, Alloc, NodeSlots> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+
+    // btree_multiset 与 btree_set 唯一的差别在于插入使用 insert_equal()
+    template <class Key, class Compare = less<Key>, class Alloc = alloc2,
+              size_t NodeSlots = 0>
+    class btree_multiset
+    {
+    public:
+        typedef Key key_type;
+        typedef Key value_type;
+        typedef Compare key_compare;
+        typedef Compare value_compare;
+
+    private:
+        template <class T>
+        struct identity : public unary_function<T, T> {
+            const T& operator()(const T& x) const { return x; }
+        };
+        typedef btree<key_type, value_type,
+                      identity<value_type>, key_compare, Alloc, NodeSlots> rep_type;
+        rep_type t;
+
+    public:
+        typedef typename rep_type::const_pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::const_reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::const_iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        btree_multiset() : t(Compare()) {}
+        explicit btree_multiset(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        btree_multiset(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_equal(first, last); }
+
+        template <class InputIterator>
+        btree_multiset(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_equal(first, last); }
+
+        btree_multiset(const btree_multiset<Key, Compare, Alloc, NodeSlots> &x) : t(x.t) {}
+
+        btree_multiset<Key, Compare, Alloc, NodeSlots> &
+        operator=(const btree_multiset<Key, Compare, Alloc, NodeSlots> &x)
+        {
+            t = x.t;
+            return *this;
+        }
+
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return t.key_comp(); }
+        iterator begin() const { return t.begin(); }
+        iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+        void swap(btree_multiset<Key, Compare, Alloc, NodeSlots> &x) { t.swap(x.t); }
+
+        iterator insert(const value_type &x) { return t.insert_equal(x); }
+        iterator insert(iterator, const value_type &x) { return t.insert_equal(x); }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_equal(first, last);
+        }
+
+        void erase(iterator position)
+        {
+            typedef typename rep_type::iterator rep_iterator;
+            t.erase((rep_iterator &)position);
+        }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last)
+        {
+            typedef typename rep_type::iterator rep_iterator;
+            t.erase((rep_iterator &)first, (rep_iterator &)last);
+        }
+
+        void clear() { t.clear(); }
+        iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        std::pair<iterator, iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const btree_multiset<Key, Compare, Alloc, NodeSlots> &x,
+                               const btree_multiset<Key, Compare, Alloc, NodeSlots> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const btree_multiset<Key, Compare, Alloc, NodeSlots> &x,
+                              const btree_multiset<Key, Compare, Alloc, NodeSlots> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+}
+#endif
@@ -0,0 +1,118 @@
+/***
+* concurrent_map：以无锁跳表为底层机制的 map（键值不重复），多个线程可以同时插入、删除、查找与遍历，不必加锁。
+* 接口取 map.h 中可以安全并发的部分：
+*   1. 迭代器为常量前向迭代器，其他线程可能同时读取元素，不能经由迭代器或 operator[] 修改实值；
+*   2. 迭代器只保证看见遍历期间一直存在的元素，不能跨线程使用；
+*   3. size() 在有其他线程修改时只是近似值；
+*   4. 不提供复制、swap 与比较运算，这些操作无法与其他线程的修改同时进行。
+*/
+#ifndef _SIMPLE_STL_CONCURRENT_MAP_H_
+#define _SIMPLE_STL_CONCURRENT_MAP_H_
+
+#include <functional>
+#include "memory.h"
+#include "stl_skiplist.h"
+
+namespace SimpleSTL
+{
+    template <class Key, class T,
+              class Compare = less<Key>,
+              class Alloc = alloc1>
+    class concurrent_map
+    {
+    public:
+        typedef Key key_type;
+        typedef T data_type;
+        typedef T mapped_type;
+        typedef pair<const Key, T> value_type;
+        typedef Compare key_compare;
+
+        class value_compare
+            : public binary_function<value_type, value_type, bool>
+        {
+            friend class concurrent_map<Key, T, Compare, Alloc>;
+            protected:
+                Compare comp;
+                value_compare(Compare c) : comp(c) {}
+            public:
+                bool operator()(const value_type &x, const value_type &y) const
+                {
+                    return comp(x.first, y.first);
+                }
+        };
+
+    private:
+        template <class X>
+        struct select1st : public unary_function<X, typename X::first_type> {
+        	const typename X::first_type& operator()(const X& x) const { return x.first; }
+        };
+        typedef concurrent_skiplist<key_type, value_type,
+                                    select1st<value_type>, key_compare, Alloc> rep_type;
+        rep_type t;
+
+    public:
+        typedef typename rep_type::const_pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::const_reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::const_iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        concurrent_map() : t(Compare()) {}
+        explicit concurrent_map(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        concurrent_map(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_unique(first, last); }
+
+        template <class InputIterator>
+        concurrent_map(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_unique(first, last); }
+
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return value_compare(t.key_comp()); }
+        const_iterator begin() const { return t.begin(); }
+        const_iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+
+        pair<iterator, bool> insert(const value_type &x)
+        {
+            return t.insert_unique(x);
+        }
+
+        iterator insert(iterator, const value_type &x)
+        {
+            return t.insert_unique(x).first;
+        }
+
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void clear() { t.clear(); }
+
+        const_iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        const_iterator lower_bound(const key_type &x) const
+        {
+            return t.lower_bound(x);
+        }
+        const_iterator upper_bound(const key_type &x) const
+        {
+            return t.upper_bound(x);
+        }
+        pair<const_iterator, const_iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+    };
+}
+#endif
@@ -0,0 +1,95 @@
+/***
+* concurrent_set：以无锁跳表为底层机制的 set，多个线程可以同时插入、删除、查找与遍历，不必加锁。
+* 接口取 set.h 中可以安全并发的部分：
+*   1. 迭代器为常量前向迭代器，只保证看见遍历期间一直存在的元素，不能跨线程使用；
+*   2. size() 在有其他线程修改时只是近似值；
+*   3. 不提供复制、swap 与比较运算，这些操作无法与其他线程的修改同时进行。
+*/
+#ifndef _SIMPLE_STL_CONCURRENT_SET_H_
+#define _SIMPLE_STL_CONCURRENT_SET_H_
+
+#include "stl_skiplist.h"
+#include "memory.h"
+#include "stl_iterator.h"
+#include <utility>
+
+namespace SimpleSTL
+{
+    template <class Key, class Compare = less<Key>, class Alloc = alloc1>
+    class concurrent_set
+    {
+    public:
+        typedef Key key_type;
+        typedef Key value_type;
+        typedef Compare key_compare;
+        typedef Compare value_compare;
+
+    private:
+        template <class T>
+        struct identity : public unary_function<T, T> {
+            const T& operator()(const T& x) const { return x; }
+        };
+        typedef concurrent_skiplist<key_type, value_type,
+                                    identity<value_type>, key_compare, Alloc> rep_type;
+        rep_type t; // 采用无锁跳表来表现 concurrent_set
+
+    public:
+        typedef typename rep_type::const_pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::const_reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::const_iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        concurrent_set() : t(Compare()) {}
+        explicit concurrent_set(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        concurrent_set(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_unique(first, last); }
+
+        template <class InputIterator>
+        concurrent_set(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_unique(first, last); }
+
+        // accessors:
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return t.key_comp(); }
+        iterator begin() const { return t.begin(); }
+        iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+
+        typedef pair<iterator, bool> pair_iterator_bool;
+        pair_iterator_bool insert(const value_type &x)
+        {
+            return t.insert_unique(x);
+        }
+        iterator insert(iterator, const value_type &x)
+        {
+            return t.insert_unique(x).first;
+        }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void clear() { t.clear(); }
+
+        iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        std::pair<iterator, iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+    };
+}
+#endif
@@ -0,0 +1,244 @@
+/***
+* cow_vector<T>：写入时才复制（copy-on-write）的 vector。
+* 元素放在一个带引用计数的共用区块中，复制 cow_vector 只是增加计数，是 O(1) 的；
+* 第一次经由非 const 的成员函数修改时，若区块仍与别的 cow_vector 共用，才复制出自己的一份。
+* const 的成员函数（以及 cbegin、cend、as_const）永远不会引起复制，只读的热路径应该走这些函数。
+* 引用计数是 atomic 的，共用同一区块的不同 cow_vector 可以分别在不同的执行绪中使用；
+* 同一个 cow_vector 物件则与 vector 一样不可同时读写。
+* alloc2 的记忆池不是执行绪安全的，所以预设的配置器是直接使用 malloc 的 alloc1。
+* 经由非 const 函数取得可写的指针、迭代器或引用之后，区块被标记为不可共用（与旧版 libstdc++ 的 COW string 相同）：
+* 之后复制本物件都会立刻复制元素，经由那些引用写入不会改到副本。clear() 使所有引用失效，标记随之解除。
+*/
+#ifndef _SIMPLE_STL_COW_VECTOR_H_
+#define _SIMPLE_STL_COW_VECTOR_H_
+
+#include <atomic>
+#include "./vector.h"
+
+namespace SimpleSTL
+{
+    template <class T, class Alloc = alloc1>
+    class cow_vector
+    {
+    public:
+        typedef T value_type;
+        typedef T *pointer;
+        typedef T *iterator;
+        typedef const T *const_iterator;
+        typedef T &reference;
+        typedef const T &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+    protected:
+        typedef vector<T, Alloc> vector_type;
+
+        // 共用的区块：元素与共用者的个数
+        struct cow_rep
+        {
+            std::atomic<size_t> refs;
+            bool unshareable;   // 有可写的引用流出，只由独占区块的物件设定
+            vector_type v;
+
+            cow_rep() : refs(1), unshareable(false) {}
+        };
+        typedef simple_alloc<cow_rep, Alloc> rep_allocator;
+
+        cow_rep *rep;   // 没有元素时可能为 0
+
+        static cow_rep *create_rep()
+        {
+            cow_rep *p = rep_allocator::allocate();
+            try {
+                new ((void *)p) cow_rep();
+            }
+            catch(...) {
+                rep_allocator::deallocate(p);
+                throw;
+            }
+            return p;
+        }
+
+        static void destroy_rep(cow_rep *p)
+        {
+            p->~cow_rep();
+            rep_allocator::deallocate(p);
+        }
+
+        void release()
+        {
+            if (rep != 0 && rep->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                destroy_rep(rep);
+            rep = 0;
+        }
+
+        // 修改之前呼叫：确保区块只属于本物件，复制时预留 extra 个元素的空间，传回可以修改的 vector
+        vector_type &mutate(size_type extra = 0)
+        {
+            if (rep == 0)
+                rep = create_rep();
+            else if (rep->refs.load(std::memory_order_acquire) != 1) {
+                cow_rep *p = create_rep();
+                try {
+                    p->v.reserve(rep->v.size() + extra);
+                    p->v.insert(p->v.end(), rep->v.begin(), rep->v.end());
+                }
+                catch(...) {
+                    destroy_rep(p);
+                    throw;
+                }
+                release();
+                rep = p;
+            }
+            return rep->v;
+        }
+
+        // 传回可写的指针、迭代器或引用之前呼叫：区块从此不再与副本共用
+        vector_type &leak(size_type extra = 0)
+        {
+            vector_type &v = mutate(extra);
+            rep->unshareable = true;
+            return v;
+        }
+
+        template <class InputIterator>
+        void initialize(InputIterator first, InputIterator last)
+        {
+            cow_rep *p = create_rep();
+            try {
+                p->v.assign(first, last);
+            }
+            catch(...) {
+                destroy_rep(p);
+                throw;
+            }
+            rep = p;
+        }
+
+    public:
+        cow_vector() : rep(0) {}
+        cow_vector(size_type n, const T &value) : rep(0) { mutate().assign(n, value); }
+        explicit cow_vector(size_type n) : rep(0) { mutate().resize(n); }
+        cow_vector(const std::initializer_list<T> v) : rep(0) { initialize(v.begin(), v.end()); }
+        cow_vector(const T *first, const T *last) : rep(0) { initialize(first, last); }
+
+        // 只增加引用计数，不复制元素；区块不可共用时才复制
+        cow_vector(const cow_vector &x) : rep(x.rep)
+        {
+            if (rep == 0)
+                return;
+            if (rep->unshareable) {
+                rep = 0;
+                initialize(x.cbegin(), x.cend());
+            }
+            else
+                rep->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        cow_vector &operator=(const cow_vector &x)
+        {
+            cow_vector tmp(x);
+            swap(tmp);
+            return *this;
+        }
+
+        ~cow_vector() { release(); }
+
+        /**************************** 只读，不会复制 ****************************/
+        size_type size() const { return rep == 0 ? 0 : rep->v.size(); }
+        size_type capacity() const { return rep == 0 ? 0 : rep->v.capacity(); }
+        bool empty() const { return size() == 0; }
+
+        const_iterator begin() const { return rep == 0 ? 0 : rep->v.begin(); }
+        const_iterator end() const { return rep == 0 ? 0 : rep->v.end(); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+        const T *data() const { return begin(); }
+        const_reference operator[](size_type n) const { return begin()[n]; }
+        const_reference front() const { return *begin(); }
+        const_reference back() const { return *(end() - 1); }
+
+        // 以 const 的身分存取，例如 v.as_const()[i]，保证不会复制
+        const cow_vector &as_const() const { return *this; }
+
+        // 区块是否与别的 cow_vector 共用，以及共用者的个数
+        bool shared() const { return use_count() > 1; }
+        size_type use_count() const
+        {
+            return rep == 0 ? 0 : rep->refs.load(std::memory_order_acquire);
+        }
+
+        /**************************** 修改，共用时先复制 ****************************/
+        iterator begin() { return leak().begin(); }
+        iterator end() { return leak().end(); }
+        T *data() { return begin(); }
+        reference operator[](size_type n) { return leak()[n]; }
+        reference front() { return *begin(); }
+        reference back() { return *(end() - 1); }
+
+        void push_back(const T &x)
+        {
+            T x_copy = x;   // x 可能就在共用的区块中
+            mutate(1).push_back(x_copy);
+        }
+
+        void pop_back() { mutate().pop_back(); }
+
+        iterator insert(const_iterator position, const T &x)
+        {
+            const difference_type off = position - cbegin();
+            T x_copy = x;
+            vector_type &v = leak(1);
+            return v.insert(v.begin() + off, x_copy);
+        }
+
+        iterator insert(const_iterator position, size_type n, const T &x)
+        {
+            const difference_type off = position - cbegin();
+            T x_copy = x;
+            vector_type &v = leak(n);
+            return v.insert(v.begin() + off, n, x_copy);
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            const difference_type off = first - cbegin(), n = last - first;
+            vector_type &v = leak();
+            return v.erase(v.begin() + off, v.begin() + off + n);
+        }
+
+        iterator erase(const_iterator position) { return erase(position, position + 1); }
+
+        void resize(size_type n, const T &x)
+        {
+            T x_copy = x;
+            mutate(n > size() ? n - size() : 0).resize(n, x_copy);
+        }
+        void resize(size_type n) { resize(n, T()); }
+
+        void reserve(size_type n)
+        {
+            if (n > capacity())
+                mutate(n > size() ? n - size() : 0).reserve(n);
+        }
+
+        // 共用时只要放弃区块，不必复制
+        void clear()
+        {
+            if (shared())
+                release();
+            else if (rep != 0) {
+                rep->v.clear();
+                rep->unshareable = false;
+            }
+        }
+
+        void swap(cow_vector &x) { std::swap(rep, x.rep); }
+    };
+
+    // 只持有一个指向共用区块的指针，可以逐位元搬移
+    template <class T, class Alloc>
+    struct _is_trivially_relocatable<cow_vector<T, Alloc> > { typedef _true_type type; };
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include "./memory.h"
 #include "./stl_iterator.h"
+#include "./stl_growth.h"
 
 
 namespace SimpleSTL {
@@ -132,7 +133,8 @@ namespace SimpleSTL {
 	};
 
 
-    template<class T, class Alloc = alloc2, size_t BufSize = 0>
+    // Growth 决定 map 不够用时新 map 的大小
+    template<class T, class Alloc = alloc2, size_t BufSize = 0, class Growth = growth_double>
 	class deque{
 	public:
 		typedef T value_type;
@@ -169,6 +171,12 @@ namespace SimpleSTL {
         }
 
         size_type size() const { return finish - start; }
+        // 头尾两个缓冲区中已配置而未使用的元素个数（中间的缓冲区一定是满的）
+        size_type slack() const {
+            return size_type((start.cur - start.first) + (finish.last - finish.cur));
+        }
+        // map 中未使用的节点个数
+        size_type map_slack() const { return map_size - size_type(finish.node - start.node + 1); }
         // 以下调用 interator::operator-
         size_type max_size() const { return size_type(-1);}
         bool empty() const { return finish == start;}
@@ -186,7 +194,7 @@ namespace SimpleSTL {
             return data_allocator::allocate(buffer_size());
         }
 		void deallocate_node(T* p) {
-            data_allocator::deallocate(p);
+            data_allocator::deallocate(p, buffer_size());
         }
 
         static size_t buffer_size() {return __deque_buf_size(BufSize, sizeof(T));}
@@ -253,6 +261,7 @@ namespace SimpleSTL {
         }
 
         void clear();
+        void shrink_to_fit();
 
 		// 清除某个元素，P164
 		iterator erase(iterator pos) {
@@ -300,8 +309,8 @@ namespace SimpleSTL {
 	};
 
 
-    template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::fill_initialize(size_type n,
+    template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::fill_initialize(size_type n,
 		                                const value_type& value) {
 		create_map_and_nodes(n);    // 把deque的结构都产生并安排好
 		map_pointer cur;
@@ -313,8 +322,8 @@ namespace SimpleSTL {
 	}
 
     // 负责产生并安排好 deque 的结构
-    template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::create_map_and_nodes(size_type num_elements) {
+    template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::create_map_and_nodes(size_type num_elements) {
 	    // 需要节点数=(元素个数/每个缓冲区可容纳的元素个数+1)
         // 如果刚好整除，会多分配一个节点
 		size_type num_nodes = num_elements / buffer_size() + 1;
@@ -345,8 +354,8 @@ namespace SimpleSTL {
 	}
 
     // 只有当最后一个缓冲区只剩一个备用元素空间时才会调用
-    template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::push_back_aux(const value_type& t) {
+    template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::push_back_aux(const value_type& t) {
 		value_type t_copy = t;
 		reserve_map_at_back();      // 判断是否需要重换一个map
 		*(finish.node + 1) = allocate_node();  // 配置一个新缓冲区
@@ -357,8 +366,8 @@ namespace SimpleSTL {
 	}
 
     // 只有当第一缓冲区没有任何备用元素时才会被调用
-    template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::push_front_aux(const value_type& t) 
+    template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::push_front_aux(const value_type& t) 
     {
 	    value_type t_copy = t;
 	    reserve_map_at_front();      // 判断是否需要重换一个map
@@ -370,22 +379,22 @@ namespace SimpleSTL {
 	}
 
 
-    template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::reserve_map_at_back(size_type node_to_add) {
+    template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::reserve_map_at_back(size_type node_to_add) {
 	    if (node_to_add + 1 > map_size - (finish.node - map)) {
 	    	reallocate_map(node_to_add, false);
 	    }
 	}
 
-	template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::reserve_map_at_front(size_type node_to_add) {
+	template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::reserve_map_at_front(size_type node_to_add) {
 	    if (node_to_add > start.node - map) {
 	    	reallocate_map(node_to_add, true);
 	    }
 	}
 
-	template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::reallocate_map(size_type node_to_add, 
+	template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::reallocate_map(size_type node_to_add, 
 		                                        bool add_at_front) {
 	    size_type old_num_nodes = finish.node - start.node + 1;
 	    size_type new_num_nodes = old_num_nodes + node_to_add;
@@ -401,7 +410,8 @@ namespace SimpleSTL {
 	    		copy_backward(start.node, finish.node + 1, new_nstart + old_num_nodes);
 	    } 
         else {
-	    	size_type new_map_size = map_size + max(map_size, node_to_add) + 2;
+	    	// 前后各至少预留一个节点
+	    	size_type new_map_size = Growth::next(map_size, new_num_nodes + 2);
 	    	// 配置一块空间，准备给新 map 使用
 			map_pointer new_map = map_allocator::allocate(new_map_size);
 	    	new_nstart = new_map + (new_map_size - new_num_nodes) / 2
@@ -420,8 +430,8 @@ namespace SimpleSTL {
 	}
 	
 	// 只有当 finish.cur == finish.first 时才会被调用
-	template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::pop_back_aux(){
+	template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::pop_back_aux(){
 		deallocate_node(finish.first);		// 释放最后一个缓冲区
 		finish.set_node(finish.node - 1);
 		finish.cur = finish.last - 1;
@@ -429,18 +439,18 @@ namespace SimpleSTL {
 	}
 
 	// 只有当 start.cur == start.last-1 时才会被调用
-	template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::pop_front_aux(){
+	template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::pop_front_aux(){
 		destroy(start.cur);					 // 将第一个缓冲区的唯第一个（也是最后一个）元素析构		
-		deallocate_node(start.last);		 // 释放第一个缓冲区
+		deallocate_node(start.first);		 // 释放第一个缓冲区
 		start.set_node(start.node + 1);
 		start.cur = start.first;
 		
 	}
 
 	// 注意，最终需要保留一个缓冲区。这是 deque 的策略，也是 deque 的初始状态
-	template<class T, class Alloc, size_t BufSize>
-	void deque<T, Alloc, BufSize>::clear() {
+	template<class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::clear() {
 		// 以下针对头尾以外的每一个缓冲区（它们一定都是饱满的）
 		for (map_pointer node = start.node + 1; node < finish.node; ++node) {
 			// 将缓冲区内所有元素析构
@@ -463,9 +473,26 @@ namespace SimpleSTL {
 		finish = start;
 	}
 
-	template <class T, class Alloc, size_t BufSize>
-	typename deque<T, Alloc, BufSize>::iterator 
-	deque<T, Alloc, BufSize>::erase(iterator first, iterator last)
+	// 把 map 缩小到恰好容纳现有的节点，前后各预留一个（但不小于 initial_map_size）
+	template <class T, class Alloc, size_t BufSize, class Growth>
+	void deque<T, Alloc, BufSize, Growth>::shrink_to_fit() {
+		size_type num_nodes = finish.node - start.node + 1;
+		size_type new_map_size = initial_map_size > num_nodes + 2 ? initial_map_size : num_nodes + 2;
+		if (new_map_size >= map_size)
+			return;
+		map_pointer new_map = map_allocator::allocate(new_map_size);
+		map_pointer new_nstart = new_map + (new_map_size - num_nodes) / 2;
+		copy(start.node, finish.node + 1, new_nstart);
+		map_allocator::deallocate(map, map_size);
+		map = new_map;
+		map_size = new_map_size;
+		start.set_node(new_nstart);
+		finish.set_node(new_nstart + num_nodes - 1);
+	}
+
+	template <class T, class Alloc, size_t BufSize, class Growth>
+	typename deque<T, Alloc, BufSize, Growth>::iterator 
+	deque<T, Alloc, BufSize, Growth>::erase(iterator first, iterator last)
 	{
 	  	if (first == start && last == finish) {
 	  	  	clear();
@@ -487,7 +514,7 @@ namespace SimpleSTL {
 	  	  	  	copy(last, finish, first);
 	  	  	  	iterator new_finish = finish - n;
 	  	  	  	destroy(new_finish, finish);
-	  	  	  	for (map_pointer cur = new_finish.node; cur <= finish.node; ++cur)
+	  	  	  	for (map_pointer cur = new_finish.node + 1; cur <= finish.node; ++cur)
 					data_allocator::deallocate(*cur, buffer_size());
 	  	  	  	finish = new_finish;
 	  	  	}
@@ -495,9 +522,9 @@ namespace SimpleSTL {
 		}
 	}
 
-	template <class T, class Alloc, size_t BufSize>
-	typename deque<T, Alloc, BufSize>::iterator
-	deque<T, Alloc, BufSize>::insert_aux(iterator pos, const value_type& x)
+	template <class T, class Alloc, size_t BufSize, class Growth>
+	typename deque<T, Alloc, BufSize, Growth>::iterator
+	deque<T, Alloc, BufSize, Growth>::insert_aux(iterator pos, const value_type& x)
 	{
 	  	difference_type index = pos - start;
 	  	value_type x_copy = x;
@@ -0,0 +1,368 @@
+/***
+* dynamic_bitset：大小在执行期决定的位元集合，每个位元只占 1 bit。
+* 位元以 64 bits 的区块（block）存放在 vector 中，set/reset/flip、and/or/xor/andnot 都一次处理一整个区块；
+* count() 在编译时开启 AVX2（-mavx2）时以 vpshufb 查表一次计算 256 bits，否则逐区块使用 popcount 指令；
+* find_first/find_next 以 count trailing zeros（开启 BMI 时为 tzcnt 指令）直接跳到下一个 1。
+* 最后一个区块中超出 size() 的位元永远保持为 0，count、any、find 等操作都依赖这一点。
+*/
+#ifndef _SIMPLE_STL_DYNAMIC_BITSET_H_
+#define _SIMPLE_STL_DYNAMIC_BITSET_H_
+
+#include "./vector.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace SimpleSTL
+{
+    typedef unsigned long long __bitset_block;
+
+#if defined(__AVX2__)
+    // 以 4 bits 为索引查表求每个字节的 1 的个数，累计至多 8 轮（每字节不超过 64）再以 sad 加总到 64 位元
+    inline size_t __popcount_blocks(const __bitset_block *p, size_t n)
+    {
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low_mask = _mm256_set1_epi8(0x0f);
+        __m256i total = _mm256_setzero_si256();
+        size_t i = 0;
+        while (i + 4 <= n)
+        {
+            __m256i local = _mm256_setzero_si256();
+            for (int k = 0; k < 8 && i + 4 <= n; ++k, i += 4)
+            {
+                __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+                __m256i lo = _mm256_and_si256(v, low_mask);
+                __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+                local = _mm256_add_epi8(local, _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                                               _mm256_shuffle_epi8(lookup, hi)));
+            }
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(local, _mm256_setzero_si256()));
+        }
+        size_t result = (size_t)_mm256_extract_epi64(total, 0) + (size_t)_mm256_extract_epi64(total, 1)
+                      + (size_t)_mm256_extract_epi64(total, 2) + (size_t)_mm256_extract_epi64(total, 3);
+        for (; i < n; ++i)
+            result += __builtin_popcountll(p[i]);
+        return result;
+    }
+#else
+    inline size_t __popcount_blocks(const __bitset_block *p, size_t n)
+    {
+        size_t result = 0;
+        for (size_t i = 0; i < n; ++i)
+            result += __builtin_popcountll(p[i]);
+        return result;
+    }
+#endif
+
+    template <class Alloc = alloc2>
+    class dynamic_bitset
+    {
+    public:
+        typedef __bitset_block block_type;
+        typedef size_t size_type;
+
+        static const size_type bits_per_block = 64;
+        static const size_type npos = size_type(-1);
+
+        // operator[] 传回的代理物件，代表某个区块中的一个位元
+        class reference
+        {
+            block_type *block;
+            block_type mask;
+
+        public:
+            reference(block_type *b, size_type pos) : block(b), mask(block_type(1) << pos) {}
+
+            operator bool() const { return (*block & mask) != 0; }
+            bool operator~() const { return (*block & mask) == 0; }
+            reference &operator=(bool x)
+            {
+                if (x)
+                    *block |= mask;
+                else
+                    *block &= ~mask;
+                return *this;
+            }
+            reference &operator=(const reference &x) { return *this = bool(x); }
+            reference &flip()
+            {
+                *block ^= mask;
+                return *this;
+            }
+        };
+
+    protected:
+        vector<block_type, Alloc> blocks;
+        size_type len;
+
+        static size_type block_index(size_type pos) { return pos / bits_per_block; }
+        static size_type bit_index(size_type pos) { return pos % bits_per_block; }
+        static size_type blocks_for(size_type n) { return (n + bits_per_block - 1) / bits_per_block; }
+
+        block_type *data() const { return blocks.begin(); }
+        size_type block_count() const { return blocks.size(); }
+
+        // 把最后一个区块中超出 size() 的位元清为 0
+        void zero_unused_bits()
+        {
+            if (bit_index(len) != 0)
+                data()[block_count() - 1] &= (block_type(1) << bit_index(len)) - 1;
+        }
+
+        // 对 [first, last) 中的位元套用 op(block, mask)：头尾区块以遮罩处理，中间整个区块处理
+        template <class Op>
+        void apply_range(size_type first, size_type last, Op op)
+        {
+            if (first >= last)
+                return;
+            size_type b = block_index(first), e = block_index(last - 1);
+            block_type head = ~block_type(0) << bit_index(first);
+            block_type tail = ~block_type(0) >> (bits_per_block - 1 - bit_index(last - 1));
+            if (b == e) {
+                op(data()[b], head & tail);
+                return;
+            }
+            op(data()[b], head);
+            for (size_type i = b + 1; i < e; ++i)
+                op(data()[i], ~block_type(0));
+            op(data()[e], tail);
+        }
+
+        struct set_op { void operator()(block_type &w, block_type m) const { w |= m; } };
+        struct reset_op { void operator()(block_type &w, block_type m) const { w &= ~m; } };
+        struct flip_op { void operator()(block_type &w, block_type m) const { w ^= m; } };
+
+        // 从第 i 个区块开始找第一个 1，第 i 个区块只看 w 中剩下的位元
+        size_type find_from(size_type i, block_type w) const
+        {
+            const size_type n = block_count();
+            while (w == 0) {
+                if (++i >= n)
+                    return npos;
+                w = data()[i];
+            }
+            return i * bits_per_block + __builtin_ctzll(w);
+        }
+
+    public:
+        dynamic_bitset() : len(0) {}
+        explicit dynamic_bitset(size_type n, bool value = false)
+            : blocks(blocks_for(n), value ? ~block_type(0) : block_type(0)), len(n)
+        {
+            zero_unused_bits();
+        }
+
+        size_type size() const { return len; }
+        size_type num_blocks() const { return block_count(); }
+        bool empty() const { return len == 0; }
+        // 实际占用的 bytes
+        size_type memory_usage() const { return blocks.capacity() * sizeof(block_type); }
+
+        void resize(size_type n, bool value = false)
+        {
+            const size_type old_len = len;
+            blocks.resize(blocks_for(n), value ? ~block_type(0) : block_type(0));
+            len = n;
+            // 旧的最后一个区块中新增的位元原本都是 0
+            if (value && n > old_len)
+                apply_range(old_len, n < block_count() * bits_per_block ? n : block_count() * bits_per_block, set_op());
+            zero_unused_bits();
+        }
+
+        void clear()
+        {
+            blocks.clear();
+            len = 0;
+        }
+
+        void push_back(bool value)
+        {
+            if (bit_index(len) == 0)
+                blocks.push_back(block_type(0));
+            ++len;
+            set(len - 1, value);
+        }
+
+        /**************************** 单一位元 ****************************/
+        bool test(size_type pos) const
+        {
+            return (data()[block_index(pos)] >> bit_index(pos)) & 1;
+        }
+        bool operator[](size_type pos) const { return test(pos); }
+        reference operator[](size_type pos) { return reference(data() + block_index(pos), bit_index(pos)); }
+
+        dynamic_bitset &set(size_type pos, bool value = true)
+        {
+            reference(data() + block_index(pos), bit_index(pos)) = value;
+            return *this;
+        }
+        dynamic_bitset &reset(size_type pos)
+        {
+            data()[block_index(pos)] &= ~(block_type(1) << bit_index(pos));
+            return *this;
+        }
+        dynamic_bitset &flip(size_type pos)
+        {
+            data()[block_index(pos)] ^= block_type(1) << bit_index(pos);
+            return *this;
+        }
+
+        /**************************** 整个集合或一段范围，逐区块处理 ****************************/
+        dynamic_bitset &set()
+        {
+            SimpleSTL::fill(data(), data() + block_count(), ~block_type(0));
+            zero_unused_bits();
+            return *this;
+        }
+        dynamic_bitset &reset()
+        {
+            SimpleSTL::fill(data(), data() + block_count(), block_type(0));
+            return *this;
+        }
+        dynamic_bitset &flip()
+        {
+            for (size_type i = 0; i < block_count(); ++i)
+                data()[i] = ~data()[i];
+            zero_unused_bits();
+            return *this;
+        }
+
+        // [first, last) 中的位元全部设为 value
+        dynamic_bitset &set_range(size_type first, size_type last, bool value = true)
+        {
+            if (value)
+                apply_range(first, last, set_op());
+            else
+                apply_range(first, last, reset_op());
+            return *this;
+        }
+        dynamic_bitset &flip_range(size_type first, size_type last)
+        {
+            apply_range(first, last, flip_op());
+            return *this;
+        }
+
+        /**************************** 计数与搜寻 ****************************/
+        size_type count() const { return __popcount_blocks(data(), block_count()); }
+
+        bool any() const
+        {
+            for (size_type i = 0; i < block_count(); ++i)
+                if (data()[i] != 0)
+                    return true;
+            return false;
+        }
+        bool none() const { return !any(); }
+        bool all() const { return count() == len; }
+
+        // 第一个 1 的位置，没有时传回 npos
+        size_type find_first() const
+        {
+            return block_count() == 0 ? npos : find_from(0, data()[0]);
+        }
+
+        // pos 之后第一个 1 的位置，没有时传回 npos
+        size_type find_next(size_type pos) const
+        {
+            if (pos >= len || ++pos >= len)     // 先检查 pos：pos 为 npos 时加一会回绕到 0
+                return npos;
+            size_type i = block_index(pos);
+            return find_from(i, data()[i] & (~block_type(0) << bit_index(pos)));
+        }
+
+        /**************************** 集合运算，两者的 size() 必须相同 ****************************/
+        dynamic_bitset &operator&=(const dynamic_bitset &x)
+        {
+            for (size_type i = 0; i < block_count(); ++i)
+                data()[i] &= x.data()[i];
+            return *this;
+        }
+        dynamic_bitset &operator|=(const dynamic_bitset &x)
+        {
+            for (size_type i = 0; i < block_count(); ++i)
+                data()[i] |= x.data()[i];
+            return *this;
+        }
+        dynamic_bitset &operator^=(const dynamic_bitset &x)
+        {
+            for (size_type i = 0; i < block_count(); ++i)
+                data()[i] ^= x.data()[i];
+            return *this;
+        }
+        // 去掉 x 中为 1 的位元，即 *this &= ~x，但不必产生 ~x
+        dynamic_bitset &andnot(const dynamic_bitset &x)
+        {
+            for (size_type i = 0; i < block_count(); ++i)
+                data()[i] &= ~x.data()[i];
+            return *this;
+        }
+
+        dynamic_bitset operator~() const
+        {
+            dynamic_bitset tmp(*this);
+            tmp.flip();
+            return tmp;
+        }
+
+        // *this 中的 1 是否都出现在 x 中
+        bool is_subset_of(const dynamic_bitset &x) const
+        {
+            for (size_type i = 0; i < block_count(); ++i)
+                if (data()[i] & ~x.data()[i])
+                    return false;
+            return true;
+        }
+
+        bool operator==(const dynamic_bitset &x) const
+        {
+            if (len != x.len)
+                return false;
+            for (size_type i = 0; i < block_count(); ++i)
+                if (data()[i] != x.data()[i])
+                    return false;
+            return true;
+        }
+        bool operator!=(const dynamic_bitset &x) const { return !(*this == x); }
+
+        void swap(dynamic_bitset &x)
+        {
+            blocks.swap(x.blocks);
+            std::swap(len, x.len);
+        }
+    };
+
+    template <class Alloc>
+    const typename dynamic_bitset<Alloc>::size_type dynamic_bitset<Alloc>::bits_per_block;
+    template <class Alloc>
+    const typename dynamic_bitset<Alloc>::size_type dynamic_bitset<Alloc>::npos;
+
+    template <class Alloc>
+    inline dynamic_bitset<Alloc> operator&(const dynamic_bitset<Alloc> &x, const dynamic_bitset<Alloc> &y)
+    {
+        dynamic_bitset<Alloc> tmp(x);
+        return tmp &= y;
+    }
+
+    template <class Alloc>
+    inline dynamic_bitset<Alloc> operator|(const dynamic_bitset<Alloc> &x, const dynamic_bitset<Alloc> &y)
+    {
+        dynamic_bitset<Alloc> tmp(x);
+        return tmp |= y;
+    }
+
+    template <class Alloc>
+    inline dynamic_bitset<Alloc> operator^(const dynamic_bitset<Alloc> &x, const dynamic_bitset<Alloc> &y)
+    {
+        dynamic_bitset<Alloc> tmp(x);
+        return tmp ^= y;
+    }
+
+    // 只持有一个 vector 与长度，可以逐位元搬移；区块位于 vector 内部空间（__inline_alloc）时不行
+    template <class Alloc>
+    struct _is_trivially_relocatable<dynamic_bitset<Alloc> > { typedef _true_type type; };
+    template <size_t N, class Alloc>
+    struct _is_trivially_relocatable<dynamic_bitset<__inline_alloc<N, Alloc> > > { typedef _false_type type; };
+}
+
+#endif
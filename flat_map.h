@@ -0,0 +1,164 @@
+/***
+* flat_map：以有序 vector 为底层机制的 map，接口与 map.h 相同，可以 typedef 直接替换。
+* 元素连续存放，查找为二分搜索，没有每节点的额外开销；适合建好之后大量查询的场合。
+* 与 map 不同的是：
+*   1. value_type 为 pair<Key, T> 而非 pair<const Key, T>（元素须能在 vector 中搬移），
+*      因此 it->first = ... 可以通过编译，但改变键值会破坏所有查找所依赖的顺序；
+*      经由迭代器只应修改实值，要改键值请先 erase 再 insert；
+*   2. 单一元素的插入、删除为 O(n)，且插入可能使全部迭代器与引用失效；
+*      成批插入（insert(first, last)、insert_sorted）只合并一趟。
+*/
+#ifndef _SIMPLE_STL_FLAT_MAP_H_
+#define _SIMPLE_STL_FLAT_MAP_H_
+
+#include <functional>
+#include "memory.h"
+#include "stl_flat_tree.h"
+
+namespace SimpleSTL
+{
+    template <class Key, class T,
+              class Compare = less<Key>,
+              class Alloc = alloc2>
+    class flat_map
+    {
+    public:
+        typedef Key key_type;
+        typedef T data_type;
+        typedef T mapped_type;
+        typedef pair<Key, T> value_type;
+        typedef Compare key_compare;
+
+        class value_compare
+            : public binary_function<value_type, value_type, bool>
+        {
+            friend class flat_map<Key, T, Compare, Alloc>;
+            protected:
+                Compare comp;
+                value_compare(Compare c) : comp(c) {}
+            public:
+                bool operator()(const value_type &x, const value_type &y) const
+                {
+                    return comp(x.first, y.first);
+                }
+        };
+
+    private:
+        template <class X>
+        struct select1st : public unary_function<X, typename X::first_type> {
+        	const typename X::first_type& operator()(const X& x) const { return x.first; }
+        };
+        typedef flat_tree<key_type, value_type,
+                          select1st<value_type>, key_compare, Alloc> rep_type;
+        rep_type t; // 采用有序 vector 来表现 flat_map
+
+    public:
+        typedef typename rep_type::pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        flat_map() : t(Compare()) {}
+        explicit flat_map(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        flat_map(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_unique(first, last); }
+
+        template <class InputIterator>
+        flat_map(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_unique(first, last); }
+
+        // 输入已按键值排序且无重复，O(n)
+        template <class ForwardIterator>
+        flat_map(sorted_unique_tag, ForwardIterator first, ForwardIterator last,
+                 const Compare &comp = Compare())
+            : t(comp) { t.assign_sorted_unique(first, last); }
+
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return value_compare(t.key_comp()); }
+        iterator begin() { return t.begin(); }
+        const_iterator begin() const { return t.begin(); }
+        iterator end() { return t.end(); }
+        const_iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+        size_type capacity() const { return t.capacity(); }
+        void reserve(size_type n) { t.reserve(n); }
+
+        T& operator[](const key_type &k)
+        {
+            iterator i = t.lower_bound(k);
+            if (i == end() || key_comp()(k, i->first))
+                i = t.insert_unique(i, value_type(k, T()));
+            return i->second;
+        }
+        void swap(flat_map<Key, T, Compare, Alloc> &x) { t.swap(x.t); }
+
+        pair<iterator, bool> insert(const value_type &x)
+        {
+            return t.insert_unique(x);
+        }
+
+        iterator insert(iterator position, const value_type &x)
+        {
+            return t.insert_unique(position, x);
+        }
+
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+        // [first, last) 已按键值排序，与原有元素一趟合并，O(n + m)
+        template <class ForwardIterator>
+        void insert_sorted(ForwardIterator first, ForwardIterator last)
+        {
+            t.insert_sorted_unique(first, last);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last) { t.erase(first, last); }
+        void clear() { t.clear(); }
+        // 以按键值排序的 [first, last) 取代全部元素，O(n)；重复的键值只保留第一个
+        template <class ForwardIterator>
+        void assign_sorted(ForwardIterator first, ForwardIterator last)
+        {
+            t.assign_sorted_unique(first, last);
+        }
+
+        iterator find(const key_type &x) { return t.find(x); }
+        const_iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) { return t.lower_bound(x); }
+        const_iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) { return t.upper_bound(x); }
+        const_iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        pair<iterator, iterator> equal_range(const key_type &x)
+        {
+            return t.equal_range(x);
+        }
+        pair<const_iterator, const_iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const flat_map<Key, T, Compare, Alloc> &x,
+                               const flat_map<Key, T, Compare, Alloc> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const flat_map<Key, T, Compare, Alloc> &x,
+                              const flat_map<Key, T, Compare, Alloc> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+}
+#endif
@@ -0,0 +1,155 @@
+/***
+* flat_multimap：以有序 vector 为底层机制的 multimap（允许键值重复），接口与 map.h 相同，可以 typedef 直接替换。
+* 元素连续存放，查找为二分搜索，没有每节点的额外开销；适合建好之后大量查询的场合。
+* 与 map 不同的是：
+*   1. value_type 为 pair<Key, T> 而非 pair<const Key, T>（元素须能在 vector 中搬移），
+*      经由迭代器只能修改实值，不可修改键值；
+*   2. 单一元素的插入、删除为 O(n)，且插入可能使全部迭代器与引用失效；
+*      成批插入（insert(first, last)、insert_sorted）只合并一趟。
+*/
+#ifndef _SIMPLE_STL_FLAT_MULTIMAP_H_
+#define _SIMPLE_STL_FLAT_MULTIMAP_H_
+
+#include <functional>
+#include "memory.h"
+#include "stl_flat_tree.h"
+
+namespace SimpleSTL
+{
+    template <class Key, class T,
+              class Compare = less<Key>,
+              class Alloc = alloc2>
+    class flat_multimap
+    {
+    public:
+        typedef Key key_type;
+        typedef T data_type;
+        typedef T mapped_type;
+        typedef pair<Key, T> value_type;
+        typedef Compare key_compare;
+
+        class value_compare
+            : public binary_function<value_type, value_type, bool>
+        {
+            friend class flat_multimap<Key, T, Compare, Alloc>;
+            protected:
+                Compare comp;
+                value_compare(Compare c) : comp(c) {}
+            public:
+                bool operator()(const value_type &x, const value_type &y) const
+                {
+                    return comp(x.first, y.first);
+                }
+        };
+
+    private:
+        template <class X>
+        struct select1st : public unary_function<X, typename X::first_type> {
+        	const typename X::first_type& operator()(const X& x) const { return x.first; }
+        };
+        typedef flat_tree<key_type, value_type,
+                          select1st<value_type>, key_compare, Alloc> rep_type;
+        rep_type t; // 采用有序 vector 来表现 flat_multimap
+
+    public:
+        typedef typename rep_type::pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        flat_multimap() : t(Compare()) {}
+        explicit flat_multimap(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        flat_multimap(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_equal(first, last); }
+
+        template <class InputIterator>
+        flat_multimap(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_equal(first, last); }
+
+        // 输入已按键值排序，O(n)
+        template <class ForwardIterator>
+        flat_multimap(sorted_equal_tag, ForwardIterator first, ForwardIterator last,
+                      const Compare &comp = Compare())
+            : t(comp) { t.assign_sorted_equal(first, last); }
+
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return value_compare(t.key_comp()); }
+        iterator begin() { return t.begin(); }
+        const_iterator begin() const { return t.begin(); }
+        iterator end() { return t.end(); }
+        const_iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+        size_type capacity() const { return t.capacity(); }
+        void reserve(size_type n) { t.reserve(n); }
+        void swap(flat_multimap<Key, T, Compare, Alloc> &x) { t.swap(x.t); }
+
+        iterator insert(const value_type &x)
+        {
+            return t.insert_equal(x);
+        }
+
+        iterator insert(iterator position, const value_type &x)
+        {
+            return t.insert_equal(position, x);
+        }
+
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_equal(first, last);
+        }
+        // [first, last) 已按键值排序，与原有元素一趟合并，O(n + m)
+        template <class ForwardIterator>
+        void insert_sorted(ForwardIterator first, ForwardIterator last)
+        {
+            t.insert_sorted_equal(first, last);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last) { t.erase(first, last); }
+        void clear() { t.clear(); }
+        // 以按键值排序的 [first, last) 取代全部元素，O(n)
+        template <class ForwardIterator>
+        void assign_sorted(ForwardIterator first, ForwardIterator last)
+        {
+            t.assign_sorted_equal(first, last);
+        }
+
+        iterator find(const key_type &x) { return t.find(x); }
+        const_iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) { return t.lower_bound(x); }
+        const_iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) { return t.upper_bound(x); }
+        const_iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        pair<iterator, iterator> equal_range(const key_type &x)
+        {
+            return t.equal_range(x);
+        }
+        pair<const_iterator, const_iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const flat_multimap<Key, T, Compare, Alloc> &x,
+                               const flat_multimap<Key, T, Compare, Alloc> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const flat_multimap<Key, T, Compare, Alloc> &x,
+                              const flat_multimap<Key, T, Compare, Alloc> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+}
+#endif
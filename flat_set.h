@@ -0,0 +1,131 @@
+/***
+* flat_set：以有序 vector 为底层机制的 set，接口与 set.h 相同，可以 typedef 直接替换。
+* 元素连续存放，查找为二分搜索，没有每节点的额外开销；适合建好之后大量查询的场合。
+* 与 set 不同的是：单一元素的插入、删除为 O(n)，且插入可能使全部迭代器失效；
+* 成批插入（insert(first, last)、insert_sorted）只合并一趟。
+*/
+#ifndef _SIMPLE_STL_FLAT_SET_H_
+#define _SIMPLE_STL_FLAT_SET_H_
+
+#include "stl_flat_tree.h"
+#include "memory.h"
+#include "stl_iterator.h"
+#include <utility>
+
+namespace SimpleSTL
+{
+    template <class Key, class Compare = less<Key>, class Alloc = alloc2>
+    class flat_set
+    {
+    public:
+        typedef Key key_type;
+        typedef Key value_type;
+        typedef Compare key_compare;
+        typedef Compare value_compare;
+
+    private:
+        template <class T>
+        struct identity : public unary_function<T, T> {
+            const T& operator()(const T& x) const { return x; }
+        };
+        typedef flat_tree<key_type, value_type,
+                          identity<value_type>, key_compare, Alloc> rep_type;
+        rep_type t; // 采用有序 vector 来表现 flat_set
+
+    public:
+        typedef typename rep_type::const_pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::const_reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        // 与 set 相同，元素的次序不能被破坏，iterator 即 const_iterator
+        typedef typename rep_type::const_iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        flat_set() : t(Compare()) {}
+        explicit flat_set(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        flat_set(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_unique(first, last); }
+
+        template <class InputIterator>
+        flat_set(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_unique(first, last); }
+
+        // 输入已排序且无重复，O(n)
+        template <class ForwardIterator>
+        flat_set(sorted_unique_tag, ForwardIterator first, ForwardIterator last,
+                 const Compare &comp = Compare())
+            : t(comp) { t.assign_sorted_unique(first, last); }
+
+        // accessors:
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return t.key_comp(); }
+        iterator begin() const { return t.begin(); }
+        iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+        size_type capacity() const { return t.capacity(); }
+        void reserve(size_type n) { t.reserve(n); }
+        void swap(flat_set<Key, Compare, Alloc> &x) { t.swap(x.t); }
+
+        typedef pair<iterator, bool> pair_iterator_bool;
+        pair_iterator_bool insert(const value_type &x)
+        {
+            return t.insert_unique(x);
+        }
+        iterator insert(iterator position, const value_type &x)
+        {
+            return t.insert_unique(const_cast<value_type *>(position), x);
+        }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+        // [first, last) 已排序，与原有元素一趟合并，O(n + m)
+        template <class ForwardIterator>
+        void insert_sorted(ForwardIterator first, ForwardIterator last)
+        {
+            t.insert_sorted_unique(first, last);
+        }
+
+        void erase(iterator position) { t.erase(const_cast<value_type *>(position)); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last)
+        {
+            t.erase(const_cast<value_type *>(first), const_cast<value_type *>(last));
+        }
+        void clear() { t.clear(); }
+        // 以已排序的 [first, last) 取代全部元素，O(n)；重复的元素只保留第一个
+        template <class ForwardIterator>
+        void assign_sorted(ForwardIterator first, ForwardIterator last)
+        {
+            t.assign_sorted_unique(first, last);
+        }
+
+        iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        std::pair<iterator, iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const flat_set<Key, Compare, Alloc> &x,
+                               const flat_set<Key, Compare, Alloc> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const flat_set<Key, Compare, Alloc> &x,
+                              const flat_set<Key, Compare, Alloc> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+}
+#endif
@@ -0,0 +1,132 @@
+/***
+* interval_map：以区间树为底层机制的 multimap，键值为半开区间 interval<T>（[low, high)），允许重复。
+* 除了 multimap 的接口之外，另外提供重叠与刺探（包含某一点）查询：
+*   find_overlap / find_stab 传回第一个结果，O(log n)；
+*   overlapping / stabbing 依序把全部结果的迭代器写入输出迭代器，for_each_* 对每个结果调用函数，
+*   只走进确实含有结果的子树，不会因为长区间而退化为线性扫描。
+*/
+#ifndef _SIMPLE_STL_INTERVAL_MAP_H_
+#define _SIMPLE_STL_INTERVAL_MAP_H_
+
+#include <functional>
+#include "memory.h"
+#include "stl_interval_tree.h"
+
+namespace SimpleSTL
+{
+    template <class T, class V, class Alloc = alloc2>
+    class interval_map
+    {
+    public:
+        typedef interval<T> key_type;
+        typedef V data_type;
+        typedef V mapped_type;
+        typedef T endpoint_type;
+        typedef pair<const key_type, V> value_type;
+        typedef less<key_type> key_compare;
+
+        class value_compare
+            : public binary_function<value_type, value_type, bool>
+        {
+            friend class interval_map<T, V, Alloc>;
+            protected:
+                key_compare comp;
+                value_compare(key_compare c) : comp(c) {}
+            public:
+                bool operator()(const value_type &x, const value_type &y) const
+                {
+                    return comp(x.first, y.first);
+                }
+        };
+
+    private:
+        template <class X>
+        struct select1st : public unary_function<X, typename X::first_type> {
+        	const typename X::first_type& operator()(const X& x) const { return x.first; }
+        };
+        typedef interval_tree<key_type, value_type, select1st<value_type>, Alloc> rep_type;
+        rep_type t; // 采用区间树来表现 interval_map
+
+    public:
+        typedef typename rep_type::pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        interval_map() {}
+
+        template <class InputIterator>
+        interval_map(InputIterator first, InputIterator last) { insert(first, last); }
+
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return value_compare(t.key_comp()); }
+        iterator begin() { return t.begin(); }
+        const_iterator begin() const { return t.begin(); }
+        iterator end() { return t.end(); }
+        const_iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+        void swap(interval_map<T, V, Alloc> &x) { t.swap(x.t); }
+
+        iterator insert(const value_type &x) { return t.insert_equal(x); }
+        iterator insert(const T &low, const T &high, const V &v)
+        {
+            return t.insert_equal(value_type(key_type(low, high), v));
+        }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first)
+                t.insert_equal(*first);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last) { t.erase(first, last); }
+        void clear() { t.clear(); }
+
+        iterator find(const key_type &x) { return t.find(x); }
+        const_iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) { return t.lower_bound(x); }
+        const_iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) { return t.upper_bound(x); }
+        const_iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        pair<iterator, iterator> equal_range(const key_type &x) { return t.equal_range(x); }
+        pair<const_iterator, const_iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        // 区间查询：与 q 重叠、或包含 p 的区间。overlapping / stabbing 依序把结果的迭代器写入 out
+        bool overlaps(const key_type &q) const { return t.overlaps(q); }
+        iterator find_overlap(const key_type &q) { return t.find_overlap(q); }
+        const_iterator find_overlap(const key_type &q) const { return t.find_overlap(q); }
+        iterator find_stab(const T &p) { return t.find_stab(p); }
+        const_iterator find_stab(const T &p) const { return t.find_stab(p); }
+        template <class OutputIterator>
+        OutputIterator overlapping(const key_type &q, OutputIterator out) { return t.overlapping(q, out); }
+        template <class OutputIterator>
+        OutputIterator overlapping(const key_type &q, OutputIterator out) const { return t.overlapping(q, out); }
+        template <class OutputIterator>
+        OutputIterator stabbing(const T &p, OutputIterator out) { return t.stabbing(p, out); }
+        template <class OutputIterator>
+        OutputIterator stabbing(const T &p, OutputIterator out) const { return t.stabbing(p, out); }
+        template <class Function>
+        Function for_each_overlapping(const key_type &q, Function f) const
+        {
+            return t.for_each_overlapping(q, f);
+        }
+        template <class Function>
+        Function for_each_stabbing(const T &p, Function f) const
+        {
+            return t.for_each_stabbing(p, f);
+        }
+    };
+}
+#endif
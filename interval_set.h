@@ -0,0 +1,125 @@
+/***
+* interval_set：以区间树为底层机制的 set，元素为半开区间 interval<T>（[low, high)），彼此不重复。
+* 除了 set.h 的接口之外，另外提供重叠与刺探（包含某一点）查询：
+*   find_overlap / find_stab 传回第一个结果，O(log n)；
+*   overlapping / stabbing / for_each_overlapping / for_each_stabbing 依序列举全部结果，
+*   只走进确实含有结果的子树。
+*/
+#ifndef _SIMPLE_STL_INTERVAL_SET_H_
+#define _SIMPLE_STL_INTERVAL_SET_H_
+
+#include "stl_interval_tree.h"
+#include "memory.h"
+#include "stl_iterator.h"
+#include <utility>
+
+namespace SimpleSTL
+{
+    template <class T, class Alloc = alloc2>
+    class interval_set
+    {
+    public:
+        typedef interval<T> key_type;
+        typedef interval<T> value_type;
+        typedef T endpoint_type;
+        typedef less<key_type> key_compare;
+        typedef less<key_type> value_compare;
+
+    private:
+        template <class X>
+        struct identity : public unary_function<X, X> {
+            const X& operator()(const X& x) const { return x; }
+        };
+        typedef interval_tree<key_type, value_type, identity<value_type>, Alloc> rep_type;
+        rep_type t; // 采用区间树来表现 interval_set
+
+    public:
+        typedef typename rep_type::const_pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::const_reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::const_iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        interval_set() {}
+
+        template <class InputIterator>
+        interval_set(InputIterator first, InputIterator last) { t.insert_unique(first, last); }
+
+        // accessors:
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return t.key_comp(); }
+        iterator begin() const { return t.begin(); }
+        iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+        void swap(interval_set<T, Alloc> &x) { t.swap(x.t); }
+
+        typedef pair<iterator, bool> pair_iterator_bool;
+        pair_iterator_bool insert(const value_type &x)
+        {
+            pair<typename rep_type::iterator, bool> p = t.insert_unique(x);
+            return pair<iterator, bool>(p.first, p.second);
+        }
+        pair_iterator_bool insert(const T &low, const T &high)
+        {
+            return insert(value_type(low, high));
+        }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+
+        void erase(iterator position)
+        {
+            typedef typename rep_type::iterator rep_iterator;
+            t.erase((rep_iterator &)position);
+        }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last)
+        {
+            typedef typename rep_type::iterator rep_iterator;
+            t.erase((rep_iterator &)first, (rep_iterator &)last);
+        }
+        void clear() { t.clear(); }
+
+        iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        std::pair<iterator, iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        // 区间查询：与 q 重叠、或包含 p 的区间。overlapping / stabbing 依序把结果的迭代器写入 out
+        bool overlaps(const key_type &q) const { return t.overlaps(q); }
+        iterator find_overlap(const key_type &q) const { return t.find_overlap(q); }
+        iterator find_stab(const T &p) const { return t.find_stab(p); }
+        template <class OutputIterator>
+        OutputIterator overlapping(const key_type &q, OutputIterator out) const
+        {
+            return t.overlapping(q, out);
+        }
+        template <class OutputIterator>
+        OutputIterator stabbing(const T &p, OutputIterator out) const
+        {
+            return t.stabbing(p, out);
+        }
+        template <class Function>
+        Function for_each_overlapping(const key_type &q, Function f) const
+        {
+            return t.for_each_overlapping(q, f);
+        }
+        template <class Function>
+        Function for_each_stabbing(const T &p, Function f) const
+        {
+            return t.for_each_stabbing(p, f);
+        }
+    };
+}
+#endif
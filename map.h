@@ -12,9 +12,13 @@
 
 namespace SimpleSTL
 {
+    // Node 为 RB-tree 的节点型别，指定 __rb_tree_os_node 即可使用 rank() / select()
+    // 指定 __rb_tree_compact_node 或 __rb_tree_index_node 则可缩小节点（见 stl_tree.h）
+    // Alloc 指定为 __rb_tree_pool_alloc<alloc2> 则节点取自这个容器专属的节点池，清空时整批归还
     template <class Key, class T,
               class Compare = less<Key>,
-              class Alloc = alloc2>
+              class Alloc = alloc2,
+              template <class> class Node = __rb_tree_node>
     class map
     {
     public:
@@ -28,7 +32,7 @@ namespace SimpleSTL
         class value_compare
             : public binary_function<value_type, value_type, bool>
         {
-            friend class map<Key, T, Compare, Alloc>;
+            friend class map<Key, T, Compare, Alloc, Node>;
             protected:
                 Compare comp;
                 value_compare(Compare c) : comp(c) {}
@@ -47,7 +51,7 @@ namespace SimpleSTL
         // 以下定义表述型别（representation type）。
         // 以 map 元素型别（一个 pair）的第一型别，作为 RB-tree 节点的键值型别
         typedef rb_tree<key_type, value_type,
-                    select1st<value_type>, key_compare, Alloc> rep_type;
+                    select1st<value_type>, key_compare, Alloc, Node> rep_type;
         rep_type t;
 
     public:
@@ -74,8 +78,14 @@ namespace SimpleSTL
         map(InputIterator first, InputIterator last, const Compare &comp)
             : t(comp) { t.insert_unique(first, last); }
 
-        map(const map<Key, T, Compare, Alloc> &x) : t(x.t) {}
-        map<Key, T, Compare, Alloc> &operator=(const map<Key, T, Compare, Alloc> &x)
+        // 输入已按键值排序且无重复，O(n) 建树
+        template <class ForwardIterator>
+        map(sorted_unique_tag, ForwardIterator first, ForwardIterator last,
+            const Compare &comp = Compare())
+            : t(comp) { t.assign_sorted_unique(first, last); }
+
+        map(const map<Key, T, Compare, Alloc, Node> &x) : t(x.t) {}
+        map<Key, T, Compare, Alloc, Node> &operator=(const map<Key, T, Compare, Alloc, Node> &x)
         {
             t = x.t;
             return *this;
@@ -97,7 +107,7 @@ namespace SimpleSTL
         {
             return (*((insert(value_type(k, T()))).first)).second;
         }
-        void swap(map<Key, T, Compare, Alloc> &x) { t.swap(x.t); }
+        void swap(map<Key, T, Compare, Alloc, Node> &x) { t.swap(x.t); }
 
         //return pair 的值
         pair<iterator, bool> insert(const value_type &x)
@@ -115,37 +125,117 @@ namespace SimpleSTL
         {
             t.insert_unique(first, last);
         }
+        // 插入一段已排序的元素，可以落在已有元素之间；每个元素由前一个元素的位置出发查找，
+        // 相邻元素在树中相距越近，比较次数越少
+        template <class InputIterator>
+        void insert_sorted_run(InputIterator first, InputIterator last)
+        {
+            t.insert_sorted_run(first, last);
+        }
 
         void erase(iterator position) { t.erase(position); }
         size_type erase(const key_type &x) { return t.erase(x); }
         void erase(iterator first, iterator last) { t.erase(first, last); }
+        // 删除键值在 [lo, hi) 的全部元素，只重新平衡一次
+        size_type erase_range(const key_type &lo, const key_type &hi) { return t.erase_range(lo, hi); }
         void clear() { t.clear(); }
+        // 依键值顺序对 [lo, hi) 的每个元素调用 f，不配置内存
+        template <class Function>
+        Function for_each_in_range(const key_type &lo, const key_type &hi, Function f)
+        {
+            return t.for_each_in_range(lo, hi, f);
+        }
+        template <class Function>
+        Function for_each_in_range(const key_type &lo, const key_type &hi, Function f) const
+        {
+            return t.for_each_in_range(lo, hi, f);
+        }
+        // 以按键值排序的 [first, last) 取代全部元素，O(n)；重复的键值只保留第一个
+        template <class ForwardIterator>
+        void assign_sorted(ForwardIterator first, ForwardIterator last)
+        {
+            t.assign_sorted_unique(first, last);
+        }
 
         iterator find(const key_type &x) { return t.find(x); }
         size_type count(const key_type &x) const { return t.count(x); }
-        iterator lower_bound(const key_type &x) const
+        iterator lower_bound(const key_type &x) { return t.lower_bound(x); }
+        const_iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) { return t.upper_bound(x); }
+        const_iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        pair<iterator, iterator> equal_range(const key_type &x) { return t.equal_range(x); }
+        pair<const_iterator, const_iterator> equal_range(const key_type &x) const
         {
-            return t.lower_bound(x);
+            return t.equal_range(x);
         }
-        iterator upper_bound(const key_type &x) const
+
+        // 以下只搬移节点，不复制元素。split：键值不小于 k 的元素移到 x；
+        // join：x 的全部元素移入本map，x 的元素须都大于本map的元素
+        void split(const key_type &k, map<Key, T, Compare, Alloc, Node> &x) { t.split(k, x.t); }
+        void join(map<Key, T, Compare, Alloc, Node> &x) { t.join(x.t); }
+        // [lo, hi) 范围内的元素移到 x
+        void extract_range(const key_type &lo, const key_type &hi, map<Key, T, Compare, Alloc, Node> &x)
         {
-            return t.upper_bound(x);
+            t.extract_range(lo, hi, x.t);
         }
-        pair<iterator, iterator> equal_range(const key_type &x) const
+        // 集合运算，O(m log(n/m + 1))；parallel_depth > 0 时以最多 2^parallel_depth 个线程进行。
+        // merge_from：x 中键值不重复的元素移入本map，重复者留在 x
+        void merge_from(map<Key, T, Compare, Alloc, Node> &x, unsigned parallel_depth = 0)
         {
-            return t.equal_range(x);
+            t.merge_from(x.t, parallel_depth);
+        }
+        // 只保留 x 中也有的键值
+        void intersect_with(const map<Key, T, Compare, Alloc, Node> &x, unsigned parallel_depth = 0)
+        {
+            t.intersect_with(x.t, parallel_depth);
+        }
+        // 删除 x 中也有的键值
+        void subtract(const map<Key, T, Compare, Alloc, Node> &x, unsigned parallel_depth = 0)
+        {
+            t.subtract(x.t, parallel_depth);
+        }
+        // 以 x 的内容取代本map；parallel_depth > 0 时以最多 2^parallel_depth 个线程复制，
+        // 此时 Key 与 T 的复制构造必须可以被并发调用
+        void copy_from(const map<Key, T, Compare, Alloc, Node> &x, unsigned parallel_depth = 0)
+        {
+            t.copy_from(x.t, parallel_depth);
+        }
+        // 按子树分给最多 2^parallel_depth 个线程，对每个元素调用 f（次序不定，f 须可被并发调用）
+        template <class Function>
+        void parallel_for_each(Function f, unsigned parallel_depth)
+        {
+            t.parallel_for_each(f, parallel_depth);
+        }
+        template <class Function>
+        void parallel_for_each(Function f, unsigned parallel_depth) const
+        {
+            t.parallel_for_each(f, parallel_depth);
+        }
+        // 依键值顺序以满足结合律的 op 累积 f(元素)，空map传回 init
+        template <class U, class BinaryOp, class UnaryOp>
+        U parallel_reduce(U init, BinaryOp op, UnaryOp f, unsigned parallel_depth) const
+        {
+            return t.parallel_reduce(init, op, f, parallel_depth);
+        }
+
+        // 以下只在 Node 为 __rb_tree_os_node 时可用，皆为 O(log n)
+        size_type rank(const key_type &x) const { return t.rank(x); }
+        iterator select(size_type n) const { return t.select(n); }
+        difference_type distance(const_iterator first, const_iterator last) const
+        {
+            return t.distance(first, last);
         }
 
-        friend bool operator==(const map<Key, T, Compare, Alloc> &x,
-                               const map<Key, T, Compare, Alloc> &y)
+        friend bool operator==(const map<Key, T, Compare, Alloc, Node> &x,
+                               const map<Key, T, Compare, Alloc, Node> &y)
         {
             return x.t == y.t;
         }
     };
 
-    template <class Key, class T, class Compare, class Alloc>
-    inline bool operator<(const map<Key, T, Compare, Alloc> &x,
-                          const map<Key, T, Compare, Alloc> &y)
+    template <class Key, class T, class Compare, class Alloc, template <class> class Node>
+    inline bool operator<(const map<Key, T, Compare, Alloc, Node> &x,
+                          const map<Key, T, Compare, Alloc, Node> &y)
     {
         return x.t < y.t;
     }
@@ -107,6 +107,10 @@ namespace SimpleSTL
 
 		static void deallocate(T *p)
 		    { Alloc::deallocate(p, sizeof(T));}
+
+		// 内容原样搬到新区块（只适用于可以逐位元搬移的 T）
+		static T *reallocate(T *p, size_t old_n, size_t new_n)
+		    { return (T*) Alloc::reallocate(p, old_n * sizeof(T), new_n * sizeof(T)); }
 	};
 }
 
@@ -0,0 +1,273 @@
+/***
+* mmap_vector<T>：内容存放在档案中的 vector，只适用于可以逐位元复制（trivially copyable）的 T。
+* 整个档案以 MAP_SHARED 映射到内存，元素就是档案的内容：重新开启时直接映射，不必解析或复制。
+* 档案开头是 64 bytes 的表头（识别码、元素大小、元素个数），之后是元素；档案的长度决定容量。
+* 扩充时以 ftruncate 加长档案再以 mremap 重新映射，与 vector 一样会使所有迭代器与指针失效。
+* 修改过的分页由核心在适当的时机写回；需要确定写入磁碟时呼叫 sync()。
+*/
+#ifndef _SIMPLE_STL_MMAP_VECTOR_H_
+#define _SIMPLE_STL_MMAP_VECTOR_H_
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "./stl_growth.h"
+
+namespace SimpleSTL
+{
+    // 开启档案的方式
+    enum mmap_mode
+    {
+        mmap_open,              // 档案必须已经存在
+        mmap_create,            // 建立新档案，已存在的档案会被清空
+        mmap_open_or_create     // 档案存在就开启，否则建立
+    };
+
+    template <class T, class Growth = growth_double>
+    class mmap_vector
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "mmap_vector requires a trivially copyable T");
+
+    public:
+        typedef T value_type;
+        typedef T *pointer;
+        typedef T *iterator;
+        typedef const T *const_iterator;
+        typedef T &reference;
+        typedef const T &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+    protected:
+        struct file_header
+        {
+            char magic[8];
+            uint64_t elem_size;
+            uint64_t size;
+            char reserved[40];
+        };
+        static_assert(sizeof(file_header) == 64, "file_header must stay 64 bytes");
+        static_assert(alignof(T) <= sizeof(file_header), "elements must fit the header alignment");
+
+        int fd;
+        char *base;         // 映射的起点，即表头
+        size_t mapped;      // 映射的 bytes，与档案长度相同
+
+        static const char *magic() { return "SSTLMVEC"; }
+
+        static size_t page_round_up(size_t bytes)
+        {
+            const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+            return (bytes + page - 1) / page * page;
+        }
+
+        file_header *header() const { return (file_header *)base; }
+        T *data_begin() const { return (T *)(base + sizeof(file_header)); }
+        void set_size(size_type n) { header()->size = n; }
+
+        void fail(const char *what)
+        {
+            int err = errno;
+            close_map();
+            throw std::system_error(err, std::system_category(), what);
+        }
+
+        // 档案与映射都调整为 bytes。加长时先加长档案再扩大映射，缩短时相反，
+        // 映射中永远不会有超出档案尾端（存取时引发 SIGBUS）的部分
+        void remap(size_t bytes)
+        {
+            if (bytes > mapped && ftruncate(fd, bytes) != 0)
+                throw std::system_error(errno, std::system_category(), "mmap_vector: ftruncate");
+            void *p;
+            if (base == 0)
+                p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            else
+                p = mremap(base, mapped, bytes, MREMAP_MAYMOVE);
+            if (p == MAP_FAILED)
+                throw std::system_error(errno, std::system_category(), "mmap_vector: mmap");
+            const bool shrinking = bytes < mapped;
+            base = (char *)p;
+            mapped = bytes;     // 映射已经改变，截短档案失败时 mapped 仍须与映射相符
+            if (shrinking && ftruncate(fd, bytes) != 0)
+                throw std::system_error(errno, std::system_category(), "mmap_vector: ftruncate");
+        }
+
+        void close_map()
+        {
+            if (base != 0)
+                munmap(base, mapped);
+            if (fd >= 0)
+                ::close(fd);
+            base = 0;
+            mapped = 0;
+            fd = -1;
+        }
+
+        // 确保还能再放入 n 个元素
+        void make_room(size_type n)
+        {
+            if (size() + n > capacity())
+                reserve(Growth::next(capacity(), size() + n));
+        }
+
+    public:
+        explicit mmap_vector(const char *path, mmap_mode mode = mmap_open_or_create)
+            : fd(-1), base(0), mapped(0)
+        {
+            int flags = O_RDWR | O_CLOEXEC;
+            if (mode == mmap_create)
+                flags |= O_CREAT | O_TRUNC;
+            else if (mode == mmap_open_or_create)
+                flags |= O_CREAT;
+            fd = ::open(path, flags, 0644);
+            if (fd < 0)
+                fail(path);
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+                fail(path);
+            try {
+                if (st.st_size == 0) {  // 新档案：写入表头
+                    remap(page_round_up(sizeof(file_header)));
+                    memcpy(header()->magic, magic(), sizeof(header()->magic));
+                    header()->elem_size = sizeof(T);
+                    header()->size = 0;
+                    return;
+                }
+                if ((size_t)st.st_size < sizeof(file_header))
+                    throw std::runtime_error("mmap_vector: file too small");
+                void *p = mmap(0, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (p == MAP_FAILED)
+                    throw std::system_error(errno, std::system_category(), path);
+                base = (char *)p;
+                mapped = st.st_size;
+                if (memcmp(header()->magic, magic(), sizeof(header()->magic)) != 0)
+                    throw std::runtime_error("mmap_vector: not an mmap_vector file");
+                if (header()->elem_size != sizeof(T))
+                    throw std::runtime_error("mmap_vector: element size mismatch");
+                if (header()->size > capacity())
+                    throw std::runtime_error("mmap_vector: file truncated");
+            }
+            catch(...) {
+                close_map();
+                throw;
+            }
+        }
+
+        mmap_vector(const mmap_vector &) = delete;
+        mmap_vector &operator=(const mmap_vector &) = delete;
+
+        ~mmap_vector() { close_map(); }
+
+        iterator begin() { return data_begin(); }
+        iterator end() { return data_begin() + size(); }
+        const_iterator begin() const { return data_begin(); }
+        const_iterator end() const { return data_begin() + size(); }
+        pointer data() { return data_begin(); }
+
+        size_type size() const { return header()->size; }
+        size_type capacity() const { return (mapped - sizeof(file_header)) / sizeof(T); }
+        bool empty() const { return size() == 0; }
+
+        reference operator[](size_type n) { return data_begin()[n]; }
+        const_reference operator[](size_type n) const { return data_begin()[n]; }
+        reference front() { return *begin(); }
+        reference back() { return *(end() - 1); }
+
+        void reserve(size_type n)
+        {
+            if (n > capacity())
+                remap(page_round_up(sizeof(file_header) + n * sizeof(T)));
+        }
+
+        // 把档案截短到恰好容纳 size() 个元素
+        void shrink_to_fit()
+        {
+            if (capacity() > size())
+                remap(sizeof(file_header) + size() * sizeof(T));
+        }
+
+        void push_back(const T &x)
+        {
+            if (size() == capacity()) {
+                T x_copy = x;   // x 可能就是本 vector 的元素，重新映射之后即失效
+                make_room(1);
+                data_begin()[size()] = x_copy;
+            }
+            else
+                data_begin()[size()] = x;
+            set_size(size() + 1);
+        }
+
+        void pop_back() { set_size(size() - 1); }
+
+        iterator insert(iterator position, const T &x) { return insert(position, 1, x); }
+
+        iterator insert(iterator position, size_type n, const T &x)
+        {
+            const size_type off = position - begin();
+            T x_copy = x;
+            make_room(n);
+            T *p = data_begin() + off;
+            memmove(p + n, p, (size() - off) * sizeof(T));
+            for (size_type i = 0; i < n; ++i)
+                p[i] = x_copy;
+            set_size(size() + n);
+            return p;
+        }
+
+        // [first, last) 不可指向本 vector
+        iterator insert(iterator position, const T *first, const T *last)
+        {
+            const size_type off = position - begin(), n = last - first;
+            make_room(n);
+            T *p = data_begin() + off;
+            memmove(p + n, p, (size() - off) * sizeof(T));
+            memcpy(p, first, n * sizeof(T));
+            set_size(size() + n);
+            return p;
+        }
+
+        iterator erase(iterator first, iterator last)
+        {
+            memmove(first, last, (end() - last) * sizeof(T));
+            set_size(size() - (last - first));
+            return first;
+        }
+
+        iterator erase(iterator position) { return erase(position, position + 1); }
+
+        void resize(size_type n, const T &x = T())
+        {
+            if (n > size())
+                insert(end(), n - size(), x);
+            else
+                set_size(n);
+        }
+
+        void clear() { set_size(0); }
+
+        // 把修改过的分页写回档案；async 为 true 时只排入写回而不等待完成
+        void sync(bool async = false)
+        {
+            if (msync(base, mapped, async ? MS_ASYNC : MS_SYNC) != 0)
+                throw std::system_error(errno, std::system_category(), "mmap_vector: msync");
+        }
+
+        void swap(mmap_vector &x)
+        {
+            std::swap(fd, x.fd);
+            std::swap(base, x.base);
+            std::swap(mapped, x.mapped);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,151 @@
+/***
+* persistent_map：以持久化平衡树为底层机制的 map（键值不重复），接口与 map.h 大致相同。
+* 复制容器（或调用 snapshot()）为 O(1)，得到的快照不随原容器的修改而改变，
+* 适合一个写者不断更新、许多读者线程各自持有快照不加锁读取的场合。
+* 与 map 不同的是：迭代器为常量迭代器，修改元素的实值须经由 operator[]；
+* 任何修改都会使这个容器的迭代器与 operator[] 传回的引用失效（快照的迭代器不受影响）。
+*/
+#ifndef _SIMPLE_STL_PERSISTENT_MAP_H_
+#define _SIMPLE_STL_PERSISTENT_MAP_H_
+
+#include <functional>
+#include "memory.h"
+#include "stl_persistent_tree.h"
+
+namespace SimpleSTL
+{
+    template <class Key, class T,
+              class Compare = less<Key>,
+              class Alloc = alloc1>
+    class persistent_map
+    {
+    public:
+        typedef Key key_type;
+        typedef T data_type;
+        typedef T mapped_type;
+        typedef pair<const Key, T> value_type;
+        typedef Compare key_compare;
+
+        class value_compare
+            : public binary_function<value_type, value_type, bool>
+        {
+            friend class persistent_map<Key, T, Compare, Alloc>;
+            protected:
+                Compare comp;
+                value_compare(Compare c) : comp(c) {}
+            public:
+                bool operator()(const value_type &x, const value_type &y) const
+                {
+                    return comp(x.first, y.first);
+                }
+        };
+
+    private:
+        template <class X>
+        struct select1st : public unary_function<X, typename X::first_type> {
+        	const typename X::first_type& operator()(const X& x) const { return x.first; }
+        };
+        typedef persistent_tree<key_type, value_type,
+                                select1st<value_type>, key_compare, Alloc> rep_type;
+        rep_type t;
+
+    public:
+        typedef typename rep_type::const_pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::const_reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        // 节点可能与快照共用，iterator 即 const_iterator
+        typedef typename rep_type::const_iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        persistent_map() : t(Compare()) {}
+        explicit persistent_map(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        persistent_map(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_unique(first, last); }
+
+        template <class InputIterator>
+        persistent_map(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_unique(first, last); }
+
+        // 复制只是共用根节点，为 O(1)
+        persistent_map(const persistent_map<Key, T, Compare, Alloc> &x) : t(x.t) {}
+        persistent_map<Key, T, Compare, Alloc> &
+        operator=(const persistent_map<Key, T, Compare, Alloc> &x)
+        {
+            t = x.t;
+            return *this;
+        }
+
+        // 取得目前版本的快照，此后本容器的修改不会影响快照
+        persistent_map<Key, T, Compare, Alloc> snapshot() const { return *this; }
+
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return value_compare(t.key_comp()); }
+        const_iterator begin() const { return t.begin(); }
+        const_iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+
+        // 只复制自根至该元素的路径，传回的引用在下一次修改或复制容器之前有效
+        T& operator[](const key_type &k)
+        {
+            if (t.find(k) == t.end())
+                t.insert_unique(value_type(k, T()));
+            return t.modify(k).second;
+        }
+        void swap(persistent_map<Key, T, Compare, Alloc> &x) { t.swap(x.t); }
+
+        pair<iterator, bool> insert(const value_type &x)
+        {
+            return t.insert_unique(x);
+        }
+
+        iterator insert(iterator, const value_type &x)
+        {
+            return t.insert_unique(x).first;
+        }
+
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last) { t.erase(first, last); }
+        void clear() { t.clear(); }
+
+        const_iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        const_iterator lower_bound(const key_type &x) const
+        {
+            return t.lower_bound(x);
+        }
+        const_iterator upper_bound(const key_type &x) const
+        {
+            return t.upper_bound(x);
+        }
+        pair<const_iterator, const_iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const persistent_map<Key, T, Compare, Alloc> &x,
+                               const persistent_map<Key, T, Compare, Alloc> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const persistent_map<Key, T, Compare, Alloc> &x,
+                              const persistent_map<Key, T, Compare, Alloc> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+}
+#endif
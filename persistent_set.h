@@ -0,0 +1,120 @@
+/***
+* persistent_set：以持久化平衡树为底层机制的 set，接口与 set.h 大致相同。
+* 复制容器（或调用 snapshot()）为 O(1)，得到的快照不随原容器的修改而改变，
+* 读者线程各自持有快照即可不加锁地查找、遍历。
+* 任何修改都会使这个容器的迭代器失效（快照的迭代器不受影响）。
+*/
+#ifndef _SIMPLE_STL_PERSISTENT_SET_H_
+#define _SIMPLE_STL_PERSISTENT_SET_H_
+
+#include "stl_persistent_tree.h"
+#include "memory.h"
+#include "stl_iterator.h"
+#include <utility>
+
+namespace SimpleSTL
+{
+    template <class Key, class Compare = less<Key>, class Alloc = alloc1>
+    class persistent_set
+    {
+    public:
+        typedef Key key_type;
+        typedef Key value_type;
+        typedef Compare key_compare;
+        typedef Compare value_compare;
+
+    private:
+        template <class T>
+        struct identity : public unary_function<T, T> {
+            const T& operator()(const T& x) const { return x; }
+        };
+        typedef persistent_tree<key_type, value_type,
+                                identity<value_type>, key_compare, Alloc> rep_type;
+        rep_type t; // 采用持久化平衡树来表现 persistent_set
+
+    public:
+        typedef typename rep_type::const_pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::const_reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::const_iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        persistent_set() : t(Compare()) {}
+        explicit persistent_set(const Compare &comp) : t(comp) {}
+
+        template <class InputIterator>
+        persistent_set(InputIterator first, InputIterator last)
+            : t(Compare()) { t.insert_unique(first, last); }
+
+        template <class InputIterator>
+        persistent_set(InputIterator first, InputIterator last, const Compare &comp)
+            : t(comp) { t.insert_unique(first, last); }
+
+        // 复制只是共用根节点，为 O(1)
+        persistent_set(const persistent_set<Key, Compare, Alloc> &x) : t(x.t) {}
+
+        persistent_set<Key, Compare, Alloc> &
+        operator=(const persistent_set<Key, Compare, Alloc> &x)
+        {
+            t = x.t;
+            return *this;
+        }
+
+        // 取得目前版本的快照，此后本容器的修改不会影响快照
+        persistent_set<Key, Compare, Alloc> snapshot() const { return *this; }
+
+        // accessors:
+        key_compare key_comp() const { return t.key_comp(); }
+        value_compare value_comp() const { return t.key_comp(); }
+        iterator begin() const { return t.begin(); }
+        iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+        void swap(persistent_set<Key, Compare, Alloc> &x) { t.swap(x.t); }
+
+        typedef pair<iterator, bool> pair_iterator_bool;
+        pair_iterator_bool insert(const value_type &x)
+        {
+            return t.insert_unique(x);
+        }
+        iterator insert(iterator, const value_type &x)
+        {
+            return t.insert_unique(x).first;
+        }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last) { t.erase(first, last); }
+
+        void clear() { t.clear(); }
+        iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        std::pair<iterator, iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const persistent_set<Key, Compare, Alloc> &x,
+                               const persistent_set<Key, Compare, Alloc> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const persistent_set<Key, Compare, Alloc> &x,
+                              const persistent_set<Key, Compare, Alloc> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+}
+#endif
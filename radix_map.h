@@ -0,0 +1,141 @@
+/***
+* radix_map：以自适应基数树为底层机制、键值为 std::string 的 map，接口与 map.h 相同。
+* 查找只与键值长度有关；键值共享长前缀（路径、URL、路由前缀）时不必像 map 那样在每一层重新比较前缀。
+* 另外提供 prefix_range()（列举以某字串为前缀的全部元素）与 longest_prefix()（最长前缀匹配）。
+* 键值依 std::string 的 operator< 排序；插入、删除不会使其他元素的迭代器失效。
+*/
+#ifndef _SIMPLE_STL_RADIX_MAP_H_
+#define _SIMPLE_STL_RADIX_MAP_H_
+
+#include <functional>
+#include <string>
+#include "memory.h"
+#include "stl_radix_tree.h"
+
+namespace SimpleSTL
+{
+    template <class T, class Alloc = alloc2>
+    class radix_map
+    {
+    public:
+        typedef std::string key_type;
+        typedef T data_type;
+        typedef T mapped_type;
+        typedef pair<const key_type, T> value_type;
+        typedef less<key_type> key_compare;
+
+        class value_compare
+            : public binary_function<value_type, value_type, bool>
+        {
+            friend class radix_map<T, Alloc>;
+            protected:
+                key_compare comp;
+                value_compare(key_compare c) : comp(c) {}
+            public:
+                bool operator()(const value_type &x, const value_type &y) const
+                {
+                    return comp(x.first, y.first);
+                }
+        };
+
+    private:
+        template <class X>
+        struct select1st : public unary_function<X, typename X::first_type> {
+        	const typename X::first_type& operator()(const X& x) const { return x.first; }
+        };
+        typedef radix_tree<value_type, select1st<value_type>, Alloc> rep_type;
+        rep_type t;
+
+    public:
+        typedef typename rep_type::pointer pointer;
+        typedef typename rep_type::const_pointer const_pointer;
+        typedef typename rep_type::reference reference;
+        typedef typename rep_type::const_reference const_reference;
+        typedef typename rep_type::iterator iterator;
+        typedef typename rep_type::const_iterator const_iterator;
+        typedef typename rep_type::size_type size_type;
+        typedef typename rep_type::difference_type difference_type;
+
+        radix_map() {}
+
+        template <class InputIterator>
+        radix_map(InputIterator first, InputIterator last) { t.insert_unique(first, last); }
+
+        radix_map(const radix_map<T, Alloc> &x) : t(x.t) {}
+        radix_map<T, Alloc> &operator=(const radix_map<T, Alloc> &x)
+        {
+            t = x.t;
+            return *this;
+        }
+
+        key_compare key_comp() const { return key_compare(); }
+        value_compare value_comp() const { return value_compare(key_compare()); }
+        iterator begin() { return t.begin(); }
+        const_iterator begin() const { return t.begin(); }
+        iterator end() { return t.end(); }
+        const_iterator end() const { return t.end(); }
+        bool empty() const { return t.empty(); }
+        size_type size() const { return t.size(); }
+        size_type max_size() const { return t.max_size(); }
+
+        T& operator[](const key_type &k)
+        {
+            return (*((insert(value_type(k, T()))).first)).second;
+        }
+        void swap(radix_map<T, Alloc> &x) { t.swap(x.t); }
+
+        pair<iterator, bool> insert(const value_type &x)
+        {
+            return t.insert_unique(x);
+        }
+
+        iterator insert(iterator position, const value_type &x)
+        {
+            return t.insert_unique(position, x);
+        }
+
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last)
+        {
+            t.insert_unique(first, last);
+        }
+
+        void erase(iterator position) { t.erase(position); }
+        size_type erase(const key_type &x) { return t.erase(x); }
+        void erase(iterator first, iterator last) { t.erase(first, last); }
+        void clear() { t.clear(); }
+
+        iterator find(const key_type &x) { return t.find(x); }
+        const_iterator find(const key_type &x) const { return t.find(x); }
+        size_type count(const key_type &x) const { return t.count(x); }
+        iterator lower_bound(const key_type &x) { return t.lower_bound(x); }
+        const_iterator lower_bound(const key_type &x) const { return t.lower_bound(x); }
+        iterator upper_bound(const key_type &x) { return t.upper_bound(x); }
+        const_iterator upper_bound(const key_type &x) const { return t.upper_bound(x); }
+        pair<iterator, iterator> equal_range(const key_type &x) { return t.equal_range(x); }
+        pair<const_iterator, const_iterator> equal_range(const key_type &x) const
+        {
+            return t.equal_range(x);
+        }
+
+        // 键值以 p 开头的全部元素，依键值顺序
+        pair<iterator, iterator> prefix_range(const key_type &p) { return t.prefix_range(p); }
+        pair<const_iterator, const_iterator> prefix_range(const key_type &p) const
+        {
+            return t.prefix_range(p);
+        }
+        // 键值为 k 的前缀的元素中最长的一个（含键值等于 k 者），没有则传回 end()
+        iterator longest_prefix(const key_type &k) { return t.longest_prefix(k); }
+        const_iterator longest_prefix(const key_type &k) const { return t.longest_prefix(k); }
+
+        friend bool operator==(const radix_map<T, Alloc> &x, const radix_map<T, Alloc> &y)
+        {
+            return x.t == y.t;
+        }
+        friend bool operator<(const radix_map<T, Alloc> &x, const radix_map<T, Alloc> &y)
+        {
+            return x.t < y.t;
+        }
+    };
+}
+#endif
@@ -0,0 +1,333 @@
+/***
+* segmented_vector<T>：扩充时不搬移元素的 vector，元素的地址在元素存在期间永远不变。
+* 元素存放在一连串的段（segment）中：第 k 段容纳 B * 2^k 个元素（B = 2^LogBase），
+* 第 k 段的第一个元素是第 B * (2^k - 1) 个元素。因此 i + B 的最高位元直接指出 i 所在的段与段内的位置，
+* operator[] 只需一次 count leading zeros 与一次查表。段的指针放在一个固定大小的小表中，表本身也不会重新配置。
+* 段在第一次需要时才配置，闲置的空间不超过已使用的空间；大的段经由 malloc 取得 mmap 的内存，分页在第一次写入时才真正占用。
+* 只支援在尾端增删元素。
+*/
+#ifndef _SIMPLE_STL_SEGMENTED_VECTOR_H_
+#define _SIMPLE_STL_SEGMENTED_VECTOR_H_
+
+#include "./memory.h"
+#include "./stl_iterator.h"
+
+namespace SimpleSTL
+{
+    // j 的最高位元的位置，j 不可为 0。size_t 先扩展成 unsigned long long，不论 size_t 是 32 或 64 位都正确
+    inline size_t __segment_log2(size_t j)
+    {
+        return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(j);
+    }
+
+    // 第 i 个元素的位置
+    template <class T, size_t LogBase>
+    inline T *__segment_address(T *const *segs, size_t i)
+    {
+        const size_t j = i + (size_t(1) << LogBase);
+        const size_t h = __segment_log2(j);
+        return segs[h - LogBase] + (j - (size_t(1) << h));
+    }
+
+    // 第 i 个元素是否为某一段的第一个元素
+    template <size_t LogBase>
+    inline bool __segment_boundary(size_t i)
+    {
+        const size_t j = i + (size_t(1) << LogBase);
+        return (j & (j - 1)) == 0;
+    }
+
+    template <class T, class Ref, class Ptr, size_t LogBase>
+    struct __segmented_iterator
+    {
+        typedef __segmented_iterator<T, T &, T *, LogBase> iterator;
+        typedef __segmented_iterator<T, Ref, Ptr, LogBase> self;
+
+        typedef random_access_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef Ptr pointer;
+        typedef Ref reference;
+        typedef ptrdiff_t difference_type;
+
+        T *const *segs;     // 容器的段表
+        size_t i;           // 元素的序号
+        T *cur;             // 第 i 个元素的位置，在同一段中前进时不必重新计算
+
+        __segmented_iterator() : segs(0), i(0), cur(0) {}
+        __segmented_iterator(T *const *s, size_t n) : segs(s), i(n), cur(__segment_address<T, LogBase>(s, n)) {}
+        __segmented_iterator(const iterator &x) : segs(x.segs), i(x.i), cur(x.cur) {}
+
+        reference operator*() const { return *cur; }
+        pointer operator->() const { return cur; }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        self &operator++()
+        {
+            ++i;
+            if (__segment_boundary<LogBase>(i))     // 进入下一段
+                cur = __segment_address<T, LogBase>(segs, i);
+            else
+                ++cur;
+            return *this;
+        }
+        self operator++(int)
+        {
+            self tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        self &operator--()
+        {
+            if (__segment_boundary<LogBase>(i))     // 回到上一段
+                cur = __segment_address<T, LogBase>(segs, i - 1);
+            else
+                --cur;
+            --i;
+            return *this;
+        }
+        self operator--(int)
+        {
+            self tmp = *this;
+            --*this;
+            return tmp;
+        }
+        self &operator+=(difference_type n)
+        {
+            i += n;
+            cur = __segment_address<T, LogBase>(segs, i);
+            return *this;
+        }
+        self &operator-=(difference_type n) { return *this += -n; }
+        self operator+(difference_type n) const
+        {
+            self tmp = *this;
+            return tmp += n;
+        }
+        self operator-(difference_type n) const
+        {
+            self tmp = *this;
+            return tmp -= n;
+        }
+        difference_type operator-(const self &x) const { return difference_type(i) - difference_type(x.i); }
+
+        bool operator==(const self &x) const { return i == x.i; }
+        bool operator!=(const self &x) const { return i != x.i; }
+        bool operator<(const self &x) const { return i < x.i; }
+        bool operator>(const self &x) const { return i > x.i; }
+        bool operator<=(const self &x) const { return i <= x.i; }
+        bool operator>=(const self &x) const { return i >= x.i; }
+    };
+
+    template <class T, class Alloc = alloc2, size_t LogBase = 6>
+    class segmented_vector
+    {
+        static_assert(LogBase < sizeof(size_t) * 8, "LogBase must be smaller than the width of size_t");
+
+    public:
+        typedef T value_type;
+        typedef T *pointer;
+        typedef T &reference;
+        typedef const T &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef __segmented_iterator<T, T &, T *, LogBase> iterator;
+        typedef __segmented_iterator<T, const T &, const T *, LogBase> const_iterator;
+
+    protected:
+        typedef simple_alloc<T, Alloc> data_allocator;
+
+        enum { max_segments = sizeof(size_t) * 8 - LogBase };  // 足以容纳 SIZE_MAX + 1 - B 个元素
+
+        T *segs[max_segments];  // 未配置的段为 0
+        size_type nsegs;        // 已配置的段数
+        size_type len;
+        T *tail;                // 第 len 个元素的位置，以及它所在的段的尾端；该段尚未配置时都是 0，
+        T *tail_end;            // push_back 在同一段中只需比较这两个指针
+
+        static size_type base() { return size_type(1) << LogBase; }
+        static size_type segment_size(size_type k) { return base() << k; }
+        // 第 k 段的第一个元素的序号，也是前 k 段的总容量
+        static size_type segment_start(size_type k) { return (base() << k) - base(); }
+
+        T *address(size_type i) const { return __segment_address<T, LogBase>(segs, i); }
+
+        void add_segment()
+        {
+            segs[nsegs] = data_allocator::allocate(segment_size(nsegs));
+            ++nsegs;
+        }
+
+        // len 或段表改变之后重新计算 tail 与 tail_end
+        void reset_tail()
+        {
+            if (len < capacity()) {
+                const size_type k = __segment_log2(len + base()) - LogBase;
+                tail = address(len);
+                tail_end = segs[k] + segment_size(k);
+            }
+            else
+                tail = tail_end = 0;
+        }
+
+        // 解构 [first, len) 中的元素，逐段处理
+        void destroy_from(size_type first)
+        {
+            for (size_type k = 0; k < nsegs && segment_start(k) < len; ++k) {
+                size_type lo = segment_start(k), hi = segment_start(k + 1);
+                if (hi <= first)
+                    continue;
+                if (lo < first)
+                    lo = first;
+                if (hi > len)
+                    hi = len;
+                SimpleSTL::destroy(segs[k] + (lo - segment_start(k)), segs[k] + (hi - segment_start(k)));
+            }
+            len = first;
+            reset_tail();
+        }
+
+        // 释放第 k 段以后的所有段，这些段中不可以有元素
+        void release_segments(size_type k)
+        {
+            while (nsegs > k) {
+                --nsegs;
+                data_allocator::deallocate(segs[nsegs], segment_size(nsegs));
+                segs[nsegs] = 0;
+            }
+            reset_tail();
+        }
+
+    public:
+        segmented_vector() : nsegs(0), len(0), tail(0), tail_end(0)
+        {
+            for (size_type k = 0; k < max_segments; ++k)
+                segs[k] = 0;
+        }
+
+        segmented_vector(size_type n, const T &x) : nsegs(0), len(0), tail(0), tail_end(0)
+        {
+            for (size_type k = 0; k < max_segments; ++k)
+                segs[k] = 0;
+            try {
+                resize(n, x);
+            }
+            catch(...) {    // 解构式不会执行，自行释放已构造的元素与已配置的段
+                destroy_from(0);
+                release_segments(0);
+                throw;
+            }
+        }
+
+        segmented_vector(const segmented_vector &x) : nsegs(0), len(0), tail(0), tail_end(0)
+        {
+            for (size_type k = 0; k < max_segments; ++k)
+                segs[k] = 0;
+            try {
+                reserve(x.len);
+                for (const_iterator it = x.begin(); it != x.end(); ++it)
+                    push_back(*it);
+            }
+            catch(...) {
+                destroy_from(0);
+                release_segments(0);
+                throw;
+            }
+        }
+
+        segmented_vector &operator=(const segmented_vector &x)
+        {
+            if (this != &x) {
+                segmented_vector tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        ~segmented_vector()
+        {
+            destroy_from(0);
+            release_segments(0);
+        }
+
+        iterator begin() { return iterator(segs, 0); }
+        iterator end() { return iterator(segs, len); }
+        const_iterator begin() const { return const_iterator(segs, 0); }
+        const_iterator end() const { return const_iterator(segs, len); }
+
+        size_type size() const { return len; }
+        size_type capacity() const { return segment_start(nsegs); }
+        size_type segment_count() const { return nsegs; }
+        bool empty() const { return len == 0; }
+
+        reference operator[](size_type n) { return *address(n); }
+        const_reference operator[](size_type n) const { return *address(n); }
+        reference front() { return *address(0); }
+        reference back() { return *address(len - 1); }
+
+        // 新的元素放在尾端，已有元素的地址都不变
+        void push_back(const T &x)
+        {
+            if (tail == tail_end) {     // 进入下一段
+                if (len == capacity())
+                    add_segment();
+                reset_tail();
+            }
+            SimpleSTL::construct(tail, x);
+            ++tail;
+            ++len;
+        }
+
+        void pop_back()
+        {
+            --len;
+            SimpleSTL::destroy(address(len));
+            reset_tail();
+        }
+
+        void resize(size_type n, const T &x)
+        {
+            if (n < len)
+                destroy_from(n);
+            else {
+                T x_copy = x;   // x 可能就是本容器的元素
+                reserve(n);
+                while (len < n)
+                    push_back(x_copy);
+            }
+        }
+        void resize(size_type n) { resize(n, T()); }
+
+        // 预先配置足够容纳 n 个元素的段
+        void reserve(size_type n)
+        {
+            if (capacity() >= n)
+                return;
+            while (capacity() < n)
+                add_segment();
+            reset_tail();
+        }
+
+        // 释放没有元素的段
+        void shrink_to_fit()
+        {
+            size_type k = 0;
+            while (k < nsegs && segment_start(k) < len)
+                ++k;
+            release_segments(k);
+        }
+
+        void clear() { destroy_from(0); }
+
+        void swap(segmented_vector &x)
+        {
+            for (size_type k = 0; k < max_segments; ++k)
+                std::swap(segs[k], x.segs[k]);
+            std::swap(nsegs, x.nsegs);
+            std::swap(len, x.len);
+            std::swap(tail, x.tail);
+            std::swap(tail_end, x.tail_end);
+        }
+    };
+}
+
+#endif
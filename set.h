@@ -8,7 +8,11 @@
 
 namespace SimpleSTL
 {
-    template <class Key, class Compare = less<Key>, class Alloc = alloc2>
+    // Node 为 RB-tree 的节点型别，指定 __rb_tree_os_node 即可使用 rank() / select()
+    // 指定 __rb_tree_compact_node 或 __rb_tree_index_node 则可缩小节点（见 stl_tree.h）
+    // Alloc 指定为 __rb_tree_pool_alloc<alloc2> 则节点取自这个容器专属的节点池，清空时整批归还
+    template <class Key, class Compare = less<Key>, class Alloc = alloc2,
+              template <class> class Node = __rb_tree_node>
     class set
     {
     public:
@@ -24,7 +28,7 @@ namespace SimpleSTL
             const T& operator()(const T& x) const { return x; }
         };
         typedef rb_tree<key_type, value_type,
-                    identity<value_type>, key_compare, Alloc> rep_type;
+                    identity<value_type>, key_compare, Alloc, Node> rep_type;
         rep_type t; //采用红黑树（RB-tree）来表现set
 
     public:
@@ -54,9 +58,15 @@ namespace SimpleSTL
         set(InputIterator first, InputIterator last, const Compare &comp)
             : t(comp) { t.insert_unique(first, last); }
 
-        set(const set<Key, Compare, Alloc> &x) : t(x.t) {}
+        // 输入已排序且无重复，O(n) 建树
+        template <class ForwardIterator>
+        set(sorted_unique_tag, ForwardIterator first, ForwardIterator last,
+            const Compare &comp = Compare())
+            : t(comp) { t.assign_sorted_unique(first, last); }
 
-        set<Key, Compare, Alloc> &operator=(const set<Key, Compare, Alloc> &x)
+        set(const set<Key, Compare, Alloc, Node> &x) : t(x.t) {}
+
+        set<Key, Compare, Alloc, Node> &operator=(const set<Key, Compare, Alloc, Node> &x)
         {
             t = x.t;
             return *this;
@@ -75,7 +85,7 @@ namespace SimpleSTL
         bool empty() const { return t.empty(); }
         size_type size() const { return t.size(); }
         size_type max_size() const { return t.max_size(); }
-        void swap(set<Key, Compare, Alloc> &x) { t.swap(x.t); }
+        void swap(set<Key, Compare, Alloc, Node> &x) { t.swap(x.t); }
 
         typedef pair<iterator, bool> pair_iterator_bool;
         pair_iterator_bool insert(const value_type &x)
@@ -91,7 +101,14 @@ namespace SimpleSTL
         template <class InputIterator>
         void insert(InputIterator first, InputIterator last)
         {
-            t.insert(first, last);
+            t.insert_unique(first, last);
+        }
+        // 插入一段已排序的元素，可以落在已有元素之间；每个元素由前一个元素的位置出发查找，
+        // 相邻元素在树中相距越近，比较次数越少
+        template <class InputIterator>
+        void insert_sorted_run(InputIterator first, InputIterator last)
+        {
+            t.insert_sorted_run(first, last);
         }
 
         void erase(iterator position)
@@ -108,8 +125,25 @@ namespace SimpleSTL
             typedef typename rep_type::iterator rep_iterator;
             t.erase((rep_iterator &)first, (rep_iterator &)last);
         }
+        // 删除 [lo, hi) 的全部元素，只重新平衡一次
+        size_type erase_range(const key_type &lo, const key_type &hi)
+        {
+            return t.erase_range(lo, hi);
+        }
 
         void clear() { t.clear(); }
+        // 依序对 [lo, hi) 的每个元素调用 f，不配置内存
+        template <class Function>
+        Function for_each_in_range(const key_type &lo, const key_type &hi, Function f) const
+        {
+            return t.for_each_in_range(lo, hi, f);
+        }
+        // 以已排序的 [first, last) 取代全部元素，O(n)；重复的元素只保留第一个
+        template <class ForwardIterator>
+        void assign_sorted(ForwardIterator first, ForwardIterator last)
+        {
+            t.assign_sorted_unique(first, last);
+        }
         iterator find(const key_type &x) { return t.find(x); }
         const_iterator find(const key_type &x) const { return t.find(x); }
         size_type count(const key_type &x) const { return t.count(x); }
@@ -125,18 +159,70 @@ namespace SimpleSTL
         {
             return t.equal_range(x);
         }
+
+        // 以下只搬移节点，不复制元素。split：键值不小于 k 的元素移到 x；
+        // join：x 的全部元素移入本set，x 的元素须都大于本set的元素
+        void split(const key_type &k, set<Key, Compare, Alloc, Node> &x) { t.split(k, x.t); }
+        void join(set<Key, Compare, Alloc, Node> &x) { t.join(x.t); }
+        // [lo, hi) 范围内的元素移到 x
+        void extract_range(const key_type &lo, const key_type &hi, set<Key, Compare, Alloc, Node> &x)
+        {
+            t.extract_range(lo, hi, x.t);
+        }
+        // 集合运算，O(m log(n/m + 1))；parallel_depth > 0 时以最多 2^parallel_depth 个线程进行。
+        // merge_from：x 中键值不重复的元素移入本set，重复者留在 x
+        void merge_from(set<Key, Compare, Alloc, Node> &x, unsigned parallel_depth = 0)
+        {
+            t.merge_from(x.t, parallel_depth);
+        }
+        // 只保留 x 中也有的键值
+        void intersect_with(const set<Key, Compare, Alloc, Node> &x, unsigned parallel_depth = 0)
+        {
+            t.intersect_with(x.t, parallel_depth);
+        }
+        // 删除 x 中也有的键值
+        void subtract(const set<Key, Compare, Alloc, Node> &x, unsigned parallel_depth = 0)
+        {
+            t.subtract(x.t, parallel_depth);
+        }
+        // 以 x 的内容取代本set；parallel_depth > 0 时以最多 2^parallel_depth 个线程复制，
+        // 此时 Key 的复制构造必须可以被并发调用
+        void copy_from(const set<Key, Compare, Alloc, Node> &x, unsigned parallel_depth = 0)
+        {
+            t.copy_from(x.t, parallel_depth);
+        }
+        // 按子树分给最多 2^parallel_depth 个线程，对每个元素调用 f（次序不定，f 须可被并发调用）
+        template <class Function>
+        void parallel_for_each(Function f, unsigned parallel_depth) const
+        {
+            t.parallel_for_each(f, parallel_depth);
+        }
+        // 依序以满足结合律的 op 累积 f(元素)，空set传回 init
+        template <class U, class BinaryOp, class UnaryOp>
+        U parallel_reduce(U init, BinaryOp op, UnaryOp f, unsigned parallel_depth) const
+        {
+            return t.parallel_reduce(init, op, f, parallel_depth);
+        }
+
+        // 以下只在 Node 为 __rb_tree_os_node 时可用，皆为 O(log n)
+        size_type rank(const key_type &x) const { return t.rank(x); }
+        iterator select(size_type n) const { return t.select(n); }
+        difference_type distance(iterator first, iterator last) const
+        {
+            return t.distance(first, last);
+        }
     };
 
-    template <class Key, class Compare, class Alloc>
-    inline bool operator==(const set<Key, Compare, Alloc> &x,
-                           const set<Key, Compare, Alloc> &y)
+    template <class Key, class Compare, class Alloc, template <class> class Node>
+    inline bool operator==(const set<Key, Compare, Alloc, Node> &x,
+                           const set<Key, Compare, Alloc, Node> &y)
     {
         return x.t == y.t;
     }
 
-    template <class Key, class Compare, class Alloc>
-    inline bool operator<(const set<Key, Compare, Alloc> &x,
-                          const set<Key, Compare, Alloc> &y)
+    template <class Key, class Compare, class Alloc, template <class> class Node>
+    inline bool operator<(const set<Key, Compare, Alloc, Node> &x,
+                          const set<Key, Compare, Alloc, Node> &y)
     {
         return x.t < y.t;
     }
@@ -0,0 +1,45 @@
+/***
+* small_vector<T, N>：前 N 个元素存放在对象内部的 vector。
+* 元素不超过 N 个时完全不配置内存；超过时与 vector 一样经由 Alloc 配置空间，元素搬到堆上，直到 shrink_to_fit 才会搬回内部空间。
+* 它就是 vector<T, __inline_alloc<N, Alloc>, Growth>，所有接口与算法都与 vector 共用。
+* 与 vector 不同的是，swap 在任一方的元素位于内部空间时须逐一复制元素，迭代器随之失效。
+*/
+#ifndef _SIMPLE_STL_SMALL_VECTOR_H_
+#define _SIMPLE_STL_SMALL_VECTOR_H_
+
+#include "./vector.h"
+
+namespace SimpleSTL
+{
+    template <class T, size_t N, class Alloc = alloc2, class Growth = growth_double>
+    class small_vector : public vector<T, __inline_alloc<N, Alloc>, Growth>
+    {
+        typedef vector<T, __inline_alloc<N, Alloc>, Growth> base;
+
+    public:
+        typedef typename base::size_type size_type;
+
+        small_vector() {}
+        small_vector(size_type n, const T &value) : base(n, value) {}
+        small_vector(int n, const T &value) : base(n, value) {}
+        small_vector(long n, const T &value) : base(n, value) {}
+        small_vector(const std::initializer_list<T> v) : base(v) {}
+        template <class InputIterator>
+        small_vector(InputIterator first, InputIterator last) : base(first, last) {}
+        explicit small_vector(size_type n) : base(n) {}
+        small_vector(size_type n, default_init_t) : base(n, default_init) {}
+        small_vector(const small_vector &x) : base(x) {}
+
+        small_vector &operator=(const small_vector &x)
+        {
+            base::operator=(x);
+            return *this;
+        }
+
+        // 元素是否仍在内部空间中
+        bool is_inline() const { return base::is_inline(); }
+        static size_type inline_capacity() { return N; }
+    };
+}
+
+#endif
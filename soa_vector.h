@@ -0,0 +1,521 @@
+/***
+* soa_vector<Fields...>：以「数组的结构」（structure of arrays）存放的 vector。
+* 每个字段各自存放在一段连续的空间中，只用到其中两三个字段的循环只会读取这些字段，不会把整笔资料载入快取。
+* 逐笔存取经由 row 代理物件：row.get<I>() 传回第 I 个字段的引用，也可以与 std::tuple<Fields...> 互相转换；
+* 整个字段以 column<I>() 取得 column_span，即一段连续的 T[]，可以直接交给 SIMD 核心。
+* 每个字段的空间都经由 simple_alloc<Field, Alloc> 配置，例如 basic_soa_vector<align_alloc<64>, ...> 的每个字段都对齐到 64 bytes。
+* 成长时所有字段一起扩充；任何字段的重新配置都会使所有字段的指针失效。
+*/
+#ifndef _SIMPLE_STL_SOA_VECTOR_H_
+#define _SIMPLE_STL_SOA_VECTOR_H_
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "./memory.h"
+#include "./algorithm.h"
+#include "./stl_iterator.h"
+#include "./stl_growth.h"
+
+namespace SimpleSTL
+{
+    // 一个字段的连续空间
+    template <class T>
+    struct column_span
+    {
+        typedef T value_type;
+        typedef T *iterator;
+        typedef size_t size_type;
+
+        T *first;
+        size_t n;
+
+        column_span(T *p, size_t len) : first(p), n(len) {}
+
+        T *data() const { return first; }
+        size_t size() const { return n; }
+        bool empty() const { return n == 0; }
+        T *begin() const { return first; }
+        T *end() const { return first + n; }
+        T &operator[](size_t i) const { return first[i]; }
+    };
+
+    // 0, 1, ..., N-1 的编译期序列，用来同时展开每个字段
+    template <size_t... Is>
+    struct __soa_indices {};
+
+    template <size_t N, size_t... Is>
+    struct __make_soa_indices : __make_soa_indices<N - 1, N - 1, Is...> {};
+
+    template <size_t... Is>
+    struct __make_soa_indices<0, Is...> { typedef __soa_indices<Is...> type; };
+
+    // 第 i 笔资料的代理物件：只记住各字段的起点与 i。读取的部分由 __soa_row_base 提供，
+    // 只有 Const 为 false 的 __soa_row 可以赋值，const 容器传回的代理物件不能写入
+    template <bool Const, class... Fields>
+    class __soa_row_base
+    {
+    protected:
+        typedef std::tuple<Fields *...> column_pointers;
+        typedef typename __make_soa_indices<sizeof...(Fields)>::type indices;
+
+        const column_pointers *cols;
+        size_t i;
+
+        template <size_t... Is>
+        std::tuple<Fields...> to_tuple(__soa_indices<Is...>) const
+        {
+            return std::tuple<Fields...>(std::get<Is>(*cols)[i]...);
+        }
+
+        template <size_t... Is>
+        void assign(const std::tuple<Fields...> &x, __soa_indices<Is...>) const
+        {
+            int expand[] = {0, (std::get<Is>(*cols)[i] = std::get<Is>(x), 0)...};
+            (void)expand;
+        }
+
+    public:
+        typedef std::tuple<Fields...> value_type;
+
+        template <size_t I>
+        struct field
+        {
+            typedef typename std::tuple_element<I, value_type>::type type;
+            typedef typename std::conditional<Const, const type &, type &>::type reference;
+        };
+
+        __soa_row_base(const column_pointers *c, size_t n) : cols(c), i(n) {}
+
+        template <size_t I>
+        typename field<I>::reference get() const { return std::get<I>(*cols)[i]; }
+
+        size_t index() const { return i; }
+
+        operator value_type() const { return to_tuple(indices()); }
+    };
+
+    // const_reference：只能读取
+    template <bool Const, class... Fields>
+    class __soa_row : public __soa_row_base<Const, Fields...>
+    {
+        typedef __soa_row_base<Const, Fields...> base;
+
+    public:
+        __soa_row(const typename base::column_pointers *c, size_t n) : base(c, n) {}
+
+        __soa_row &operator=(const __soa_row &) = delete;
+    };
+
+    // reference：代理物件的赋值是把值写入容器，而不是改变它所代表的位置
+    template <class... Fields>
+    class __soa_row<false, Fields...> : public __soa_row_base<false, Fields...>
+    {
+        typedef __soa_row_base<false, Fields...> base;
+
+    public:
+        typedef typename base::value_type value_type;
+
+        __soa_row(const typename base::column_pointers *c, size_t n) : base(c, n) {}
+
+        const __soa_row &operator=(const value_type &x) const
+        {
+            this->assign(x, typename base::indices());
+            return *this;
+        }
+        const __soa_row &operator=(const __soa_row &x) const
+        {
+            this->assign(value_type(x), typename base::indices());
+            return *this;
+        }
+    };
+
+    template <bool Const, class... Fields>
+    struct __soa_iterator
+        : public iterator<random_access_iterator_tag, std::tuple<Fields...>, ptrdiff_t,
+                          void, __soa_row<Const, Fields...> >
+    {
+        typedef __soa_iterator<Const, Fields...> self;
+        typedef __soa_row<Const, Fields...> reference;
+        typedef ptrdiff_t difference_type;
+
+        const std::tuple<Fields *...> *cols;
+        size_t i;
+
+        __soa_iterator() : cols(0), i(0) {}
+        __soa_iterator(const std::tuple<Fields *...> *c, size_t n) : cols(c), i(n) {}
+        __soa_iterator(const __soa_iterator<false, Fields...> &x) : cols(x.cols), i(x.i) {}
+
+        reference operator*() const { return reference(cols, i); }
+        reference operator[](difference_type n) const { return reference(cols, i + n); }
+
+        self &operator++() { ++i; return *this; }
+        self operator++(int) { self tmp = *this; ++i; return tmp; }
+        self &operator--() { --i; return *this; }
+        self operator--(int) { self tmp = *this; --i; return tmp; }
+        self &operator+=(difference_type n) { i += n; return *this; }
+        self &operator-=(difference_type n) { i -= n; return *this; }
+        self operator+(difference_type n) const { return self(cols, i + n); }
+        self operator-(difference_type n) const { return self(cols, i - n); }
+        difference_type operator-(const self &x) const { return difference_type(i) - difference_type(x.i); }
+
+        bool operator==(const self &x) const { return i == x.i; }
+        bool operator!=(const self &x) const { return i != x.i; }
+        bool operator<(const self &x) const { return i < x.i; }
+        bool operator>(const self &x) const { return i > x.i; }
+        bool operator<=(const self &x) const { return i <= x.i; }
+        bool operator>=(const self &x) const { return i >= x.i; }
+    };
+
+    template <class Alloc, class... Fields>
+    class basic_soa_vector
+    {
+        static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+
+    public:
+        typedef std::tuple<Fields...> value_type;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef __soa_row<false, Fields...> reference;
+        typedef __soa_row<true, Fields...> const_reference;
+        typedef __soa_iterator<false, Fields...> iterator;
+        typedef __soa_iterator<true, Fields...> const_iterator;
+
+        // 第 I 个字段的型别
+        template <size_t I>
+        struct field
+        {
+            typedef typename std::tuple_element<I, value_type>::type type;
+        };
+
+        static const size_t columns = sizeof...(Fields);
+
+    protected:
+        typedef std::tuple<Fields *...> column_pointers;
+        typedef typename __make_soa_indices<sizeof...(Fields)>::type indices;
+        typedef std::integral_constant<size_t, sizeof...(Fields)> columns_end;
+
+        column_pointers cols;     // 每个字段的起点，尚未配置时为 0
+        size_type len;            // 资料笔数
+        size_type cap;            // 每个字段都配置了 cap 个元素的空间
+
+        template <size_t I>
+        typename field<I>::type *column_data() const { return std::get<I>(cols); }
+
+        // 在 [len, len + n) 上构造元素，每个字段各自复制 src 的 [0, n)。
+        // 某个字段构造失败时，已构造的字段先解构再抛出，因此不会留下半笔资料
+        template <size_t I>
+        void uninitialized_copy_columns(const column_pointers &src, size_type n,
+                                        std::integral_constant<size_t, I>)
+        {
+            typename field<I>::type *dst = column_data<I>() + len;
+            SimpleSTL::uninitialized_copy(std::get<I>(src), std::get<I>(src) + n, dst);
+            try {
+                uninitialized_copy_columns(src, n, std::integral_constant<size_t, I + 1>());
+            }
+            catch(...) {
+                SimpleSTL::destroy(dst, dst + n);
+                throw;
+            }
+        }
+        void uninitialized_copy_columns(const column_pointers &, size_type, columns_end) {}
+
+        // 在 [len, len + n) 上构造 n 笔资料，都是 x 的副本
+        template <size_t I>
+        void uninitialized_fill_columns(const value_type &x, size_type n,
+                                        std::integral_constant<size_t, I>)
+        {
+            typename field<I>::type *dst = column_data<I>() + len;
+            SimpleSTL::uninitialized_fill_n(dst, n, std::get<I>(x));
+            try {
+                uninitialized_fill_columns(x, n, std::integral_constant<size_t, I + 1>());
+            }
+            catch(...) {
+                SimpleSTL::destroy(dst, dst + n);
+                throw;
+            }
+        }
+        void uninitialized_fill_columns(const value_type &, size_type, columns_end) {}
+
+        // 在 len 上以 args 的第 I 个引数构造第 I 个字段
+        template <class Args, size_t I>
+        void emplace_columns(Args &args, std::integral_constant<size_t, I>)
+        {
+            typedef typename field<I>::type T;
+            T *dst = column_data<I>() + len;
+            new ((void *)dst) T(std::forward<typename std::tuple_element<I, Args>::type>(std::get<I>(args)));
+            try {
+                emplace_columns(args, std::integral_constant<size_t, I + 1>());
+            }
+            catch(...) {
+                SimpleSTL::destroy(dst);
+                throw;
+            }
+        }
+        template <class Args>
+        void emplace_columns(Args &, columns_end) {}
+
+        // 把每个字段的 [0, len) 复制到容纳 n 个元素的新空间，全部成功后才释放旧空间
+        template <size_t I>
+        void relocate_columns(column_pointers &to, size_type n, std::integral_constant<size_t, I>)
+        {
+            typedef simple_alloc<typename field<I>::type, Alloc> column_allocator;
+            typename field<I>::type *p = column_allocator::allocate(n);
+            try {
+                SimpleSTL::uninitialized_copy(column_data<I>(), column_data<I>() + len, p);
+            }
+            catch(...) {
+                column_allocator::deallocate(p, n);
+                throw;
+            }
+            try {
+                relocate_columns(to, n, std::integral_constant<size_t, I + 1>());
+            }
+            catch(...) {
+                SimpleSTL::destroy(p, p + len);
+                column_allocator::deallocate(p, n);
+                throw;
+            }
+            std::get<I>(to) = p;
+        }
+        void relocate_columns(column_pointers &, size_type, columns_end) {}
+
+        template <size_t... Is>
+        void destroy_rows(size_type first, size_type last, __soa_indices<Is...>)
+        {
+            int expand[] = {0, (SimpleSTL::destroy(std::get<Is>(cols) + first, std::get<Is>(cols) + last), 0)...};
+            (void)expand;
+        }
+
+        template <size_t... Is>
+        void deallocate(__soa_indices<Is...>)
+        {
+            int expand[] = {0, (simple_alloc<Fields, Alloc>::deallocate(std::get<Is>(cols), cap), 0)...};
+            (void)expand;
+        }
+
+        // 把 [last, len) 往前搬到 first 起的位置
+        template <size_t... Is>
+        void move_rows_down(size_type first, size_type last, __soa_indices<Is...>)
+        {
+            int expand[] = {0, (SimpleSTL::copy(std::get<Is>(cols) + last, std::get<Is>(cols) + len,
+                                                std::get<Is>(cols) + first), 0)...};
+            (void)expand;
+        }
+
+        void reallocate(size_type n)
+        {
+            column_pointers tmp;
+            relocate_columns(tmp, n, std::integral_constant<size_t, 0>());
+            destroy_rows(0, len, indices());
+            deallocate(indices());
+            cols = tmp;
+            cap = n;
+        }
+
+        // 确保还能再放入 n 笔资料
+        void make_room(size_type n)
+        {
+            if (len + n > cap)
+                reallocate(growth_double::next(cap, len + n));
+        }
+
+    public:
+        basic_soa_vector() : cols(), len(0), cap(0) {}
+        explicit basic_soa_vector(size_type n) : cols(), len(0), cap(0) { resize(n); }
+        basic_soa_vector(size_type n, const value_type &x) : cols(), len(0), cap(0) { resize(n, x); }
+        basic_soa_vector(const basic_soa_vector &x) : cols(), len(0), cap(0) { append(x); }
+
+        basic_soa_vector &operator=(const basic_soa_vector &x)
+        {
+            if (this != &x) {
+                basic_soa_vector tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        ~basic_soa_vector()
+        {
+            destroy_rows(0, len, indices());
+            deallocate(indices());
+        }
+
+        iterator begin() { return iterator(&cols, 0); }
+        iterator end() { return iterator(&cols, len); }
+        const_iterator begin() const { return const_iterator(&cols, 0); }
+        const_iterator end() const { return const_iterator(&cols, len); }
+
+        size_type size() const { return len; }
+        size_type capacity() const { return cap; }
+        bool empty() const { return len == 0; }
+
+        reference operator[](size_type i) { return reference(&cols, i); }
+        const_reference operator[](size_type i) const { return const_reference(&cols, i); }
+        reference front() { return (*this)[0]; }
+        reference back() { return (*this)[len - 1]; }
+
+        // 第 i 笔资料的第 I 个字段
+        template <size_t I>
+        typename field<I>::type &get(size_type i) { return column_data<I>()[i]; }
+        template <size_t I>
+        const typename field<I>::type &get(size_type i) const { return column_data<I>()[i]; }
+
+        // 第 I 个字段的全部元素，在下一次扩充之前有效
+        template <size_t I>
+        column_span<typename field<I>::type> column()
+        {
+            return column_span<typename field<I>::type>(column_data<I>(), len);
+        }
+        template <size_t I>
+        column_span<const typename field<I>::type> column() const
+        {
+            return column_span<const typename field<I>::type>(column_data<I>(), len);
+        }
+
+        void reserve(size_type n)
+        {
+            if (n > cap)
+                reallocate(n);
+        }
+
+        void push_back(const value_type &x)
+        {
+            make_room(1);
+            uninitialized_fill_columns(x, 1, std::integral_constant<size_t, 0>());
+            ++len;
+        }
+
+        void push_back(const Fields &... fields)
+        {
+            emplace_back(fields...);
+        }
+
+        // 每个字段各取一个引数就地构造：emplace_back(a0, a1, ...) 以 a0 构造第 0 个字段，依此类推
+        template <class... Args>
+        void emplace_back(Args &&... args)
+        {
+            static_assert(sizeof...(Args) == sizeof...(Fields), "emplace_back takes one argument per field");
+            if (len == cap) {
+                // 引数可能就是本容器的元素，扩充时旧的字段即被释放，所以先复制一份
+                value_type x(std::forward<Args>(args)...);
+                make_room(1);
+                uninitialized_fill_columns(x, 1, std::integral_constant<size_t, 0>());
+            }
+            else {
+                std::tuple<Args &&...> refs(std::forward<Args>(args)...);
+                emplace_columns(refs, std::integral_constant<size_t, 0>());
+            }
+            ++len;
+        }
+
+        void pop_back()
+        {
+            --len;
+            destroy_rows(len, len + 1, indices());
+        }
+
+        // 把 x 的所有资料接在尾端，每个字段整段复制
+        void append(const basic_soa_vector &x)
+        {
+            if (&x == this && len + x.len > cap) {  // 扩充会释放 x 的字段
+                basic_soa_vector tmp(x);
+                append(tmp);
+                return;
+            }
+            const size_type n = x.len;
+            make_room(n);
+            uninitialized_copy_columns(x.cols, n, std::integral_constant<size_t, 0>());
+            len += n;
+        }
+
+        iterator erase(iterator first, iterator last)
+        {
+            if (first != last) {
+                move_rows_down(first.i, last.i, indices());
+                const size_type new_len = len - (last.i - first.i);
+                destroy_rows(new_len, len, indices());
+                len = new_len;
+            }
+            return first;
+        }
+
+        iterator erase(iterator position) { return erase(position, position + 1); }
+
+        void resize(size_type n, const value_type &x)
+        {
+            if (n < len) {
+                destroy_rows(n, len, indices());
+                len = n;
+            }
+            else if (n > len) {
+                make_room(n - len);
+                uninitialized_fill_columns(x, n - len, std::integral_constant<size_t, 0>());
+                len = n;
+            }
+        }
+
+        void resize(size_type n) { resize(n, value_type()); }
+
+        void clear()
+        {
+            destroy_rows(0, len, indices());
+            len = 0;
+        }
+
+        void swap(basic_soa_vector &x)
+        {
+            std::swap(cols, x.cols);
+            std::swap(len, x.len);
+            std::swap(cap, x.cap);
+        }
+
+        /**************************** 字段的整批操作 ****************************/
+        // 第 I 个字段全部设为 x
+        template <size_t I>
+        void fill(const typename field<I>::type &x)
+        {
+            SimpleSTL::fill(column_data<I>(), column_data<I>() + len, x);
+        }
+
+        // 第 I 个字段的每个元素 e 都换成 op(e)
+        template <size_t I, class UnaryOperation>
+        void transform(UnaryOperation op)
+        {
+            typename field<I>::type *p = column_data<I>();
+            for (size_type i = 0; i < len; ++i)
+                p[i] = op(p[i]);
+        }
+
+        // 第 I 个字段的总和，以 init 为初值
+        template <size_t I, class T>
+        T accumulate(T init) const
+        {
+            const typename field<I>::type *p = column_data<I>();
+            for (size_type i = 0; i < len; ++i)
+                init = init + p[i];
+            return init;
+        }
+
+        template <size_t I, class T, class BinaryOperation>
+        T accumulate(T init, BinaryOperation op) const
+        {
+            const typename field<I>::type *p = column_data<I>();
+            for (size_type i = 0; i < len; ++i)
+                init = op(init, p[i]);
+            return init;
+        }
+    };
+
+    template <class Alloc, class... Fields>
+    const size_t basic_soa_vector<Alloc, Fields...>::columns;
+
+    template <class... Fields>
+    using soa_vector = basic_soa_vector<alloc2, Fields...>;
+
+    // 只持有指向各字段空间的指针，可以逐位元搬移
+    template <class Alloc, class... Fields>
+    struct _is_trivially_relocatable<basic_soa_vector<Alloc, Fields...> > { typedef _true_type type; };
+}
+
+#endif
@@ -13,7 +13,11 @@
 #ifndef __SIMPLE_STL_INTERNAL_ALLOC_H
 #define __SIMPLE_STL_INTERNAL_ALLOC_H
 
+#include <atomic>
 #include <malloc.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <cstring>
 #include <exception>
 #include <new> 
 
@@ -112,10 +116,13 @@ namespace SimpleSTL
         {
             __ALIGN = 8
         };
+    public:
+        // 大于 __MAX_BYTES 的区块交给第一级配置器，vector 据此判断 reallocate 能否由 realloc 就地延伸
         enum
         {
             __MAX_BYTES = 128
         };
+    private:
         enum
         {
             __NFREELISTS = 16
@@ -208,10 +215,17 @@ namespace SimpleSTL
             free_list[index] = node;    // 相当于将一个节点插入至链表头部以前
         }
 
+        // 新旧区块都大于 128 bytes 时交给第一级配置器的 realloc：能就地延伸就不必搬移，
+        // glibc 对以 mmap 配置的大区块会以 mremap 重新映射，也不复制内容
         static void* reallocate(void *ptr, size_t old_sz, size_t new_sz) {
+            if (old_sz > (size_t)__MAX_BYTES && new_sz > (size_t)__MAX_BYTES)
+                return alloc1::reallocate(ptr, old_sz, new_sz);
+            if (ROUND_UP(old_sz) == ROUND_UP(new_sz))
+                return ptr;
+            void *result = allocate(new_sz);
+            memcpy(result, ptr, old_sz < new_sz ? old_sz : new_sz);
             deallocate(ptr, old_sz);
-            ptr = allocate(new_sz);
-            return ptr;
+            return result;
         }
     };
 
@@ -347,6 +361,181 @@ namespace SimpleSTL
             return (chunk_alloc(size, nobjs));
         }
     }
+
+    /************************ 以下为对齐配置器的实现 ************************/
+    // 大分页的大小（x86-64 与 aarch64 的 2 MB 分页）
+    const size_t huge_page_size = 2 * 1024 * 1024;
+
+    // 配置器的统计数字（某一时刻的快照）
+    struct alloc_stats
+    {
+        size_t alignment;       // 区块对齐的 bytes
+        size_t aligned_allocs;  // 经由 malloc / posix_memalign 配置的次数
+        size_t aligned_bytes;   // 目前经由 malloc / posix_memalign 配置的 bytes
+        size_t huge_allocs;     // 经由 mmap 配置的次数
+        size_t hugetlb_allocs;  // 其中取得 2 MB 分页（MAP_HUGETLB）的次数
+        size_t huge_remaps;     // 以 mremap 扩充而不复制的次数
+        size_t huge_bytes;      // 目前经由 mmap 配置的 bytes
+    };
+
+    // 每个区块都对齐到 Align bytes（例如 64，供 AVX 对齐载入），小区块不经过记忆池，直接向 malloc / posix_memalign 索取。
+    // HugeThreshold 不为 0 时，不小于它的区块改以 mmap 配置，并对齐到 2 MB 的边界：
+    // 先尝试 MAP_HUGETLB 的 2 MB 分页（须事先预留），取不到就用一般分页并以 MADV_HUGEPAGE 请核心改用透明大分页，减少 TLB miss。
+    // 释放时依区块大小判断当初的配置方式，所以 deallocate、reallocate 必须传入配置时的大小（SGI 配置器原本就如此）。
+    // 不同于 alloc2，本配置器可以在多个执行绪中同时使用：空间来自 malloc 与 mmap，统计数字都是 atomic 的
+    template <size_t Align, size_t HugeThreshold = 0>
+    class align_alloc
+    {
+        static_assert((Align & (Align - 1)) == 0 && Align != 0, "Align must be a power of two");
+
+    private:
+        enum
+        {
+            __MALLOC_ALIGN = 16     // malloc 传回的区块本来就对齐到 16 bytes
+        };
+
+        struct atomic_stats
+        {
+            std::atomic<size_t> aligned_allocs, aligned_bytes;
+            std::atomic<size_t> huge_allocs, hugetlb_allocs, huge_remaps, huge_bytes;
+        };
+        static atomic_stats __stats;
+        static std::atomic<bool> __hugetlb_unavailable;  // MAP_HUGETLB 失败过一次就不再尝试
+
+        static bool is_huge(size_t n) { return HugeThreshold != 0 && n >= HugeThreshold; }
+        static size_t huge_round_up(size_t n)
+        {
+            return (n + huge_page_size - 1) & ~(huge_page_size - 1);
+        }
+        static void *aligned_malloc(size_t n);
+        static void *huge_map(size_t n);
+
+    public:
+        static void *allocate(size_t n)
+        {
+            return is_huge(n) ? huge_map(n) : aligned_malloc(n);
+        }
+
+        static void deallocate(void *p, size_t n)
+        {
+            if (is_huge(n))
+            {
+                munmap(p, huge_round_up(n));
+                __stats.huge_bytes -= huge_round_up(n);
+            }
+            else
+            {
+                free(p);
+                __stats.aligned_bytes -= n;
+            }
+        }
+
+        static void *reallocate(void *p, size_t old_sz, size_t new_sz);
+
+        static alloc_stats stats()
+        {
+            alloc_stats s = {Align, __stats.aligned_allocs, __stats.aligned_bytes, __stats.huge_allocs,
+                             __stats.hugetlb_allocs, __stats.huge_remaps, __stats.huge_bytes};
+            return s;
+        }
+    };
+
+    template <size_t Align, size_t HugeThreshold>
+    typename align_alloc<Align, HugeThreshold>::atomic_stats align_alloc<Align, HugeThreshold>::__stats;
+
+    template <size_t Align, size_t HugeThreshold>
+    std::atomic<bool> align_alloc<Align, HugeThreshold>::__hugetlb_unavailable(false);
+
+    template <size_t Align, size_t HugeThreshold>
+    void *align_alloc<Align, HugeThreshold>::aligned_malloc(size_t n)
+    {
+        void *result = 0;
+        if (Align <= (size_t)__MALLOC_ALIGN)
+            result = malloc(n);
+        else if (posix_memalign(&result, Align, n) != 0)
+            result = 0;
+        if (0 == result)
+            throw std::bad_alloc();
+        ++__stats.aligned_allocs;
+        __stats.aligned_bytes += n;
+        return result;
+    }
+
+    template <size_t Align, size_t HugeThreshold>
+    void *align_alloc<Align, HugeThreshold>::huge_map(size_t n)
+    {
+        const size_t len = huge_round_up(n);
+        ++__stats.huge_allocs;
+        __stats.huge_bytes += len;
+#ifdef MAP_HUGETLB
+        if (!__hugetlb_unavailable)
+        {
+            void *p = mmap(0, len, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED)
+            {
+                ++__stats.hugetlb_allocs;
+                return p;
+            }
+            __hugetlb_unavailable = true;
+        }
+#endif
+        // 多映射 2 MB，再把头尾多出来的部分还给核心，剩下的区域就从 2 MB 的边界开始
+        char *raw = (char *)mmap(0, len + huge_page_size, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == (char *)MAP_FAILED)
+        {
+            --__stats.huge_allocs;
+            __stats.huge_bytes -= len;
+            throw std::bad_alloc();
+        }
+        char *p = (char *)(((size_t)raw + huge_page_size - 1) & ~(huge_page_size - 1));
+        if (p != raw)
+            munmap(raw, p - raw);
+        munmap(p + len, raw + huge_page_size - p);
+#ifdef MADV_HUGEPAGE
+        madvise(p, len, MADV_HUGEPAGE);
+#endif
+        return p;
+    }
+
+    // 新旧区块都是 mmap 配置的就以 mremap 就地延伸或缩短，不复制内容。不允许 mremap 搬移映射：
+    // 搬移后的位址只对齐到 4 KB，失去 2 MB 的对齐。无法就地延伸时（后面的位址已被占用）才配置新区块并复制。
+    // 都是小区块且不需额外对齐时交给 realloc；其余情况配置新区块并复制
+    template <size_t Align, size_t HugeThreshold>
+    void *align_alloc<Align, HugeThreshold>::reallocate(void *p, size_t old_sz, size_t new_sz)
+    {
+        if (is_huge(old_sz) && is_huge(new_sz))
+        {
+            const size_t old_len = huge_round_up(old_sz), new_len = huge_round_up(new_sz);
+            if (old_len == new_len)
+                return p;
+#ifdef MREMAP_MAYMOVE
+            if (mremap(p, old_len, new_len, 0) != MAP_FAILED)
+            {
+#ifdef MADV_HUGEPAGE
+                if (new_len > old_len)  // 延伸出来的部分也要使用透明大分页
+                    madvise((char *)p + old_len, new_len - old_len, MADV_HUGEPAGE);
+#endif
+                ++__stats.huge_remaps;
+                __stats.huge_bytes += new_len - old_len;
+                return p;
+            }
+#endif
+        }
+        else if (!is_huge(old_sz) && !is_huge(new_sz) && Align <= (size_t)__MALLOC_ALIGN)
+        {
+            void *result = realloc(p, new_sz);
+            if (0 == result)
+                throw std::bad_alloc();
+            __stats.aligned_bytes += new_sz - old_sz;
+            return result;
+        }
+        void *result = allocate(new_sz);
+        memcpy(result, p, old_sz < new_sz ? old_sz : new_sz);
+        deallocate(p, old_sz);
+        return result;
+    }
 }
 
 #endif
\ No newline at end of file
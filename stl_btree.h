@@ -0,0 +1,826 @@
+/***
+* B-tree：btree_set / btree_map / btree_multimap 的底层机制。
+* 与 RB-tree 每个节点只放一个元素不同，B-tree 的节点很“宽”，一个节点内连续存放多个元素，
+* 一次查找只需访问 O(log_B n) 个节点，cache miss 远少于 RB-tree，每个元素的额外开销也小得多。
+* 接口与 rb_tree 保持一致，因此 btree_set/btree_map 可以像 set/map 一样使用。
+* 注意：插入和删除可能搬移节点内的元素，因此任何修改操作都会使迭代器失效。
+*/
+#ifndef _SIMPLE_STL_BTREE_H_
+#define _SIMPLE_STL_BTREE_H_
+
+#include "./stl_iterator.h"
+#include "./memory.h"
+#include <cstddef>
+#include <utility>
+
+namespace SimpleSTL
+{
+    // 叶节点：只有元素，没有子节点指针
+    template <class Value, size_t Slots>
+    struct __btree_node
+    {
+        typedef __btree_node<Value, Slots> *node_ptr;
+
+        node_ptr parent;            // 根节点的 parent 为 0
+        unsigned short position;    // 本节点是父节点的第几个子节点
+        unsigned short count;       // 目前存放的元素个数
+        bool leaf;
+        // 元素紧凑地连续存放，只在 [0, count) 范围内构造
+        alignas(Value) unsigned char storage[sizeof(Value) * Slots];
+
+        Value *values() { return reinterpret_cast<Value *>(storage); }
+        Value &value(size_t i) { return values()[i]; }
+        node_ptr &child(size_t i);
+    };
+
+    // 内部节点：在叶节点之后追加 Slots + 1 个子节点指针
+    template <class Value, size_t Slots>
+    struct __btree_internal_node : public __btree_node<Value, Slots>
+    {
+        __btree_node<Value, Slots> *children[Slots + 1];
+    };
+
+    template <class Value, size_t Slots>
+    inline typename __btree_node<Value, Slots>::node_ptr &
+    __btree_node<Value, Slots>::child(size_t i)
+    {
+        return static_cast<__btree_internal_node<Value, Slots> *>(this)->children[i];
+    }
+
+    // B-tree 迭代器：以（节点，节点内位置）表示一个元素
+    // end() 以最右叶节点的 count 位置表示
+    template <class Value, class Ref, class Ptr, size_t Slots>
+    struct __btree_iterator
+    {
+        typedef bidirectional_iterator_tag iterator_category;
+        typedef Value value_type;
+        typedef Ref reference;
+        typedef Ptr pointer;
+        typedef ptrdiff_t difference_type;
+        typedef __btree_iterator<Value, Value &, Value *, Slots> iterator;
+        typedef __btree_iterator<Value, const Value &, const Value *, Slots> const_iterator;
+        typedef __btree_iterator<Value, Ref, Ptr, Slots> self;
+        typedef __btree_node<Value, Slots> *node_ptr;
+
+        node_ptr node;
+        int position;
+
+        __btree_iterator() : node(0), position(0) {}
+        __btree_iterator(node_ptr n, int pos) : node(n), position(pos) {}
+        __btree_iterator(const iterator &it) : node(it.node), position(it.position) {}
+
+        reference operator*() const { return node->value(position); }
+        pointer operator->() const { return &(operator*()); }
+
+        void increment()
+        {
+            if (node->leaf)
+            {
+                if (++position < node->count)
+                    return;
+                // 叶节点走完，上溯到第一个 “还有下一个元素” 的祖先
+                self save = *this;
+                while (position == node->count && node->parent != 0)
+                {
+                    position = node->position;
+                    node = node->parent;
+                }
+                if (position == node->count)
+                    *this = save;   // 已越过最大元素，即 end()
+            }
+            else
+            {
+                // 内部节点的下一个元素，是右侧子树的最小元素
+                node = node->child(position + 1);
+                while (!node->leaf)
+                    node = node->child(0);
+                position = 0;
+            }
+        }
+
+        void decrement()
+        {
+            if (node->leaf)
+            {
+                if (--position >= 0)
+                    return;
+                self save = *this;
+                while (position < 0 && node->parent != 0)
+                {
+                    position = node->position - 1;
+                    node = node->parent;
+                }
+                if (position < 0)
+                    *this = save;   // 已越过最小元素，begin() 之前无定义
+            }
+            else
+            {
+                // 内部节点的前一个元素，是左侧子树的最大元素
+                node = node->child(position);
+                while (!node->leaf)
+                    node = node->child(node->count);
+                position = node->count - 1;
+            }
+        }
+
+        self &operator++()
+        {
+            increment();
+            return *this;
+        }
+        self operator++(int)
+        {
+            self tmp = *this;
+            increment();
+            return tmp;
+        }
+        self &operator--()
+        {
+            decrement();
+            return *this;
+        }
+        self operator--(int)
+        {
+            self tmp = *this;
+            decrement();
+            return tmp;
+        }
+
+        bool operator==(const self &x) const { return node == x.node && position == x.position; }
+        bool operator!=(const self &x) const { return !(*this == x); }
+    };
+
+    template <class Key, class Value, class KeyOfValue, class Compare,
+              class Alloc = alloc2, size_t NodeSlots = 0>
+    class btree
+    {
+    public:
+        typedef Key key_type;
+        typedef Value value_type;
+        typedef value_type *pointer;
+        typedef const value_type *const_pointer;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        // 每个节点可容纳的元素个数（fan-out）。NodeSlots 不为 0 时由用户指定；
+        // 为 0 时使用默认值，让元素区大约占 240 bytes（连同节点头约 256 bytes）。
+        // 每个节点至少容纳 3 个元素，否则分裂与合并无法进行
+        enum { node_slots = NodeSlots != 0 ? (NodeSlots < 3 ? 3 : NodeSlots)
+                          : (sizeof(Value) * 3 < 240 ? 240 / sizeof(Value) : 3) };
+
+    protected:
+        typedef __btree_node<Value, node_slots> node_type;
+        typedef __btree_internal_node<Value, node_slots> internal_node_type;
+        typedef node_type *node_ptr;
+        typedef simple_alloc<node_type, Alloc> leaf_allocator;
+        typedef simple_alloc<internal_node_type, Alloc> internal_allocator;
+
+    public:
+        typedef __btree_iterator<value_type, reference, pointer, node_slots> iterator;
+        typedef __btree_iterator<value_type, const_reference, const_pointer, node_slots> const_iterator;
+
+    protected:
+        // B-tree 以四笔数据表现
+        node_ptr root;
+        node_ptr leftmost;      // 最左叶节点，begin() 由此取得
+        node_ptr rightmost;     // 最右叶节点，end() 由此取得
+        size_type node_count;   // 元素个数（沿用 rb_tree 的命名）
+        Compare key_compare;
+
+        static const Key &key(node_ptr x, size_t i) { return KeyOfValue()(x->value(i)); }
+
+        node_ptr new_leaf(node_ptr parent)
+        {
+            node_ptr x = leaf_allocator::allocate();
+            x->parent = parent;
+            x->position = 0;
+            x->count = 0;
+            x->leaf = true;
+            return x;
+        }
+
+        node_ptr new_internal(node_ptr parent)
+        {
+            node_ptr x = internal_allocator::allocate();
+            x->parent = parent;
+            x->position = 0;
+            x->count = 0;
+            x->leaf = false;
+            return x;
+        }
+
+        void delete_node(node_ptr x)
+        {
+            for (size_t i = 0; i < x->count; ++i)
+                SimpleSTL::destroy(&x->value(i));
+            if (x->leaf)
+                leaf_allocator::deallocate(x);
+            else
+                internal_allocator::deallocate(static_cast<internal_node_type *>(x));
+        }
+
+        // 把 *src 搬到未初始化的 dst 处，src 处随后视为未初始化
+        static void relocate(value_type *dst, value_type *src)
+        {
+            new ((void *)dst) value_type(std::move(*src));
+            SimpleSTL::destroy(src);
+        }
+
+        static void set_child(node_ptr x, size_t i, node_ptr c)
+        {
+            x->child(i) = c;
+            c->parent = x;
+            c->position = (unsigned short)i;
+        }
+
+        // 节点内二分查找：第一个 “不小于 k” 的位置
+        size_t node_lower_bound(node_ptr x, const Key &k) const
+        {
+            size_t lo = 0, hi = x->count;
+            while (lo < hi)
+            {
+                size_t mid = (lo + hi) >> 1;
+                if (key_compare(key(x, mid), k))
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            return lo;
+        }
+
+        // 节点内二分查找：第一个 “大于 k” 的位置
+        size_t node_upper_bound(node_ptr x, const Key &k) const
+        {
+            size_t lo = 0, hi = x->count;
+            while (lo < hi)
+            {
+                size_t mid = (lo + hi) >> 1;
+                if (key_compare(k, key(x, mid)))
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            return lo;
+        }
+
+        void init()
+        {
+            root = leftmost = rightmost = 0;
+            node_count = 0;
+        }
+
+        node_ptr copy_subtree(node_ptr x, node_ptr parent);
+        void destroy_subtree(node_ptr x);
+        void make_room(node_ptr &x, int &pos);
+        iterator insert_at_leaf(node_ptr x, int pos, const value_type &v);
+        iterator erase_and_next(iterator position);
+        void rebalance_after_erase(iterator &it);
+        void merge_right_into(node_ptr left);
+        // 把指向叶节点尾部（position == count）的迭代器规整为其真正指向的元素
+        static iterator normalize(iterator it)
+        {
+            iterator save = it;
+            while (it.position == it.node->count && it.node->parent != 0)
+            {
+                it.position = it.node->position;
+                it.node = it.node->parent;
+            }
+            return it.position == it.node->count ? save : it;
+        }
+
+    public:
+        btree(const Compare &comp = Compare()) : key_compare(comp) { init(); }
+        btree(const btree &x) : key_compare(x.key_compare)
+        {
+            init();
+            if (x.root != 0)
+            {
+                root = copy_subtree(x.root, 0);
+                node_count = x.node_count;
+            }
+        }
+        ~btree() { clear(); }
+        btree &operator=(const btree &x)
+        {
+            if (this != &x)
+            {
+                btree tmp(x);   // 复制失败时 *this 保持原状
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        Compare key_comp() const { return key_compare; }
+        iterator begin() const { return iterator(leftmost, 0); }
+        iterator end() const { return iterator(rightmost, rightmost == 0 ? 0 : rightmost->count); }
+        bool empty() const { return node_count == 0; }
+        size_type size() const { return node_count; }
+        size_type max_size() const { return size_type(-1); }
+        void swap(btree &t)
+        {
+            std::swap(root, t.root);
+            std::swap(leftmost, t.leftmost);
+            std::swap(rightmost, t.rightmost);
+            std::swap(node_count, t.node_count);
+            std::swap(key_compare, t.key_compare);
+        }
+
+        void clear()
+        {
+            if (root != 0)
+                destroy_subtree(root);
+            init();
+        }
+
+        // 树高与节点数，便于观察 fan-out 的效果
+        size_type height() const
+        {
+            size_type h = 0;
+            for (node_ptr x = root; x != 0; x = x->leaf ? 0 : x->child(0))
+                ++h;
+            return h;
+        }
+
+    public:
+        iterator insert_equal(const value_type &v);
+        std::pair<iterator, bool> insert_unique(const value_type &v);
+        iterator insert_unique(iterator position, const value_type &v);
+        template <class InputIterator>
+        void insert_unique(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first)
+                insert_unique(end(), *first);
+        }
+        template <class InputIterator>
+        void insert_equal(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first)
+                insert_equal(*first);
+        }
+
+        void erase(iterator position) { erase_and_next(position); }
+        size_type erase(const key_type &x);
+        void erase(iterator first, iterator last);
+
+        iterator find(const key_type &k) const;
+        size_type count(const key_type &k) const;
+        iterator lower_bound(const key_type &k) const;
+        iterator upper_bound(const key_type &k) const;
+        std::pair<iterator, iterator> equal_range(const key_type &k) const
+        {
+            return std::pair<iterator, iterator>(lower_bound(k), upper_bound(k));
+        }
+    };
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::node_ptr
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::copy_subtree(node_ptr x, node_ptr parent)
+    {
+        node_ptr y = x->leaf ? new_leaf(parent) : new_internal(parent);
+        y->position = x->position;
+        try {
+            SimpleSTL::uninitialized_copy(x->values(), x->values() + x->count, y->values());
+        }
+        catch (...) {
+            delete_node(y);     // count 仍为 0，只释放节点
+            throw;
+        }
+        y->count = x->count;
+        if (x->leaf)
+        {
+            if (leftmost == 0)
+                leftmost = y;   // 以中序（由左至右）复制，第一个叶节点即最左
+            rightmost = y;
+        }
+        else
+        {
+            size_t i = 0;
+            try {
+                for (; i <= x->count; ++i)
+                    y->child(i) = copy_subtree(x->child(i), y);
+            }
+            catch (...) {
+                // 释放已复制的子树与本节点；leftmost、rightmost 由呼叫端舍弃
+                while (i > 0)
+                    destroy_subtree(y->child(--i));
+                delete_node(y);
+                throw;
+            }
+        }
+        return y;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    void btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::destroy_subtree(node_ptr x)
+    {
+        // 树高只有 O(log_B n)，递归深度很浅
+        if (!x->leaf)
+            for (size_t i = 0; i <= x->count; ++i)
+                destroy_subtree(x->child(i));
+        delete_node(x);
+    }
+
+    // 保证节点 x 能在 pos 处再放入一个元素：若 x 已满就把它分裂成两个节点，
+    // 中间元素上移到父节点（父节点若也满了则先递归分裂）。
+    // 返回时 (x, pos) 为新元素真正应该放入的位置。
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    void btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::make_room(node_ptr &x, int &pos)
+    {
+        if (x->count < (size_t)node_slots)
+            return;
+
+        node_ptr parent = x->parent;
+        int ppos = x->position;
+        if (parent == 0)
+        {
+            // 根节点分裂：树长高一层
+            parent = new_internal(0);
+            set_child(parent, 0, x);
+            root = parent;
+        }
+        else
+        {
+            make_room(parent, ppos);  // 父节点分裂后，x 可能被移到父节点的新兄弟之下
+        }
+
+        // 决定留在左侧的元素个数。顺序（或逆序）插入时把节点尽量填满，否则对半分
+        int max = node_slots;
+        int left_count = pos == max ? max - 1 : (pos == 0 ? 0 : max / 2);
+
+        node_ptr sibling = x->leaf ? new_leaf(parent) : new_internal(parent);
+        for (int i = left_count + 1; i < max; ++i)
+            relocate(&sibling->value(i - left_count - 1), &x->value(i));
+        sibling->count = (unsigned short)(max - left_count - 1);
+        if (!x->leaf)
+            for (int i = left_count + 1; i <= max; ++i)
+                set_child(sibling, i - left_count - 1, x->child(i));
+
+        // 中间元素与新兄弟节点放入父节点的 ppos 处
+        for (int i = parent->count; i > ppos; --i)
+            relocate(&parent->value(i), &parent->value(i - 1));
+        for (int i = parent->count + 1; i > ppos + 1; --i)
+            set_child(parent, i, parent->child(i - 1));
+        relocate(&parent->value(ppos), &x->value(left_count));
+        set_child(parent, ppos + 1, sibling);
+        ++parent->count;
+        x->count = (unsigned short)left_count;
+
+        if (x == rightmost)
+            rightmost = sibling;
+
+        if (pos > left_count)
+        {
+            x = sibling;
+            pos -= left_count + 1;
+        }
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::insert_at_leaf(node_ptr x, int pos, const value_type &v)
+    {
+        if (x == 0)
+        {
+            // 空树：产生第一个叶节点
+            x = root = leftmost = rightmost = new_leaf(0);
+            pos = 0;
+        }
+        make_room(x, pos);
+        for (int i = x->count; i > pos; --i)
+            relocate(&x->value(i), &x->value(i - 1));
+        try {
+            construct(&x->value(pos), v);
+        }
+        catch (...) {
+            // 构造失败，把元素搬回原位（分裂出的节点仍是合法的 B-tree）
+            for (int i = pos; i < x->count; ++i)
+                relocate(&x->value(i), &x->value(i + 1));
+            throw;
+        }
+        ++x->count;
+        ++node_count;
+        return iterator(x, pos);
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::insert_equal(const value_type &v)
+    {
+        node_ptr x = root;
+        size_t pos = 0;
+        while (x != 0)
+        {
+            pos = node_upper_bound(x, KeyOfValue()(v));
+            if (x->leaf)
+                break;
+            x = x->child(pos);
+        }
+        return insert_at_leaf(x, (int)pos, v);
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    std::pair<typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator, bool>
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::insert_unique(const value_type &v)
+    {
+        node_ptr x = root;
+        size_t pos = 0;
+        while (x != 0)
+        {
+            pos = node_lower_bound(x, KeyOfValue()(v));
+            if (pos < x->count && !key_compare(KeyOfValue()(v), key(x, pos)))
+                return std::pair<iterator, bool>(iterator(x, (int)pos), false);   // 键值重复
+            if (x->leaf)
+                break;
+            x = x->child(pos);
+        }
+        return std::pair<iterator, bool>(insert_at_leaf(x, (int)pos, v), true);
+    }
+
+    // position 为提示：若 v 恰好应放在 position 之前，就省去自根而下的查找
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::insert_unique(iterator position, const value_type &v)
+    {
+        const Key &k = KeyOfValue()(v);
+        if (root == 0)
+            return insert_at_leaf(0, 0, v);
+        if (position == end() || key_compare(k, KeyOfValue()(*position)))
+        {
+            if (position == begin())
+                return insert_at_leaf(leftmost, 0, v);
+            iterator before = position;
+            --before;
+            if (key_compare(KeyOfValue()(*before), k))
+            {
+                // 新元素必须落在叶节点：position 在叶节点就放在它的位置，否则放在 before（必在叶节点）之后
+                if (position.node->leaf)
+                    return insert_at_leaf(position.node, position.position, v);
+                return insert_at_leaf(before.node, before.position + 1, v);
+            }
+        }
+        return insert_unique(v).first;
+    }
+
+    // 删除 position 所指元素，传回指向其后继元素的迭代器
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::erase_and_next(iterator it)
+    {
+        bool internal_delete = !it.node->leaf;
+        if (internal_delete)
+        {
+            // 内部节点上的元素，以其前驱（必在叶节点的尾部）顶替，转为删除叶节点上的元素
+            iterator pred = it;
+            --pred;
+            SimpleSTL::destroy(&it.node->value(it.position));
+            relocate(&it.node->value(it.position), &pred.node->value(pred.position));
+            it = pred;
+        }
+        else
+        {
+            SimpleSTL::destroy(&it.node->value(it.position));
+        }
+
+        node_ptr x = it.node;
+        for (int i = it.position + 1; i < x->count; ++i)
+            relocate(&x->value(i - 1), &x->value(i));
+        --x->count;
+        --node_count;
+
+        rebalance_after_erase(it);
+        if (root == 0)
+            return end();
+        it = normalize(it);
+        if (internal_delete)
+            ++it;   // it 此刻指向顶替上去的前驱，其下一个才是被删元素的后继
+        return it;
+    }
+
+    // 把 left 的右兄弟（连同父节点中的分隔元素）并入 left，然后释放右兄弟
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    void btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::merge_right_into(node_ptr left)
+    {
+        node_ptr parent = left->parent;
+        int p = left->position;
+        node_ptr right = parent->child(p + 1);
+
+        relocate(&left->value(left->count), &parent->value(p));
+        for (int i = 0; i < right->count; ++i)
+            relocate(&left->value(left->count + 1 + i), &right->value(i));
+        if (!left->leaf)
+            for (int i = 0; i <= right->count; ++i)
+                set_child(left, left->count + 1 + i, right->child(i));
+        left->count = (unsigned short)(left->count + 1 + right->count);
+
+        for (int i = p + 1; i < parent->count; ++i)
+            relocate(&parent->value(i - 1), &parent->value(i));
+        for (int i = p + 2; i <= parent->count; ++i)
+            set_child(parent, i - 1, parent->child(i));
+        --parent->count;
+
+        if (right == rightmost)
+            rightmost = left;
+        right->count = 0;       // 元素已全部搬走
+        delete_node(right);
+    }
+
+    // 删除后若节点元素过少，向兄弟借一个元素或与兄弟合并，必要时一路向上处理。
+    // it 指向被删元素在叶节点中的位置，随元素的搬移同步调整，使其仍指向同一后继
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    void btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::rebalance_after_erase(iterator &it)
+    {
+        const int min_count = (node_slots - 1) / 2;
+        node_ptr x = it.node;
+        for (;;)
+        {
+            if (x == root)
+            {
+                if (x->count == 0)
+                {
+                    if (x->leaf)
+                    {
+                        delete_node(x);
+                        init();
+                    }
+                    else
+                    {
+                        // 根节点已空：唯一的子节点成为新根，树高减一
+                        root = x->child(0);
+                        root->parent = 0;
+                        root->position = 0;
+                        delete_node(x);
+                    }
+                }
+                return;
+            }
+            if (x->count >= min_count)
+                return;
+
+            node_ptr parent = x->parent;
+            int p = x->position;
+            node_ptr left = p > 0 ? parent->child(p - 1) : 0;
+            node_ptr right = p < parent->count ? parent->child(p + 1) : 0;
+
+            if (left != 0 && left->count > min_count)
+            {
+                // 向左兄弟借一个：左兄弟最大元素上移，父节点分隔元素下移到 x 的最前面
+                for (int i = x->count; i > 0; --i)
+                    relocate(&x->value(i), &x->value(i - 1));
+                relocate(&x->value(0), &parent->value(p - 1));
+                relocate(&parent->value(p - 1), &left->value(left->count - 1));
+                if (!x->leaf)
+                {
+                    for (int i = x->count + 1; i > 0; --i)
+                        set_child(x, i, x->child(i - 1));
+                    set_child(x, 0, left->child(left->count));
+                }
+                --left->count;
+                ++x->count;
+                if (x == it.node)
+                    ++it.position;
+                return;
+            }
+            if (right != 0 && right->count > min_count)
+            {
+                // 向右兄弟借一个：父节点分隔元素下移到 x 的最后面，右兄弟最小元素上移
+                relocate(&x->value(x->count), &parent->value(p));
+                relocate(&parent->value(p), &right->value(0));
+                for (int i = 1; i < right->count; ++i)
+                    relocate(&right->value(i - 1), &right->value(i));
+                if (!x->leaf)
+                {
+                    set_child(x, x->count + 1, right->child(0));
+                    for (int i = 1; i <= right->count; ++i)
+                        set_child(right, i - 1, right->child(i));
+                }
+                --right->count;
+                ++x->count;
+                return;
+            }
+            if (left != 0)
+            {
+                if (x == it.node)
+                {
+                    it.node = left;
+                    it.position += left->count + 1;
+                }
+                merge_right_into(left);
+            }
+            else
+            {
+                merge_right_into(x);
+            }
+            x = parent;     // 父节点少了一个元素，继续向上检查
+        }
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::size_type
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::erase(const key_type &k)
+    {
+        std::pair<iterator, iterator> p = equal_range(k);
+        size_type n = 0;
+        distance(p.first, p.second, n);
+        iterator it = p.first;
+        for (size_type i = 0; i < n; ++i)
+            it = erase_and_next(it);
+        return n;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    void btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::erase(iterator first, iterator last)
+    {
+        if (first == begin() && last == end())
+        {
+            clear();
+            return;
+        }
+        // 删除会搬移元素，last 随之失效，所以先算出个数
+        size_type n = 0;
+        distance(first, last, n);
+        for (; n > 0; --n)
+            first = erase_and_next(first);
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::lower_bound(const key_type &k) const
+    {
+        // 自根而下，沿途最后一个 “不小于 k” 的元素即为所求
+        iterator y = end();
+        node_ptr x = root;
+        while (x != 0)
+        {
+            size_t pos = node_lower_bound(x, k);
+            if (pos < x->count)
+                y = iterator(x, (int)pos);
+            x = x->leaf ? 0 : x->child(pos);
+        }
+        return y;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::upper_bound(const key_type &k) const
+    {
+        iterator y = end();
+        node_ptr x = root;
+        while (x != 0)
+        {
+            size_t pos = node_upper_bound(x, k);
+            if (pos < x->count)
+                y = iterator(x, (int)pos);
+            x = x->leaf ? 0 : x->child(pos);
+        }
+        return y;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::find(const key_type &k) const
+    {
+        iterator j = lower_bound(k);
+        return (j == end() || key_compare(k, KeyOfValue()(*j))) ? end() : j;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::size_type
+    btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::count(const key_type &k) const
+    {
+        std::pair<iterator, iterator> p = equal_range(k);
+        size_type n = 0;
+        distance(p.first, p.second, n);
+        return n;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    inline bool operator==(const btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots> &x,
+                           const btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots> &y)
+    {
+        if (x.size() != y.size())
+            return false;
+        typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator i = x.begin(), j = y.begin();
+        for (; i != x.end(); ++i, ++j)
+            if (!(*i == *j))
+                return false;
+        return true;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc, size_t NodeSlots>
+    inline bool operator<(const btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots> &x,
+                          const btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots> &y)
+    {
+        typename btree<Key, Value, KeyOfValue, Compare, Alloc, NodeSlots>::iterator i = x.begin(), j = y.begin();
+        for (; i != x.end() && j != y.end(); ++i, ++j)
+        {
+            if (*i < *j)
+                return true;
+            if (*j < *i)
+                return false;
+        }
+        return i == x.end() && j != y.end();
+    }
+}
+#endif
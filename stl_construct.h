@@ -26,19 +26,11 @@ namespace SimpleSTL
 		pointer->~T(); // 调用dtor ~T()
 	}
 
-	// 以下是 destroy() 第二版本，接受两个迭代器。此函数设法找出元素类别
-	// 进而利用 __type_traits<> 求取最适当措施
-	template <class ForwardIterator>
-	inline void destroy(ForwardIterator first, ForwardIterator last)
-	{
-		__destroy(first, last, SimpleSTL::value_type(first));
-	}
-
 	// 判断元素的数值型别（value type）是否有 trivial destructor
 	template <class ForwardIterator, class T>
 	inline void __destroy(ForwardIterator first, ForwardIterator last, T *)
 	{
-		typedef typename _type_traits<ForwardIterator>::has_trivial_destructor Trivial_destructor;	// 根据这个来判断是否有 trivial destructor
+		typedef typename _type_traits<T>::has_trivial_destructor Trivial_destructor;	// 根据这个来判断是否有 trivial destructor
 		__destroy_aux(first, last, Trivial_destructor()); // 函数重载来选择下面的两种函数
 	}
 
@@ -54,6 +46,14 @@ namespace SimpleSTL
 	template <class ForwardIterator>
 	inline void __destroy_aux(ForwardIterator, ForwardIterator, _true_type) {}
 
+	// 以下是 destroy() 第二版本，接受两个迭代器。此函数设法找出元素类别
+	// 进而利用 __type_traits<> 求取最适当措施
+	template <class ForwardIterator>
+	inline void destroy(ForwardIterator first, ForwardIterator last)
+	{
+		__destroy(first, last, SimpleSTL::value_type(first));
+	}
+
 	// 以下是 destroy() 的特化版本
 	inline void destroy(char *, char *) {}
 	inline void destroy(int *, int *) {}
@@ -0,0 +1,219 @@
+/***
+* 以 epoch 为基础的内存回收（epoch-based reclamation），供无锁容器使用。
+* 线程存取共享结构之前以 __epoch_guard 进入临界区，宣告当时的全局 epoch；
+* 自结构中摘下的节点不立即释放，而是连同当时的全局 epoch 挂进本线程的待回收串列。
+* 只有当所有处于临界区的线程都已宣告目前的 epoch，全局 epoch 才能前进一步；
+* 于是节点在 epoch e 被摘下后，等到全局 epoch 到达 e + 2，就不可能还有线程持有它，可以释放。
+* 临界区可以嵌套。线程结束时交还自己的记录，尚未释放的节点留在记录中，由之后的线程接手。
+*/
+#ifndef _SIMPLE_STL_EPOCH_H_
+#define _SIMPLE_STL_EPOCH_H_
+
+#include <cstddef>
+#include <atomic>
+#include <new>
+
+namespace SimpleSTL
+{
+    // 待回收的对象须以此为基类：串列连结、摘下时的 epoch、以及释放自己的函数
+    struct __epoch_node
+    {
+        __epoch_node *retire_next;
+        unsigned long retire_epoch;
+        void (*reclaim)(__epoch_node *);
+    };
+
+    // 每个线程一笔记录。记录只增不减，线程结束后可由其他线程重复使用
+    struct __epoch_record
+    {
+        std::atomic<unsigned long> announce;    // 临界区内为 (epoch << 1) | 1，否则为 0
+        std::atomic<bool> in_use;
+        __epoch_record *next;
+        // 以下只由拥有这笔记录的线程存取
+        unsigned nest;
+        __epoch_node *limbo_head, *limbo_tail;  // 待回收串列，依 epoch 递增
+        size_t limbo_count;
+    };
+
+    template <class Dummy = void>
+    class __epoch_manager_t
+    {
+    public:
+        enum { reclaim_threshold = 64 };    // 每挂进这么多个节点就尝试回收一次
+
+        static __epoch_record *acquire_record()
+        {
+            for (__epoch_record *r = records.load(std::memory_order_acquire); r != 0; r = r->next)
+            {
+                bool expected = false;
+                if (!r->in_use.load(std::memory_order_relaxed) &&
+                    r->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                    return r;
+            }
+            __epoch_record *r = static_cast<__epoch_record *>(::operator new(sizeof(__epoch_record)));
+            new (&r->announce) std::atomic<unsigned long>(0);
+            new (&r->in_use) std::atomic<bool>(true);
+            r->nest = 0;
+            r->limbo_head = r->limbo_tail = 0;
+            r->limbo_count = 0;
+            r->next = records.load(std::memory_order_relaxed);
+            while (!records.compare_exchange_weak(r->next, r, std::memory_order_release))
+                ;
+            return r;
+        }
+        static void release_record(__epoch_record *r)
+        {
+            quiesce(r);
+            r->in_use.store(false, std::memory_order_release);
+        }
+
+        static void pin(__epoch_record *r)
+        {
+            if (r->nest++ == 0)
+            {
+                unsigned long e = global_epoch.load(std::memory_order_relaxed);
+                r->announce.store((e << 1) | 1, std::memory_order_relaxed);
+                // 宣告须先于之后对共享结构的任何读取
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+        static void unpin(__epoch_record *r)
+        {
+            if (--r->nest == 0)
+                r->announce.store(0, std::memory_order_release);
+        }
+
+        // n 必须已自共享结构中摘下，不会再被新进入临界区的线程看见
+        static void retire(__epoch_record *r, __epoch_node *n)
+        {
+            n->retire_next = 0;
+            n->retire_epoch = global_epoch.load(std::memory_order_seq_cst);
+            if (r->limbo_tail != 0)
+                r->limbo_tail->retire_next = n;
+            else
+                r->limbo_head = n;
+            r->limbo_tail = n;
+            if (++r->limbo_count % reclaim_threshold == 0)
+            {
+                try_advance();
+                reclaim(r);
+            }
+        }
+
+        // 所有处于临界区的线程都已宣告目前的 epoch 时，令全局 epoch 前进一步
+        static bool try_advance()
+        {
+            unsigned long e = global_epoch.load(std::memory_order_seq_cst);
+            for (__epoch_record *r = records.load(std::memory_order_acquire); r != 0; r = r->next)
+            {
+                unsigned long a = r->announce.load(std::memory_order_seq_cst);
+                if ((a & 1) && (a >> 1) != e)
+                    return false;
+            }
+            return global_epoch.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+        }
+
+        // 释放本线程串列中已经安全的节点
+        static void reclaim(__epoch_record *r)
+        {
+            unsigned long g = global_epoch.load(std::memory_order_seq_cst);
+            while (r->limbo_head != 0 && r->limbo_head->retire_epoch + 2 <= g)
+            {
+                __epoch_node *n = r->limbo_head;
+                if ((r->limbo_head = n->retire_next) == 0)
+                    r->limbo_tail = 0;
+                --r->limbo_count;
+                n->reclaim(n);
+            }
+        }
+
+        // 接手闲置记录中的节点，并尽量推进 epoch 以释放所有节点（线程结束、容器析构时调用）
+        static void quiesce(__epoch_record *r)
+        {
+            for (__epoch_record *o = records.load(std::memory_order_acquire); o != 0; o = o->next)
+            {
+                bool expected = false;
+                if (o == r || o->in_use.load(std::memory_order_relaxed) ||
+                    !o->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                    continue;
+                if (o->limbo_head != 0)
+                {
+                    if (r->limbo_tail != 0)
+                        r->limbo_tail->retire_next = o->limbo_head;
+                    else
+                        r->limbo_head = o->limbo_head;
+                    r->limbo_tail = o->limbo_tail;
+                    r->limbo_count += o->limbo_count;
+                    o->limbo_head = o->limbo_tail = 0;
+                    o->limbo_count = 0;
+                }
+                o->in_use.store(false, std::memory_order_release);
+            }
+            // 接手来的节点不一定按 epoch 排列，故逐一检查
+            for (int i = 0; i < 3 && r->limbo_head != 0; ++i)
+            {
+                try_advance();
+                unsigned long g = global_epoch.load(std::memory_order_seq_cst);
+                __epoch_node *keep = 0, *tail = 0;
+                for (__epoch_node *n = r->limbo_head; n != 0; )
+                {
+                    __epoch_node *next = n->retire_next;
+                    if (n->retire_epoch + 2 <= g)
+                    {
+                        --r->limbo_count;
+                        n->reclaim(n);
+                    }
+                    else
+                    {
+                        n->retire_next = 0;
+                        if (tail != 0)
+                            tail->retire_next = n;
+                        else
+                            keep = n;
+                        tail = n;
+                    }
+                    n = next;
+                }
+                r->limbo_head = keep;
+                r->limbo_tail = tail;
+            }
+        }
+
+        static std::atomic<unsigned long> global_epoch;
+        static std::atomic<__epoch_record *> records;
+    };
+
+    template <class Dummy> std::atomic<unsigned long> __epoch_manager_t<Dummy>::global_epoch(1);
+    template <class Dummy> std::atomic<__epoch_record *> __epoch_manager_t<Dummy>::records(0);
+
+    typedef __epoch_manager_t<> __epoch_manager;
+
+    // 线程第一次进入临界区时取得记录，线程结束时交还
+    struct __epoch_thread
+    {
+        __epoch_record *record;
+        __epoch_thread() : record(__epoch_manager::acquire_record()) {}
+        ~__epoch_thread() { __epoch_manager::release_record(record); }
+    };
+
+    inline __epoch_record *__epoch_local()
+    {
+        static thread_local __epoch_thread t;
+        return t.record;
+    }
+
+    // 临界区：构造时进入，析构时离开。只能在同一个线程内使用
+    class __epoch_guard
+    {
+    public:
+        __epoch_guard() : record(__epoch_local()) { __epoch_manager::pin(record); }
+        __epoch_guard(const __epoch_guard &x) : record(x.record) { __epoch_manager::pin(record); }
+        ~__epoch_guard() { __epoch_manager::unpin(record); }
+        void retire(__epoch_node *n) { __epoch_manager::retire(record, n); }
+
+    private:
+        __epoch_guard &operator=(const __epoch_guard &);
+        __epoch_record *record;
+    };
+}
+#endif
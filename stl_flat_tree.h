@@ -0,0 +1,268 @@
+/***
+* 有序数组（sorted vector）：flat_set / flat_map / flat_multimap 的底层机制。
+* 元素按键值排序后连续存放在一个 vector 中，查找以二分搜索进行，没有任何指针或每节点额外开销，
+* 遍历与查找对缓存友好，适合建好之后大量查询、很少修改的场合。
+* 单一元素的插入、删除须搬移其后的元素，为 O(n)；成批插入时先把新元素排序，
+* 再与原有元素一趟合并，为 O(n + m log m)。
+* 注意：任何插入都可能使全部迭代器失效，删除会使删除点之后的迭代器失效。
+*/
+#ifndef _SIMPLE_STL_FLAT_TREE_H_
+#define _SIMPLE_STL_FLAT_TREE_H_
+
+#include "./stl_iterator.h"
+#include "./memory.h"
+#include "./vector.h"
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+namespace SimpleSTL
+{
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc = alloc2>
+    class flat_tree
+    {
+    public:
+        typedef Key key_type;
+        typedef Value value_type;
+        typedef value_type *pointer;
+        typedef const value_type *const_pointer;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef value_type *iterator;
+        typedef const value_type *const_iterator;
+
+    protected:
+        typedef vector<value_type, Alloc> container_type;
+
+        container_type c;   // 按键值排序的元素
+        Compare key_compare;
+
+        static const Key &key(const_reference v) { return KeyOfValue()(v); }
+
+        // 以值的键值比较，供 std::stable_sort 使用
+        struct value_compare
+        {
+            Compare comp;
+            value_compare(const Compare &c) : comp(c) {}
+            bool operator()(const_reference x, const_reference y) const { return comp(key(x), key(y)); }
+        };
+
+        void __merge_sorted(const_iterator first, const_iterator last, bool unique);
+
+    public:
+        explicit flat_tree(const Compare &comp = Compare()) : key_compare(comp) {}
+
+        Compare key_comp() const { return key_compare; }
+        iterator begin() { return c.begin(); }
+        const_iterator begin() const { return c.begin(); }
+        iterator end() { return c.end(); }
+        const_iterator end() const { return c.end(); }
+        bool empty() const { return c.empty(); }
+        size_type size() const { return c.size(); }
+        size_type max_size() const { return size_type(-1) / sizeof(value_type); }
+        size_type capacity() const { return c.capacity(); }
+        void reserve(size_type n) { c.reserve(n); }
+        void swap(flat_tree &x)
+        {
+            c.swap(x.c);
+            std::swap(key_compare, x.key_compare);
+        }
+
+        std::pair<iterator, bool> insert_unique(const value_type &v)
+        {
+            iterator pos = lower_bound(key(v));
+            if (pos != end() && !key_compare(key(v), key(*pos)))
+                return std::pair<iterator, bool>(pos, false);
+            return std::pair<iterator, bool>(c.insert(pos, v), true);
+        }
+        iterator insert_equal(const value_type &v) { return c.insert(upper_bound(key(v)), v); }
+        // position 恰为插入点时省去二分搜索
+        iterator insert_unique(iterator position, const value_type &v)
+        {
+            if ((position == begin() || key_compare(key(*(position - 1)), key(v))) &&
+                (position == end() || key_compare(key(v), key(*position))))
+                return c.insert(position, v);
+            return insert_unique(v).first;
+        }
+        iterator insert_equal(iterator position, const value_type &v)
+        {
+            if ((position == begin() || !key_compare(key(v), key(*(position - 1)))) &&
+                (position == end() || !key_compare(key(*position), key(v))))
+                return c.insert(position, v);
+            return insert_equal(v);
+        }
+
+        // 成批插入：新元素先排序，再与原有元素一趟合并
+        template <class InputIterator>
+        void insert_unique(InputIterator first, InputIterator last)
+        {
+            container_type run;
+            for (; first != last; ++first)
+                run.push_back(*first);
+            std::stable_sort(run.begin(), run.end(), value_compare(key_compare));
+            __merge_sorted(run.begin(), run.end(), true);
+        }
+        template <class InputIterator>
+        void insert_equal(InputIterator first, InputIterator last)
+        {
+            container_type run;
+            for (; first != last; ++first)
+                run.push_back(*first);
+            std::stable_sort(run.begin(), run.end(), value_compare(key_compare));
+            __merge_sorted(run.begin(), run.end(), false);
+        }
+        // [first, last) 已按键值排序，省去排序，O(n + m)
+        template <class ForwardIterator>
+        void insert_sorted_unique(ForwardIterator first, ForwardIterator last)
+        {
+            container_type run;
+            run.reserve(SimpleSTL::distance(first, last));
+            for (; first != last; ++first)
+                run.push_back(*first);
+            __merge_sorted(run.begin(), run.end(), true);
+        }
+        template <class ForwardIterator>
+        void insert_sorted_equal(ForwardIterator first, ForwardIterator last)
+        {
+            container_type run;
+            run.reserve(SimpleSTL::distance(first, last));
+            for (; first != last; ++first)
+                run.push_back(*first);
+            __merge_sorted(run.begin(), run.end(), false);
+        }
+
+        // 以已排序的 [first, last) 取代全部元素，O(n)；assign_sorted_unique 只保留重复键值中的第一个
+        template <class ForwardIterator>
+        void assign_sorted_unique(ForwardIterator first, ForwardIterator last)
+        {
+            container_type tmp;
+            tmp.reserve(SimpleSTL::distance(first, last));
+            for (; first != last; ++first)
+                if (tmp.empty() || key_compare(key(tmp.back()), key(*first)))
+                    tmp.push_back(*first);
+            c.swap(tmp);
+        }
+        template <class ForwardIterator>
+        void assign_sorted_equal(ForwardIterator first, ForwardIterator last)
+        {
+            container_type tmp;
+            tmp.reserve(SimpleSTL::distance(first, last));
+            for (; first != last; ++first)
+                tmp.push_back(*first);
+            c.swap(tmp);
+        }
+
+        void erase(iterator position) { c.erase(position); }
+        size_type erase(const key_type &k)
+        {
+            std::pair<iterator, iterator> p = equal_range(k);
+            size_type n = p.second - p.first;
+            c.erase(p.first, p.second);
+            return n;
+        }
+        void erase(iterator first, iterator last) { c.erase(first, last); }
+        void clear() { c.clear(); }
+
+        // 二分搜索
+        iterator lower_bound(const key_type &k)
+        {
+            return const_cast<iterator>(static_cast<const flat_tree *>(this)->lower_bound(k));
+        }
+        const_iterator lower_bound(const key_type &k) const
+        {
+            const_iterator first = c.begin();
+            size_type n = c.size();
+            while (n > 0)
+            {
+                size_type half = n >> 1;
+                if (key_compare(key(first[half]), k))
+                {
+                    first += half + 1;
+                    n -= half + 1;
+                }
+                else
+                    n = half;
+            }
+            return first;
+        }
+        iterator upper_bound(const key_type &k)
+        {
+            return const_cast<iterator>(static_cast<const flat_tree *>(this)->upper_bound(k));
+        }
+        const_iterator upper_bound(const key_type &k) const
+        {
+            const_iterator first = c.begin();
+            size_type n = c.size();
+            while (n > 0)
+            {
+                size_type half = n >> 1;
+                if (!key_compare(k, key(first[half])))
+                {
+                    first += half + 1;
+                    n -= half + 1;
+                }
+                else
+                    n = half;
+            }
+            return first;
+        }
+        std::pair<iterator, iterator> equal_range(const key_type &k)
+        {
+            return std::pair<iterator, iterator>(lower_bound(k), upper_bound(k));
+        }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const
+        {
+            return std::pair<const_iterator, const_iterator>(lower_bound(k), upper_bound(k));
+        }
+        iterator find(const key_type &k)
+        {
+            iterator j = lower_bound(k);
+            return (j == end() || key_compare(k, key(*j))) ? end() : j;
+        }
+        const_iterator find(const key_type &k) const
+        {
+            const_iterator j = lower_bound(k);
+            return (j == end() || key_compare(k, key(*j))) ? end() : j;
+        }
+        size_type count(const key_type &k) const { return upper_bound(k) - lower_bound(k); }
+
+        friend bool operator==(const flat_tree &x, const flat_tree &y)
+        {
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        friend bool operator<(const flat_tree &x, const flat_tree &y)
+        {
+            return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+        }
+    };
+
+    // 把已排序的 [first, last) 与原有元素合并进一个新的 vector，再与之交换。
+    // 键值相等时原有元素在前；unique 为 true 时略去与原有元素（或 run 中前一个元素）键值相同者
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void flat_tree<Key, Value, KeyOfValue, Compare, Alloc>::__merge_sorted(
+        const_iterator first, const_iterator last, bool unique)
+    {
+        if (first == last)
+            return;
+        container_type tmp;
+        tmp.reserve(c.size() + (last - first));
+        const_iterator i = c.begin(), e = c.end();
+        while (first != last)
+        {
+            if (i != e && !key_compare(key(*first), key(*i)))
+                tmp.push_back(*i++);
+            else
+            {
+                if (!unique || tmp.empty() || key_compare(key(tmp.back()), key(*first)))
+                    tmp.push_back(*first);
+                ++first;
+            }
+        }
+        for (; i != e; ++i)
+            tmp.push_back(*i);
+        c.swap(tmp);
+    }
+}
+#endif
@@ -0,0 +1,31 @@
+/***
+* 成长策略（growth policy）：容器空间不足时决定新的容量，作为 vector、deque 的模板参数。
+* Policy::next(capacity, needed) 传回不小于 needed 的新容量；自订的策略只需提供同样的静态函数。
+* 倍数越小，扩充越频繁，但闲置的空间也越少：2 倍成长最多闲置一半，1.5 倍成长最多闲置三分之一。
+*/
+#ifndef _SIMPLE_STL_GROWTH_H_
+#define _SIMPLE_STL_GROWTH_H_
+
+#include <cstddef>
+
+namespace SimpleSTL
+{
+    // 每次成长为原容量的 Num / Den 倍；MaxStep 不为 0 时，一次最多增加 MaxStep 个单位，
+    // 避免很大的容器为了少数几个元素再配置一倍的空间
+    template <size_t Num, size_t Den, size_t MaxStep = 0>
+    struct growth_factor
+    {
+        static size_t next(size_t capacity, size_t needed)
+        {
+            size_t step = capacity / Den * (Num - Den) + capacity % Den * (Num - Den) / Den;
+            if (MaxStep != 0 && step > MaxStep)
+                step = MaxStep;
+            return capacity + step < needed ? needed : capacity + step;
+        }
+    };
+
+    typedef growth_factor<2, 1> growth_double;          // SGI STL 的做法，也是预设值
+    typedef growth_factor<3, 2> growth_one_and_half;
+}
+
+#endif
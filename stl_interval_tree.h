@@ -0,0 +1,229 @@
+/***
+* 区间树（interval tree）：interval_set / interval_map 的底层机制。
+* 以 RB-tree 按区间的 (low, high) 排序，每个节点另外记录其子树中最大的右端点 max_high。
+* max_high 与 __rb_tree_os_node 的子树大小一样，经由节点增强的回调在插入、删除、旋转、
+* split / join 时自动维护，树的其余部分不需任何改动。
+* 于是重叠、刺探（stab，查询包含某一点的区间）只需 O(log n) 即可找到第一个结果，
+* 列举全部 k 个结果时只走进确实含有结果的子树，为 O(log n + k log(n / k))，
+* 不必像在 multimap 中由 lower_bound 起逐一扫描那样，遇上长区间就退化为 O(n)。
+* 区间一律为半开区间 [low, high)，端点以 operator< 比较。
+*/
+#ifndef _SIMPLE_STL_INTERVAL_TREE_H_
+#define _SIMPLE_STL_INTERVAL_TREE_H_
+
+#include "./stl_tree.h"
+#include <utility>
+
+namespace SimpleSTL
+{
+    template <class T>
+    struct interval
+    {
+        typedef T endpoint_type;
+
+        T low;
+        T high;
+
+        interval() : low(), high() {}
+        interval(const T &l, const T &h) : low(l), high(h) {}
+
+        bool empty() const { return !(low < high); }
+        bool contains(const T &p) const { return !(p < low) && p < high; }
+        bool overlaps(const interval &x) const { return low < x.high && x.low < high; }
+    };
+
+    template <class T>
+    inline bool operator==(const interval<T> &x, const interval<T> &y)
+    {
+        return !(x.low < y.low) && !(y.low < x.low) && !(x.high < y.high) && !(y.high < x.high);
+    }
+
+    // 先比较左端点，再比较右端点
+    template <class T>
+    inline bool operator<(const interval<T> &x, const interval<T> &y)
+    {
+        return x.low < y.low || (!(y.low < x.low) && x.high < y.high);
+    }
+
+    // 自节点的值取出区间：interval_set 的值即区间，interval_map 的值为 pair<const interval, T>
+    template <class Value>
+    struct __interval_of
+    {
+        typedef typename Value::endpoint_type endpoint_type;
+        static const Value &get(const Value &v) { return v; }
+    };
+    template <class I, class T>
+    struct __interval_of<pair<const I, T> >
+    {
+        typedef typename I::endpoint_type endpoint_type;
+        static const I &get(const pair<const I, T> &v) { return v.first; }
+    };
+
+    // 记录子树中最大右端点的节点
+    template <class Value>
+    struct __rb_tree_interval_node : public __rb_tree_node<Value>
+    {
+        typedef __rb_tree_interval_node<Value> *link_type;
+        typedef typename __interval_of<Value>::endpoint_type endpoint_type;
+        endpoint_type max_high;     // 以本节点为根的子树中，所有区间最大的右端点
+
+        static void update(__rb_tree_node_base *x)
+        {
+            link_type y = static_cast<link_type>(x);
+            y->max_high = __interval_of<Value>::get(y->value_field).high;
+            if (x->left != 0 && y->max_high < static_cast<link_type>(x->left)->max_high)
+                y->max_high = static_cast<link_type>(x->left)->max_high;
+            if (x->right != 0 && y->max_high < static_cast<link_type>(x->right)->max_high)
+                y->max_high = static_cast<link_type>(x->right)->max_high;
+        }
+        static __rb_tree_update_fn update_fn() { return &update; }
+    };
+
+    template <class Key, class Value, class KeyOfValue, class Alloc = alloc2>
+    class interval_tree
+        : public rb_tree<Key, Value, KeyOfValue, less<Key>, Alloc, __rb_tree_interval_node>
+    {
+        typedef rb_tree<Key, Value, KeyOfValue, less<Key>, Alloc, __rb_tree_interval_node> base;
+
+    public:
+        typedef typename Key::endpoint_type endpoint_type;
+        typedef typename base::iterator iterator;
+        typedef typename base::const_iterator const_iterator;
+        typedef typename base::link_type link_type;
+
+    protected:
+        typedef typename base::base_ptr base_ptr;
+
+        static const Key &key(base_ptr x) { return base::key(x); }
+
+        // 列举左端点在 b 之前（closed 时为不超过 b）、右端点在 a 之后的区间，依键值顺序对每个节点调用 f。
+        // 右端点都不超过 a 的子树整个略过；遇到左端点已越过 b 的节点即可停止
+        template <class Function>
+        void __for_each(const endpoint_type &a, const endpoint_type &b, bool closed, Function &f) const
+        {
+            link_type stack[2 * sizeof(size_t) * 8];    // 树高不超过 2 log2(n + 1)
+            int n = 0;
+            link_type x = base::root();
+            for (;;)
+            {
+                for (; x != 0 && a < x->max_high; x = base::left(x))
+                    stack[n++] = x;
+                if (n == 0)
+                    return;
+                x = stack[--n];
+                if (closed ? b < key(x).low : !(key(x).low < b))
+                    return;
+                if (a < key(x).high)
+                    f(x);
+                x = base::right(x);
+            }
+        }
+        // 依键值顺序第一个符合的节点，O(log n)。
+        // 左子树的 max_high 越过 a 时，左子树中若没有结果，整棵树都没有，故只需往左走
+        link_type __find_first(const endpoint_type &a, const endpoint_type &b, bool closed) const
+        {
+            link_type x = base::root();
+            while (x != 0)
+            {
+                link_type l = base::left(x);
+                if (l != 0 && a < l->max_high)
+                    x = l;
+                else if (closed ? b < key(x).low : !(key(x).low < b))
+                    return 0;
+                else if (a < key(x).high)
+                    return x;
+                else
+                    x = base::right(x);
+            }
+            return 0;
+        }
+
+        template <class Function>
+        struct __apply
+        {
+            Function &f;
+            __apply(Function &fn) : f(fn) {}
+            void operator()(link_type x) { f(static_cast<const Value &>(x->value_field)); }
+        };
+        template <class OutputIterator, class Iterator>
+        struct __collect
+        {
+            OutputIterator &out;
+            __collect(OutputIterator &o) : out(o) {}
+            void operator()(link_type x) { *out++ = Iterator(x); }
+        };
+
+    public:
+        interval_tree() : base(less<Key>()) {}
+
+        // 与 q 重叠的区间中，键值最小的一个；没有则传回 end()
+        iterator find_overlap(const Key &q)
+        {
+            link_type x = __find_first(q.low, q.high, false);
+            return x == 0 ? base::end() : iterator(x);
+        }
+        const_iterator find_overlap(const Key &q) const
+        {
+            link_type x = __find_first(q.low, q.high, false);
+            return x == 0 ? base::end() : const_iterator(x);
+        }
+        bool overlaps(const Key &q) const { return __find_first(q.low, q.high, false) != 0; }
+        // 包含 p 的区间中，键值最小的一个
+        iterator find_stab(const endpoint_type &p)
+        {
+            link_type x = __find_first(p, p, true);
+            return x == 0 ? base::end() : iterator(x);
+        }
+        const_iterator find_stab(const endpoint_type &p) const
+        {
+            link_type x = __find_first(p, p, true);
+            return x == 0 ? base::end() : const_iterator(x);
+        }
+
+        // 依键值顺序，把与 q 重叠（或包含 p）的每个元素的迭代器写入 out
+        template <class OutputIterator>
+        OutputIterator overlapping(const Key &q, OutputIterator out)
+        {
+            __collect<OutputIterator, iterator> c(out);
+            __for_each(q.low, q.high, false, c);
+            return out;
+        }
+        template <class OutputIterator>
+        OutputIterator overlapping(const Key &q, OutputIterator out) const
+        {
+            __collect<OutputIterator, const_iterator> c(out);
+            __for_each(q.low, q.high, false, c);
+            return out;
+        }
+        template <class OutputIterator>
+        OutputIterator stabbing(const endpoint_type &p, OutputIterator out)
+        {
+            __collect<OutputIterator, iterator> c(out);
+            __for_each(p, p, true, c);
+            return out;
+        }
+        template <class OutputIterator>
+        OutputIterator stabbing(const endpoint_type &p, OutputIterator out) const
+        {
+            __collect<OutputIterator, const_iterator> c(out);
+            __for_each(p, p, true, c);
+            return out;
+        }
+        // 依键值顺序，对与 q 重叠（或包含 p）的每个元素调用 f
+        template <class Function>
+        Function for_each_overlapping(const Key &q, Function f) const
+        {
+            __apply<Function> a(f);
+            __for_each(q.low, q.high, false, a);
+            return f;
+        }
+        template <class Function>
+        Function for_each_stabbing(const endpoint_type &p, Function f) const
+        {
+            __apply<Function> a(f);
+            __for_each(p, p, true, a);
+            return f;
+        }
+    };
+}
+#endif
@@ -11,6 +11,10 @@ namespace SimpleSTL
 	struct forward_iterator_tag : public input_iterator_tag {};
 	struct bidirectional_iterator_tag : public forward_iterator_tag {};
 	struct random_access_iterator_tag : public bidirectional_iterator_tag {};
+
+    // 构造有序容器时用来声明输入已排序：sorted_unique_tag 且无重复键值，sorted_equal_tag 允许重复
+    struct sorted_unique_tag {};
+    struct sorted_equal_tag {};
     
     // 自行开发的迭代器最好继承下面这个 iterator
     template <class Category,
@@ -0,0 +1,639 @@
+/***
+* 持久化（persistent）平衡树：persistent_set / persistent_map 的底层机制。
+* 节点没有 parent 指针；修改时只复制自根至目标节点的那一条路径（path copying），
+* 其余子树由新旧版本共用。每个节点以原子的引用计数记录有多少个父节点（或容器）指向它，计数归零时释放。
+* 于是复制一个容器（snapshot()）只是让根节点的计数加一，为 O(1)；持有快照的读者线程不加锁即可
+* 查找、遍历一个冻结的版本，写者同时在自己的版本上继续修改。
+* 若自根而下的路径只属于这个版本（计数皆为 1），修改就直接就地进行，不必复制。
+* 平衡采用 AVL：没有 parent 指针，插入、删除沿递归路径由下而上调整即可，树高不超过 1.44 log n。
+* 注意：
+*   1. 一个容器对象本身不是线程安全的，每个线程各自持有一份复本（快照）；
+*   2. 修改容器会使这个版本的迭代器失效，快照的迭代器不受影响；
+*   3. 节点可能由任何一个线程释放，故默认的配置器是线程安全的 alloc1，而不是 alloc2。
+*/
+#ifndef _SIMPLE_STL_PERSISTENT_TREE_H_
+#define _SIMPLE_STL_PERSISTENT_TREE_H_
+
+#include "./stl_iterator.h"
+#include "./memory.h"
+#include <cstddef>
+#include <utility>
+#include <atomic>
+
+namespace SimpleSTL
+{
+    template <class Value>
+    struct __ptree_node
+    {
+        typedef __ptree_node<Value> *node_ptr;
+
+        std::atomic<size_t> refs;   // 指向本节点的父节点与容器的个数
+        node_ptr left;
+        node_ptr right;
+        int height;                 // 以本节点为根的子树高度，叶节点为 1
+        Value value_field;
+    };
+
+    // AVL 树高不超过 1.44 log2(n + 2)，64 位地址空间内的任何节点数都不会超过 96 层
+    enum { __ptree_max_height = 96 };
+
+    // 迭代器以数组记录自根至目前节点的路径，因此节点不需要 parent 指针。
+    // depth 为 0 表示 end()；root 用来自 end() 退回最大的节点
+    template <class Value, class Ref, class Ptr>
+    struct __ptree_iterator
+    {
+        typedef bidirectional_iterator_tag iterator_category;
+        typedef Value value_type;
+        typedef Ref reference;
+        typedef Ptr pointer;
+        typedef ptrdiff_t difference_type;
+        typedef __ptree_iterator<Value, Ref, Ptr> self;
+        typedef __ptree_node<Value> *node_ptr;
+
+        node_ptr root;
+        int depth;
+        node_ptr path[__ptree_max_height];
+
+        __ptree_iterator() : root(0), depth(0) {}
+        explicit __ptree_iterator(node_ptr r) : root(r), depth(0) {}
+        __ptree_iterator(const self &it) { copy(it); }
+        self &operator=(const self &it)
+        {
+            copy(it);
+            return *this;
+        }
+
+        node_ptr node() const { return depth == 0 ? 0 : path[depth - 1]; }
+        reference operator*() const { return node()->value_field; }
+        pointer operator->() const { return &(operator*()); }
+
+        // 自 x 起一路向左（或向右）走到底，沿途节点记入路径
+        void push_leftmost(node_ptr x)
+        {
+            for (; x != 0; x = x->left)
+                path[depth++] = x;
+        }
+        void push_rightmost(node_ptr x)
+        {
+            for (; x != 0; x = x->right)
+                path[depth++] = x;
+        }
+
+        void increment()
+        {
+            node_ptr x = path[depth - 1];
+            if (x->right != 0)
+            {
+                push_leftmost(x->right);
+                return;
+            }
+            // 沿路径上行，直到自左子树上来为止
+            while (depth > 1 && path[depth - 2]->right == path[depth - 1])
+                --depth;
+            --depth;
+        }
+        void decrement()
+        {
+            if (depth == 0)     // end()
+            {
+                push_rightmost(root);
+                return;
+            }
+            node_ptr x = path[depth - 1];
+            if (x->left != 0)
+            {
+                push_rightmost(x->left);
+                return;
+            }
+            while (depth > 1 && path[depth - 2]->left == path[depth - 1])
+                --depth;
+            --depth;
+        }
+
+        self &operator++()
+        {
+            increment();
+            return *this;
+        }
+        self operator++(int)
+        {
+            self tmp = *this;
+            increment();
+            return tmp;
+        }
+        self &operator--()
+        {
+            decrement();
+            return *this;
+        }
+        self operator--(int)
+        {
+            self tmp = *this;
+            decrement();
+            return tmp;
+        }
+        bool operator==(const self &x) const { return node() == x.node(); }
+        bool operator!=(const self &x) const { return node() != x.node(); }
+
+    private:
+        void copy(const self &it)
+        {
+            root = it.root;
+            depth = it.depth;
+            for (int i = 0; i < depth; ++i)     // 只复制用到的那一段路径
+                path[i] = it.path[i];
+        }
+    };
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc = alloc1>
+    class persistent_tree
+    {
+    public:
+        typedef Key key_type;
+        typedef Value value_type;
+        typedef value_type *pointer;
+        typedef const value_type *const_pointer;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        // 节点可能与其他版本共用，不能经由迭代器修改，iterator 与 const_iterator 同为常量迭代器
+        typedef __ptree_iterator<value_type, const_reference, const_pointer> const_iterator;
+        typedef const_iterator iterator;
+
+    protected:
+        typedef __ptree_node<Value> node_type;
+        typedef node_type *link_type;
+        typedef simple_alloc<node_type, Alloc> node_allocator;
+
+        // 持久树只以三笔数据表现
+        link_type root;
+        size_type node_count;
+        Compare key_compare;
+
+        static const Key &key(link_type x) { return KeyOfValue()(x->value_field); }
+        static int height(link_type x) { return x == 0 ? 0 : x->height; }
+        static void fix_height(link_type x)
+        {
+            int hl = height(x->left), hr = height(x->right);
+            x->height = (hl > hr ? hl : hr) + 1;
+        }
+
+        static link_type create_node(const value_type &v)
+        {
+            link_type x = node_allocator::allocate();
+            try
+            {
+                construct(&x->value_field, v);
+            }
+            catch (...)
+            {
+                node_allocator::deallocate(x);
+                throw;
+            }
+            new (&x->refs) std::atomic<size_t>(1);
+            x->left = x->right = 0;
+            x->height = 1;
+            return x;
+        }
+        // 复制一个节点：新节点与原节点共用左右子树
+        static link_type clone_node(link_type x)
+        {
+            link_type y = create_node(x->value_field);
+            y->left = x->left;
+            y->right = x->right;
+            y->height = x->height;
+            ref(y->left);
+            ref(y->right);
+            return y;
+        }
+        // 只释放节点本身，不理会子节点
+        static void destroy_node(link_type x)
+        {
+            destroy(&x->value_field);
+            node_allocator::deallocate(x);
+        }
+
+        static void ref(link_type x)
+        {
+            if (x != 0)
+                x->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        static void release(link_type x);
+        static link_type own(link_type x);
+
+        static link_type rotate_left(link_type x);
+        static link_type rotate_right(link_type x);
+        static link_type balance(link_type x);
+        link_type __insert(link_type &x, const value_type &v);
+        link_type __erase(link_type &x, const key_type &k);
+        static link_type __remove_min(link_type &x, link_type &m);
+
+    public:
+        explicit persistent_tree(const Compare &comp = Compare())
+            : root(0), node_count(0), key_compare(comp) {}
+        // 复制只是共用根节点
+        persistent_tree(const persistent_tree &x)
+            : root(x.root), node_count(x.node_count), key_compare(x.key_compare) { ref(root); }
+        persistent_tree &operator=(const persistent_tree &x)
+        {
+            ref(x.root);
+            release(root);
+            root = x.root;
+            node_count = x.node_count;
+            key_compare = x.key_compare;
+            return *this;
+        }
+        ~persistent_tree() { release(root); }
+
+        Compare key_comp() const { return key_compare; }
+        const_iterator begin() const
+        {
+            const_iterator it(root);
+            it.push_leftmost(root);
+            return it;
+        }
+        const_iterator end() const { return const_iterator(root); }
+        bool empty() const { return node_count == 0; }
+        size_type size() const { return node_count; }
+        size_type max_size() const { return size_type(-1); }
+        void swap(persistent_tree &t)
+        {
+            std::swap(root, t.root);
+            std::swap(node_count, t.node_count);
+            std::swap(key_compare, t.key_compare);
+        }
+        void clear()
+        {
+            release(root);
+            root = 0;
+            node_count = 0;
+        }
+
+        std::pair<const_iterator, bool> insert_unique(const value_type &v);
+        template <class InputIterator>
+        void insert_unique(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first)
+                insert_unique(*first);
+        }
+        size_type erase(const key_type &k);
+        void erase(const_iterator position) { erase(KeyOfValue()(*position)); }
+        void erase(const_iterator first, const_iterator last);
+
+        // 沿路径复制到键值为 k 的节点（必须存在），传回可以修改的值。
+        // 传回的引用在下一次修改或复制容器之前有效
+        reference modify(const key_type &k);
+
+        const_iterator find(const key_type &k) const;
+        size_type count(const key_type &k) const { return find(k) == end() ? 0 : 1; }
+        const_iterator lower_bound(const key_type &k) const;
+        const_iterator upper_bound(const key_type &k) const;
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const
+        {
+            return std::pair<const_iterator, const_iterator>(lower_bound(k), upper_bound(k));
+        }
+
+        // 以下函数供测试用：检查 AVL 性质与键值顺序
+        bool __verify() const;
+    };
+
+    // 减少 x 的引用计数，归零则释放 x，并对其子节点重复同样的动作。
+    // 不递归：待处理的右子节点记在数组里，它们都是目前路径上某个祖先的右子节点，数量不超过树高
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::release(link_type x)
+    {
+        link_type stack[__ptree_max_height];
+        int n = 0;
+        for (;;)
+        {
+            if (x == 0 || x->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            {
+                if (n == 0)
+                    return;
+                x = stack[--n];
+                continue;
+            }
+            link_type l = x->left, r = x->right;
+            destroy_node(x);
+            if (r != 0)
+                stack[n++] = r;
+            x = l;
+        }
+    }
+
+    // 取得 x 的独占版本：x 只被一个父节点引用时直接传回，否则复制一份并放弃对 x 的引用。
+    // 调用者须保证自根至 x 的父节点都已独占，于是计数为 1 的节点不可能被其他线程看见
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::own(link_type x)
+    {
+        if (x->refs.load(std::memory_order_acquire) == 1)
+            return x;
+        link_type y = clone_node(x);
+        release(x);
+        return y;
+    }
+
+    // 旋转会修改 x 与其子节点，两者都须独占；x 由调用者保证
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::rotate_left(link_type x)
+    {
+        link_type y = own(x->right);
+        x->right = y->left;
+        y->left = x;
+        fix_height(x);
+        fix_height(y);
+        return y;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::rotate_right(link_type x)
+    {
+        link_type y = own(x->left);
+        x->left = y->right;
+        y->right = x;
+        fix_height(x);
+        fix_height(y);
+        return y;
+    }
+
+    // 左右子树高度相差超过 1 时旋转，传回调整后的子树根节点（x 须独占）
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::balance(link_type x)
+    {
+        int hl = height(x->left), hr = height(x->right);
+        if (hl > hr + 1)
+        {
+            if (height(x->left->left) < height(x->left->right))
+            {
+                x->left = own(x->left);
+                x->left = rotate_left(x->left);
+            }
+            return rotate_right(x);
+        }
+        if (hr > hl + 1)
+        {
+            if (height(x->right->right) < height(x->right->left))
+            {
+                x->right = own(x->right);
+                x->right = rotate_right(x->right);
+            }
+            return rotate_left(x);
+        }
+        x->height = (hl > hr ? hl : hr) + 1;
+        return x;
+    }
+
+    // 以下三个函数的 x 是父节点（或 root）中的连结。与 modify 相同，独占的复本先写回 x 再往下递归，
+    // 下层复制节点时抛出异常，自根而下的每个连结仍指向自己持有的节点，树的内容不变。
+
+    // 键值不重复的插入由 insert_unique 先确认，这里一律插入。
+    // 插入之后需要旋转的只有刚才走过、已经独占的节点，balance 不会再复制节点，
+    // 所以异常只可能在改变结构之前发生
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::__insert(link_type &x, const value_type &v)
+    {
+        if (x == 0)
+            return create_node(v);
+        x = own(x);
+        if (key_compare(KeyOfValue()(v), key(x)))
+            x->left = __insert(x->left, v);
+        else
+            x->right = __insert(x->right, v);
+        return balance(x);
+    }
+
+    // 自子树 x 中摘下最小的节点 m（已独占，左右连结待调用者设定），传回剩下的子树
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::__remove_min(link_type &x, link_type &m)
+    {
+        x = own(x);
+        if (x->left == 0)
+        {
+            m = x;
+            return x->right;    // 对右子树的引用转交给 x 的父节点
+        }
+        x->left = __remove_min(x->left, m);
+        return balance(x);
+    }
+
+    // 键值 k 必须存在（由 erase 先确认）。
+    // 删除之后要旋转的是另一侧可能与其他版本共用的子树，balance 复制节点时仍可能抛出异常；
+    // 此时节点已经摘下，x 随时指向合法的子树，只是路径上的高度与平衡可能暂时不是最新的
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::__erase(link_type &x, const key_type &k)
+    {
+        x = own(x);
+        if (key_compare(k, key(x)))
+            x->left = __erase(x->left, k);
+        else if (key_compare(key(x), k))
+            x->right = __erase(x->right, k);
+        else
+        {
+            link_type y = x, m;
+            if (y->right == 0 || y->left == 0)
+            {
+                x = y->right == 0 ? y->left : y->right;
+                destroy_node(y);    // 对子树的引用转交给父节点
+                return x;
+            }
+            // 先摘下右子树的最小节点（可能抛出异常），y 在此之前保持完整
+            y->right = __remove_min(y->right, m);
+            m->left = y->left;      // 对子树的引用转交给取代 y 的节点
+            m->right = y->right;
+            fix_height(m);
+            x = m;
+            destroy_node(y);
+            return balance(m);
+        }
+        return balance(x);
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    std::pair<typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator, bool>
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(const value_type &v)
+    {
+        // 先查找：键值已存在时不复制任何节点
+        const_iterator it = find(KeyOfValue()(v));
+        if (it != end())
+            return std::pair<const_iterator, bool>(it, false);
+        root = __insert(root, v);   // 抛出异常时树的内容不变
+        ++node_count;
+        return std::pair<const_iterator, bool>(find(KeyOfValue()(v)), true);
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::size_type
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::erase(const key_type &k)
+    {
+        if (find(k) == end())
+            return 0;
+        try
+        {
+            root = __erase(root, k);
+        }
+        catch (...)
+        {
+            // 节点可能已经摘下，依树的实际内容修正节点数
+            if (find(k) == end())
+                --node_count;
+            throw;
+        }
+        --node_count;
+        return 1;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::erase(const_iterator first, const_iterator last)
+    {
+        if (first == begin() && last == end())
+        {
+            clear();
+            return;
+        }
+        // 每次删除都会使迭代器失效，故先记下键值范围的终点
+        if (last == end())
+        {
+            while (first != end())
+            {
+                key_type k = KeyOfValue()(*first);
+                erase(k);
+                first = lower_bound(k);
+            }
+            return;
+        }
+        key_type stop = KeyOfValue()(*last);
+        while (key_compare(KeyOfValue()(*first), stop))
+        {
+            key_type k = KeyOfValue()(*first);
+            erase(k);
+            first = lower_bound(k);
+        }
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::reference
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::modify(const key_type &k)
+    {
+        link_type *slot = &root;
+        for (;;)
+        {
+            link_type x = *slot = own(*slot);
+            if (key_compare(k, key(x)))
+                slot = &x->left;
+            else if (key_compare(key(x), k))
+                slot = &x->right;
+            else
+                return x->value_field;
+        }
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::lower_bound(const key_type &k) const
+    {
+        // 沿路径记录，最后截断到最近一个 “不小于 k” 的节点
+        const_iterator it(root);
+        int found = 0;
+        for (link_type x = root; x != 0; )
+        {
+            it.path[it.depth++] = x;
+            if (!key_compare(key(x), k))
+            {
+                found = it.depth;
+                x = x->left;
+            }
+            else
+                x = x->right;
+        }
+        it.depth = found;
+        return it;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::upper_bound(const key_type &k) const
+    {
+        const_iterator it(root);
+        int found = 0;
+        for (link_type x = root; x != 0; )
+        {
+            it.path[it.depth++] = x;
+            if (key_compare(k, key(x)))
+            {
+                found = it.depth;
+                x = x->left;
+            }
+            else
+                x = x->right;
+        }
+        it.depth = found;
+        return it;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator
+    persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::find(const key_type &k) const
+    {
+        const_iterator it = lower_bound(k);
+        return (it == end() || key_compare(k, KeyOfValue()(*it))) ? end() : it;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    bool persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::__verify() const
+    {
+        // 以迭代器检查键值严格递增、节点数正确；再逐一检查路径上节点的高度与平衡
+        size_type n = 0;
+        for (const_iterator it = begin(); it != end(); ++it, ++n)
+        {
+            link_type x = it.node();
+            int hl = height(x->left), hr = height(x->right);
+            if (x->height != (hl > hr ? hl : hr) + 1 || hl > hr + 1 || hr > hl + 1)
+                return false;
+            if (x->refs.load() == 0)
+                return false;
+            const_iterator next = it;
+            ++next;
+            if (next != end() && !key_compare(key(x), KeyOfValue()(*next)))
+                return false;
+        }
+        return n == node_count;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    inline bool operator==(const persistent_tree<Key, Value, KeyOfValue, Compare, Alloc> &x,
+                           const persistent_tree<Key, Value, KeyOfValue, Compare, Alloc> &y)
+    {
+        if (x.size() != y.size())
+            return false;
+        typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator i = x.begin(), j = y.begin();
+        for (; i != x.end(); ++i, ++j)
+            if (!(*i == *j))
+                return false;
+        return true;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    inline bool operator<(const persistent_tree<Key, Value, KeyOfValue, Compare, Alloc> &x,
+                          const persistent_tree<Key, Value, KeyOfValue, Compare, Alloc> &y)
+    {
+        typename persistent_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator i = x.begin(), j = y.begin();
+        for (; i != x.end() && j != y.end(); ++i, ++j)
+        {
+            if (*i < *j)
+                return true;
+            if (*j < *i)
+                return false;
+        }
+        return i == x.end() && j != y.end();
+    }
+}
+#endif
@@ -0,0 +1,1113 @@
+/***
+* 自适应基数树（adaptive radix tree，ART）：radix_map 的底层机制。
+* 键值为 std::string，以字节为单位逐层分支，查找只与键值长度有关，与元素个数无关，
+* 也不必像 RB-tree 那样在每一层重新比较键值共同的前缀。
+* 内部节点依子节点个数选用四种大小：Node4、Node16（有序的键值字节数组）、
+* Node48（256 项的索引表加 48 个子节点）、Node256（直接以字节为索引），随插入删除而增长、收缩；
+* 只有一个子节点的路径压缩进子节点的 prefix（前 8 个字节存于节点，其余需要时自子树中任一叶节点取得）。
+* 某个键值恰为其他键值的前缀时，存放在对应内部节点的 term 中，排在其所有子节点之前，
+* 于是遍历顺序与 std::string 的 operator< 相同。
+* 叶节点另外依键值顺序串成以 header 为哨兵的环状双向串列，迭代器的 ++ / -- 为 O(1)。
+* 插入、删除不会使其他元素的迭代器失效。
+*/
+#ifndef _SIMPLE_STL_RADIX_TREE_H_
+#define _SIMPLE_STL_RADIX_TREE_H_
+
+#include "./stl_iterator.h"
+#include "./memory.h"
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <algorithm>
+
+namespace SimpleSTL
+{
+    enum __art_node_type
+    {
+        __art_leaf_type,
+        __art_node4_type,
+        __art_node16_type,
+        __art_node48_type,
+        __art_node256_type
+    };
+
+    struct __art_node
+    {
+        unsigned char type;
+    };
+
+    struct __art_leaf_base : public __art_node
+    {
+        __art_leaf_base *prev;
+        __art_leaf_base *next;
+    };
+
+    template <class Value>
+    struct __art_leaf : public __art_leaf_base
+    {
+        Value value_field;
+    };
+
+    struct __art_inner : public __art_node
+    {
+        enum { max_prefix = 8 };
+        unsigned short count;                   // 子节点个数（不含 term）
+        unsigned char prefix[max_prefix];       // 压缩路径的前 max_prefix 个字节
+        size_t prefix_len;                      // 压缩路径的长度
+        __art_leaf_base *term;                  // 键值恰好在此结束的元素
+    };
+
+    struct __art_node4 : public __art_inner
+    {
+        unsigned char keys[4];      // 有序
+        __art_node *children[4];
+    };
+
+    struct __art_node16 : public __art_inner
+    {
+        unsigned char keys[16];     // 有序
+        __art_node *children[16];
+    };
+
+    struct __art_node48 : public __art_inner
+    {
+        unsigned char index[256];   // 0 表示没有，否则为 children 中的位置加 1
+        __art_node *children[48];
+    };
+
+    struct __art_node256 : public __art_inner
+    {
+        __art_node *children[256];
+    };
+
+    // 键值字节为 c 的子节点所在位置，没有则传回 0
+    inline __art_node **__art_find_child(__art_inner *n, unsigned char c)
+    {
+        switch (n->type)
+        {
+        case __art_node4_type:
+        {
+            __art_node4 *p = static_cast<__art_node4 *>(n);
+            for (int i = 0; i < p->count; ++i)
+                if (p->keys[i] == c)
+                    return &p->children[i];
+            return 0;
+        }
+        case __art_node16_type:
+        {
+            __art_node16 *p = static_cast<__art_node16 *>(n);
+            for (int i = 0; i < p->count && p->keys[i] <= c; ++i)
+                if (p->keys[i] == c)
+                    return &p->children[i];
+            return 0;
+        }
+        case __art_node48_type:
+        {
+            __art_node48 *p = static_cast<__art_node48 *>(n);
+            return p->index[c] == 0 ? 0 : &p->children[p->index[c] - 1];
+        }
+        default:
+        {
+            __art_node256 *p = static_cast<__art_node256 *>(n);
+            return p->children[c] == 0 ? 0 : &p->children[c];
+        }
+        }
+    }
+
+    // 键值字节大于 c 的第一个子节点（c 为 -1 时即第一个子节点），没有则传回 0
+    inline __art_node *__art_child_after(__art_inner *n, int c)
+    {
+        switch (n->type)
+        {
+        case __art_node4_type:
+        {
+            __art_node4 *p = static_cast<__art_node4 *>(n);
+            for (int i = 0; i < p->count; ++i)
+                if (p->keys[i] > c)
+                    return p->children[i];
+            return 0;
+        }
+        case __art_node16_type:
+        {
+            __art_node16 *p = static_cast<__art_node16 *>(n);
+            for (int i = 0; i < p->count; ++i)
+                if (p->keys[i] > c)
+                    return p->children[i];
+            return 0;
+        }
+        case __art_node48_type:
+        {
+            __art_node48 *p = static_cast<__art_node48 *>(n);
+            for (int b = c + 1; b < 256; ++b)
+                if (p->index[b] != 0)
+                    return p->children[p->index[b] - 1];
+            return 0;
+        }
+        default:
+        {
+            __art_node256 *p = static_cast<__art_node256 *>(n);
+            for (int b = c + 1; b < 256; ++b)
+                if (p->children[b] != 0)
+                    return p->children[b];
+            return 0;
+        }
+        }
+    }
+
+    // 最后一个子节点，没有则传回 0
+    inline __art_node *__art_last_child(__art_inner *n)
+    {
+        switch (n->type)
+        {
+        case __art_node4_type:
+        {
+            __art_node4 *p = static_cast<__art_node4 *>(n);
+            return p->count == 0 ? 0 : p->children[p->count - 1];
+        }
+        case __art_node16_type:
+        {
+            __art_node16 *p = static_cast<__art_node16 *>(n);
+            return p->count == 0 ? 0 : p->children[p->count - 1];
+        }
+        case __art_node48_type:
+        {
+            __art_node48 *p = static_cast<__art_node48 *>(n);
+            for (int b = 255; b >= 0; --b)
+                if (p->index[b] != 0)
+                    return p->children[p->index[b] - 1];
+            return 0;
+        }
+        default:
+        {
+            __art_node256 *p = static_cast<__art_node256 *>(n);
+            for (int b = 255; b >= 0; --b)
+                if (p->children[b] != 0)
+                    return p->children[b];
+            return 0;
+        }
+        }
+    }
+
+    // 依键值顺序，对每个子节点调用 f(键值字节, 子节点)
+    template <class Function>
+    inline void __art_for_each_child(__art_inner *n, Function &f)
+    {
+        switch (n->type)
+        {
+        case __art_node4_type:
+        {
+            __art_node4 *p = static_cast<__art_node4 *>(n);
+            for (int i = 0; i < p->count; ++i)
+                f(p->keys[i], p->children[i]);
+            break;
+        }
+        case __art_node16_type:
+        {
+            __art_node16 *p = static_cast<__art_node16 *>(n);
+            for (int i = 0; i < p->count; ++i)
+                f(p->keys[i], p->children[i]);
+            break;
+        }
+        case __art_node48_type:
+        {
+            __art_node48 *p = static_cast<__art_node48 *>(n);
+            for (int b = 0; b < 256; ++b)
+                if (p->index[b] != 0)
+                    f((unsigned char)b, p->children[p->index[b] - 1]);
+            break;
+        }
+        default:
+        {
+            __art_node256 *p = static_cast<__art_node256 *>(n);
+            for (int b = 0; b < 256; ++b)
+                if (p->children[b] != 0)
+                    f((unsigned char)b, p->children[b]);
+            break;
+        }
+        }
+    }
+
+    template <class Value, class Ref, class Ptr>
+    struct __radix_tree_iterator
+    {
+        typedef bidirectional_iterator_tag iterator_category;
+        typedef Value value_type;
+        typedef Ref reference;
+        typedef Ptr pointer;
+        typedef ptrdiff_t difference_type;
+        typedef __radix_tree_iterator<Value, Value &, Value *> iterator;
+        typedef __radix_tree_iterator<Value, const Value &, const Value *> const_iterator;
+        typedef __radix_tree_iterator<Value, Ref, Ptr> self;
+
+        __art_leaf_base *node;
+
+        __radix_tree_iterator() : node(0) {}
+        __radix_tree_iterator(__art_leaf_base *x) : node(x) {}
+        __radix_tree_iterator(const iterator &it) : node(it.node) {}
+
+        reference operator*() const { return static_cast<__art_leaf<Value> *>(node)->value_field; }
+        pointer operator->() const { return &(operator*()); }
+
+        self &operator++()
+        {
+            node = node->next;
+            return *this;
+        }
+        self operator++(int)
+        {
+            self tmp = *this;
+            node = node->next;
+            return tmp;
+        }
+        self &operator--()
+        {
+            node = node->prev;
+            return *this;
+        }
+        self operator--(int)
+        {
+            self tmp = *this;
+            node = node->prev;
+            return tmp;
+        }
+
+        bool operator==(const self &x) const { return node == x.node; }
+        bool operator!=(const self &x) const { return node != x.node; }
+    };
+
+    template <class Value, class KeyOfValue, class Alloc = alloc2>
+    class radix_tree
+    {
+    public:
+        typedef std::string key_type;
+        typedef Value value_type;
+        typedef value_type *pointer;
+        typedef const value_type *const_pointer;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef __radix_tree_iterator<value_type, reference, pointer> iterator;
+        typedef __radix_tree_iterator<value_type, const_reference, const_pointer> const_iterator;
+
+    protected:
+        typedef __art_leaf<Value> leaf_type;
+        typedef __art_leaf_base *leaf_ptr;
+        typedef simple_alloc<leaf_type, Alloc> leaf_allocator;
+        typedef simple_alloc<__art_leaf_base, Alloc> header_allocator;
+        typedef simple_alloc<__art_node4, Alloc> node4_allocator;
+        typedef simple_alloc<__art_node16, Alloc> node16_allocator;
+        typedef simple_alloc<__art_node48, Alloc> node48_allocator;
+        typedef simple_alloc<__art_node256, Alloc> node256_allocator;
+
+        __art_node *root;
+        leaf_ptr header;        // 叶节点串列的哨兵，即 end()
+        size_type node_count;
+
+        static const key_type &key(const __art_leaf_base *x)
+        {
+            return KeyOfValue()(static_cast<const leaf_type *>(x)->value_field);
+        }
+        static bool is_leaf(const __art_node *x) { return x->type == __art_leaf_type; }
+        static __art_inner *inner(__art_node *x) { return static_cast<__art_inner *>(x); }
+
+        // 子树中键值最小、最大的叶节点
+        static leaf_ptr minimum(__art_node *x)
+        {
+            while (!is_leaf(x))
+            {
+                if (inner(x)->term != 0)
+                    return inner(x)->term;
+                x = __art_child_after(inner(x), -1);
+            }
+            return static_cast<leaf_ptr>(x);
+        }
+        static leaf_ptr maximum(__art_node *x)
+        {
+            while (!is_leaf(x))
+            {
+                if (inner(x)->count == 0)
+                    return inner(x)->term;
+                x = __art_last_child(inner(x));
+            }
+            return static_cast<leaf_ptr>(x);
+        }
+
+        // 节点 n（其压缩路径自 k 的第 depth 个字节开始）的压缩路径与 k 相同的字节数。
+        // 超出 max_prefix 的部分与子树中任一叶节点的键值比较
+        static size_t __prefix_match(__art_inner *n, const key_type &k, size_t depth)
+        {
+            size_t lim = std::min(n->prefix_len, k.size() - depth);
+            size_t inl = std::min(lim, size_t(__art_inner::max_prefix));
+            size_t i = 0;
+            for (; i < inl; ++i)
+                if (n->prefix[i] != (unsigned char)k[depth + i])
+                    return i;
+            if (i < lim)
+            {
+                const key_type &lk = key(minimum(n));
+                for (; i < lim; ++i)
+                    if (lk[depth + i] != k[depth + i])
+                        return i;
+            }
+            return i;
+        }
+        static unsigned char __prefix_byte(__art_inner *n, size_t depth, size_t i)
+        {
+            if (i < __art_inner::max_prefix)
+                return n->prefix[i];
+            return (unsigned char)key(minimum(n))[depth + i];
+        }
+        static void __set_prefix(__art_inner *n, const key_type &k, size_t from, size_t len)
+        {
+            n->prefix_len = len;
+            std::memcpy(n->prefix, k.data() + from, std::min(len, size_t(__art_inner::max_prefix)));
+        }
+
+        leaf_type *create_leaf(const value_type &v)
+        {
+            leaf_type *z = leaf_allocator::allocate();
+            construct(&z->value_field, v);
+            z->type = __art_leaf_type;
+            return z;
+        }
+        void destroy_leaf(leaf_ptr x)
+        {
+            leaf_type *z = static_cast<leaf_type *>(x);
+            destroy(&z->value_field);
+            leaf_allocator::deallocate(z);
+        }
+        template <class NodeType, class NodeAlloc>
+        static NodeType *__new_node(unsigned char type)
+        {
+            NodeType *n = NodeAlloc::allocate();
+            std::memset(n, 0, sizeof(NodeType));
+            n->type = type;
+            return n;
+        }
+        static __art_node4 *new_node4()
+        {
+            return __new_node<__art_node4, node4_allocator>(__art_node4_type);
+        }
+        static void free_node(__art_inner *n)
+        {
+            switch (n->type)
+            {
+            case __art_node4_type: node4_allocator::deallocate(static_cast<__art_node4 *>(n)); break;
+            case __art_node16_type: node16_allocator::deallocate(static_cast<__art_node16 *>(n)); break;
+            case __art_node48_type: node48_allocator::deallocate(static_cast<__art_node48 *>(n)); break;
+            default: node256_allocator::deallocate(static_cast<__art_node256 *>(n)); break;
+            }
+        }
+        static void __copy_header(__art_inner *to, const __art_inner *from)
+        {
+            to->prefix_len = from->prefix_len;
+            std::memcpy(to->prefix, from->prefix, sizeof(from->prefix));
+            to->term = from->term;
+        }
+
+        static void __add_child(__art_node **ref, unsigned char c, __art_node *child);
+        static void __remove_child(__art_node **ref, unsigned char c);
+        static void __compact(__art_node **ref, size_t depth);
+        void __insert_leaf(leaf_ptr z);
+        void __erase_leaf(leaf_ptr z);
+        void __destroy(__art_node *x);
+        __art_node *__copy(__art_node *x);
+        leaf_ptr __find(const key_type &k) const;
+        leaf_ptr __lower_bound(const key_type &k) const;
+        __art_node *__prefix_subtree(const key_type &p) const;
+        leaf_ptr __longest_prefix(const key_type &k) const;
+
+        void init()
+        {
+            header = header_allocator::allocate();
+            header->type = __art_leaf_type;
+            header->prev = header->next = header;
+            root = 0;
+            node_count = 0;
+        }
+
+    public:
+        radix_tree() { init(); }
+        radix_tree(const radix_tree &x)
+        {
+            init();
+            *this = x;
+        }
+        ~radix_tree()
+        {
+            clear();
+            header_allocator::deallocate(header);
+        }
+        radix_tree &operator=(const radix_tree &x);
+
+        iterator begin() { return iterator(header->next); }
+        const_iterator begin() const { return const_iterator(header->next); }
+        iterator end() { return iterator(header); }
+        const_iterator end() const { return const_iterator(header); }
+        bool empty() const { return node_count == 0; }
+        size_type size() const { return node_count; }
+        size_type max_size() const { return size_type(-1) / sizeof(leaf_type); }
+        void swap(radix_tree &x)
+        {
+            std::swap(root, x.root);
+            std::swap(header, x.header);
+            std::swap(node_count, x.node_count);
+        }
+
+        std::pair<iterator, bool> insert_unique(const value_type &v);
+        // 与 map 的提示插入接口相容；基数树的查找只与键值长度有关，提示不起作用
+        iterator insert_unique(iterator, const value_type &v) { return insert_unique(v).first; }
+        template <class InputIterator>
+        void insert_unique(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first)
+                insert_unique(*first);
+        }
+
+        void erase(iterator position)
+        {
+            __erase_leaf(position.node);
+            position.node->prev->next = position.node->next;
+            position.node->next->prev = position.node->prev;
+            destroy_leaf(position.node);
+            --node_count;
+        }
+        size_type erase(const key_type &k)
+        {
+            leaf_ptr x = __find(k);
+            if (x == 0)
+                return 0;
+            erase(iterator(x));
+            return 1;
+        }
+        void erase(iterator first, iterator last)
+        {
+            if (first == begin() && last == end())
+                clear();
+            else
+                while (first != last)
+                    erase(first++);
+        }
+        void clear()
+        {
+            if (root != 0)
+            {
+                __destroy(root);
+                root = 0;
+            }
+            header->prev = header->next = header;
+            node_count = 0;
+        }
+
+        iterator find(const key_type &k)
+        {
+            leaf_ptr x = __find(k);
+            return x == 0 ? end() : iterator(x);
+        }
+        const_iterator find(const key_type &k) const
+        {
+            leaf_ptr x = __find(k);
+            return x == 0 ? end() : const_iterator(x);
+        }
+        size_type count(const key_type &k) const { return __find(k) == 0 ? 0 : 1; }
+        iterator lower_bound(const key_type &k) { return iterator(__lower_bound(k)); }
+        const_iterator lower_bound(const key_type &k) const { return const_iterator(__lower_bound(k)); }
+        iterator upper_bound(const key_type &k)
+        {
+            leaf_ptr x = __lower_bound(k);
+            return iterator(x != header && key(x) == k ? x->next : x);
+        }
+        const_iterator upper_bound(const key_type &k) const
+        {
+            leaf_ptr x = __lower_bound(k);
+            return const_iterator(x != header && key(x) == k ? x->next : x);
+        }
+        std::pair<iterator, iterator> equal_range(const key_type &k)
+        {
+            return std::pair<iterator, iterator>(lower_bound(k), upper_bound(k));
+        }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const
+        {
+            return std::pair<const_iterator, const_iterator>(lower_bound(k), upper_bound(k));
+        }
+
+        // 以 p 为前缀的全部元素，依键值顺序。只需走到 p 所在的子树，与元素个数无关
+        std::pair<iterator, iterator> prefix_range(const key_type &p)
+        {
+            __art_node *x = __prefix_subtree(p);
+            if (x == 0)
+                return std::pair<iterator, iterator>(end(), end());
+            return std::pair<iterator, iterator>(iterator(minimum(x)), iterator(maximum(x)->next));
+        }
+        std::pair<const_iterator, const_iterator> prefix_range(const key_type &p) const
+        {
+            __art_node *x = __prefix_subtree(p);
+            if (x == 0)
+                return std::pair<const_iterator, const_iterator>(end(), end());
+            return std::pair<const_iterator, const_iterator>(const_iterator(minimum(x)),
+                                                             const_iterator(maximum(x)->next));
+        }
+        // 键值为 k 的前缀（含 k 本身）的元素中最长的一个，没有则传回 end()。用于最长前缀匹配的路由查找
+        iterator longest_prefix(const key_type &k) { return iterator(__longest_prefix(k)); }
+        const_iterator longest_prefix(const key_type &k) const { return const_iterator(__longest_prefix(k)); }
+
+        friend bool operator==(const radix_tree &x, const radix_tree &y)
+        {
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        friend bool operator<(const radix_tree &x, const radix_tree &y)
+        {
+            return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+        }
+    };
+
+    // 把 child 以键值字节 c 加入 *ref 所指的内部节点，节点已满时先换成大一号的节点
+    template <class Value, class KeyOfValue, class Alloc>
+    void radix_tree<Value, KeyOfValue, Alloc>::__add_child(__art_node **ref, unsigned char c,
+                                                           __art_node *child)
+    {
+        __art_inner *n = inner(*ref);
+        switch (n->type)
+        {
+        case __art_node4_type:
+        {
+            __art_node4 *p = static_cast<__art_node4 *>(n);
+            if (p->count < 4)
+            {
+                int i = p->count;
+                for (; i > 0 && p->keys[i - 1] > c; --i)
+                {
+                    p->keys[i] = p->keys[i - 1];
+                    p->children[i] = p->children[i - 1];
+                }
+                p->keys[i] = c;
+                p->children[i] = child;
+                ++p->count;
+                return;
+            }
+            __art_node16 *q = __new_node<__art_node16, node16_allocator>(__art_node16_type);
+            __copy_header(q, p);
+            std::memcpy(q->keys, p->keys, 4);
+            std::memcpy(q->children, p->children, 4 * sizeof(__art_node *));
+            q->count = 4;
+            node4_allocator::deallocate(p);
+            *ref = q;
+            __add_child(ref, c, child);
+            return;
+        }
+        case __art_node16_type:
+        {
+            __art_node16 *p = static_cast<__art_node16 *>(n);
+            if (p->count < 16)
+            {
+                int i = p->count;
+                for (; i > 0 && p->keys[i - 1] > c; --i)
+                {
+                    p->keys[i] = p->keys[i - 1];
+                    p->children[i] = p->children[i - 1];
+                }
+                p->keys[i] = c;
+                p->children[i] = child;
+                ++p->count;
+                return;
+            }
+            __art_node48 *q = __new_node<__art_node48, node48_allocator>(__art_node48_type);
+            __copy_header(q, p);
+            for (int i = 0; i < 16; ++i)
+            {
+                q->children[i] = p->children[i];
+                q->index[p->keys[i]] = (unsigned char)(i + 1);
+            }
+            q->count = 16;
+            node16_allocator::deallocate(p);
+            *ref = q;
+            __add_child(ref, c, child);
+            return;
+        }
+        case __art_node48_type:
+        {
+            __art_node48 *p = static_cast<__art_node48 *>(n);
+            if (p->count < 48)
+            {
+                int i = 0;
+                while (p->children[i] != 0)
+                    ++i;
+                p->children[i] = child;
+                p->index[c] = (unsigned char)(i + 1);
+                ++p->count;
+                return;
+            }
+            __art_node256 *q = __new_node<__art_node256, node256_allocator>(__art_node256_type);
+            __copy_header(q, p);
+            for (int b = 0; b < 256; ++b)
+                if (p->index[b] != 0)
+                    q->children[b] = p->children[p->index[b] - 1];
+            q->count = 48;
+            node48_allocator::deallocate(p);
+            *ref = q;
+            __add_child(ref, c, child);
+            return;
+        }
+        default:
+        {
+            __art_node256 *p = static_cast<__art_node256 *>(n);
+            p->children[c] = child;
+            ++p->count;
+            return;
+        }
+        }
+    }
+
+    // 自 *ref 所指的内部节点删除键值字节为 c 的子节点；子节点太少时换成小一号的节点
+    template <class Value, class KeyOfValue, class Alloc>
+    void radix_tree<Value, KeyOfValue, Alloc>::__remove_child(__art_node **ref, unsigned char c)
+    {
+        __art_inner *n = inner(*ref);
+        switch (n->type)
+        {
+        case __art_node4_type:
+        case __art_node16_type:
+        {
+            unsigned char *keys;
+            __art_node **children;
+            if (n->type == __art_node4_type)
+            {
+                keys = static_cast<__art_node4 *>(n)->keys;
+                children = static_cast<__art_node4 *>(n)->children;
+            }
+            else
+            {
+                keys = static_cast<__art_node16 *>(n)->keys;
+                children = static_cast<__art_node16 *>(n)->children;
+            }
+            int i = 0;
+            while (keys[i] != c)
+                ++i;
+            for (--n->count; i < n->count; ++i)
+            {
+                keys[i] = keys[i + 1];
+                children[i] = children[i + 1];
+            }
+            if (n->type == __art_node16_type && n->count <= 3)
+            {
+                __art_node4 *q = new_node4();
+                __copy_header(q, n);
+                std::memcpy(q->keys, keys, n->count);
+                std::memcpy(q->children, children, n->count * sizeof(__art_node *));
+                q->count = n->count;
+                node16_allocator::deallocate(static_cast<__art_node16 *>(n));
+                *ref = q;
+            }
+            return;
+        }
+        case __art_node48_type:
+        {
+            __art_node48 *p = static_cast<__art_node48 *>(n);
+            p->children[p->index[c] - 1] = 0;
+            p->index[c] = 0;
+            if (--p->count <= 12)
+            {
+                __art_node16 *q = __new_node<__art_node16, node16_allocator>(__art_node16_type);
+                __copy_header(q, p);
+                for (int b = 0; b < 256; ++b)
+                    if (p->index[b] != 0)
+                    {
+                        q->keys[q->count] = (unsigned char)b;
+                        q->children[q->count++] = p->children[p->index[b] - 1];
+                    }
+                node48_allocator::deallocate(p);
+                *ref = q;
+            }
+            return;
+        }
+        default:
+        {
+            __art_node256 *p = static_cast<__art_node256 *>(n);
+            p->children[c] = 0;
+            if (--p->count <= 37)
+            {
+                __art_node48 *q = __new_node<__art_node48, node48_allocator>(__art_node48_type);
+                __copy_header(q, p);
+                for (int b = 0; b < 256; ++b)
+                    if (p->children[b] != 0)
+                    {
+                        q->children[q->count] = p->children[b];
+                        q->index[b] = (unsigned char)++q->count;
+                    }
+                node256_allocator::deallocate(p);
+                *ref = q;
+            }
+            return;
+        }
+        }
+    }
+
+    // 删除之后，*ref 所指的内部节点（压缩路径自第 depth 个字节开始）若只剩一个元素或一个子节点，
+    // 就以它取代这个节点，保持路径压缩
+    template <class Value, class KeyOfValue, class Alloc>
+    void radix_tree<Value, KeyOfValue, Alloc>::__compact(__art_node **ref, size_t depth)
+    {
+        __art_inner *n = inner(*ref);
+        if (n->count == 0)
+        {
+            *ref = n->term;
+            free_node(n);
+        }
+        else if (n->count == 1 && n->term == 0)
+        {
+            __art_node *child = __art_child_after(n, -1);
+            if (!is_leaf(child))
+            {
+                // 子节点的压缩路径接在本节点的压缩路径与分支字节之后
+                __art_inner *c = inner(child);
+                __set_prefix(c, key(minimum(c)), depth, n->prefix_len + 1 + c->prefix_len);
+            }
+            *ref = child;
+            free_node(n);
+        }
+    }
+
+    template <class Value, class KeyOfValue, class Alloc>
+    void radix_tree<Value, KeyOfValue, Alloc>::__insert_leaf(leaf_ptr z)
+    {
+        const key_type &k = key(z);
+        __art_node **ref = &root;
+        size_t depth = 0;
+        for (;;)
+        {
+            __art_node *x = *ref;
+            if (x == 0)
+            {
+                *ref = z;
+                return;
+            }
+            if (is_leaf(x))
+            {
+                // 两个叶节点自 depth 起的共同部分成为新节点的压缩路径
+                const key_type &ek = key(static_cast<leaf_ptr>(x));
+                size_t i = depth, lim = std::min(ek.size(), k.size());
+                while (i < lim && ek[i] == k[i])
+                    ++i;
+                __art_node *n = new_node4();
+                __set_prefix(inner(n), k, depth, i - depth);
+                if (ek.size() == i)
+                    inner(n)->term = static_cast<leaf_ptr>(x);
+                else
+                    __add_child(&n, ek[i], x);
+                if (k.size() == i)
+                    inner(n)->term = z;
+                else
+                    __add_child(&n, k[i], z);
+                *ref = n;
+                return;
+            }
+            __art_inner *n = inner(x);
+            size_t m = __prefix_match(n, k, depth);
+            if (m < n->prefix_len)
+            {
+                // 压缩路径在第 m 个字节分歧：新节点取走前 m 个字节，原节点保留分歧字节之后的部分
+                const key_type &ok = key(minimum(n));
+                __art_node *p = new_node4();
+                __set_prefix(inner(p), k, depth, m);
+                unsigned char c = ok[depth + m];
+                __set_prefix(n, ok, depth + m + 1, n->prefix_len - m - 1);
+                __add_child(&p, c, n);
+                if (k.size() == depth + m)
+                    inner(p)->term = z;
+                else
+                    __add_child(&p, k[depth + m], z);
+                *ref = p;
+                return;
+            }
+            depth += n->prefix_len;
+            if (depth == k.size())
+            {
+                n->term = z;
+                return;
+            }
+            __art_node **slot = __art_find_child(n, k[depth]);
+            if (slot == 0)
+            {
+                __add_child(ref, k[depth], z);
+                return;
+            }
+            ref = slot;
+            ++depth;
+        }
+    }
+
+    // 把叶节点 z 自树中摘下（不处理叶节点串列）
+    template <class Value, class KeyOfValue, class Alloc>
+    void radix_tree<Value, KeyOfValue, Alloc>::__erase_leaf(leaf_ptr z)
+    {
+        const key_type &k = key(z);
+        __art_node **ref = &root;
+        size_t depth = 0;
+        if (root == z)
+        {
+            root = 0;
+            return;
+        }
+        for (;;)
+        {
+            __art_inner *n = inner(*ref);
+            size_t d = depth + n->prefix_len;
+            if (d == k.size())
+            {
+                n->term = 0;
+                __compact(ref, depth);
+                return;
+            }
+            __art_node **slot = __art_find_child(n, k[d]);
+            if (*slot == z)
+            {
+                __remove_child(ref, k[d]);
+                __compact(ref, depth);
+                return;
+            }
+            ref = slot;
+            depth = d + 1;
+        }
+    }
+
+    template <class Value, class KeyOfValue, class Alloc>
+    typename radix_tree<Value, KeyOfValue, Alloc>::leaf_ptr
+    radix_tree<Value, KeyOfValue, Alloc>::__find(const key_type &k) const
+    {
+        __art_node *x = root;
+        size_t depth = 0;
+        while (x != 0)
+        {
+            if (is_leaf(x))
+            {
+                // 途中的压缩路径都已比较过，只需比较剩下的部分
+                const key_type &lk = key(static_cast<leaf_ptr>(x));
+                if (lk.size() == k.size() &&
+                    std::memcmp(lk.data() + depth, k.data() + depth, k.size() - depth) == 0)
+                    return static_cast<leaf_ptr>(x);
+                return 0;
+            }
+            __art_inner *n = inner(x);
+            if (__prefix_match(n, k, depth) != n->prefix_len)
+                return 0;
+            depth += n->prefix_len;
+            if (depth == k.size())
+                return n->term;
+            __art_node **slot = __art_find_child(n, k[depth]);
+            if (slot == 0)
+                return 0;
+            x = *slot;
+            ++depth;
+        }
+        return 0;
+    }
+
+    // 第一个键值不小于 k 的叶节点：走到 k 分歧的地方，分歧处之后的子树整个大于 k 就取其最小者，
+    // 整个小于 k 就取其最大者的下一个
+    template <class Value, class KeyOfValue, class Alloc>
+    typename radix_tree<Value, KeyOfValue, Alloc>::leaf_ptr
+    radix_tree<Value, KeyOfValue, Alloc>::__lower_bound(const key_type &k) const
+    {
+        __art_node *x = root;
+        size_t depth = 0;
+        if (x == 0)
+            return header;
+        for (;;)
+        {
+            if (is_leaf(x))
+            {
+                leaf_ptr y = static_cast<leaf_ptr>(x);
+                return key(y).compare(k) < 0 ? y->next : y;
+            }
+            __art_inner *n = inner(x);
+            size_t m = __prefix_match(n, k, depth);
+            if (m < n->prefix_len)
+            {
+                if (depth + m == k.size() || (unsigned char)k[depth + m] < __prefix_byte(n, depth, m))
+                    return minimum(n);
+                return maximum(n)->next;
+            }
+            depth += n->prefix_len;
+            if (depth == k.size())
+                return minimum(n);      // term 即 k，子节点都大于 k
+            unsigned char c = k[depth];
+            __art_node **slot = __art_find_child(n, c);
+            if (slot != 0)
+            {
+                x = *slot;
+                ++depth;
+                continue;
+            }
+            __art_node *after = __art_child_after(n, c);
+            return after != 0 ? minimum(after) : maximum(n)->next;
+        }
+    }
+
+    // 所有键值都以 p 开头的最大子树
+    template <class Value, class KeyOfValue, class Alloc>
+    __art_node *radix_tree<Value, KeyOfValue, Alloc>::__prefix_subtree(const key_type &p) const
+    {
+        __art_node *x = root;
+        size_t depth = 0;
+        while (x != 0)
+        {
+            if (depth == p.size())
+                return x;
+            if (is_leaf(x))
+            {
+                const key_type &lk = key(static_cast<leaf_ptr>(x));
+                return lk.size() >= p.size() && lk.compare(0, p.size(), p) == 0 ? x : 0;
+            }
+            __art_inner *n = inner(x);
+            size_t m = __prefix_match(n, p, depth);
+            if (depth + m == p.size())
+                return n;       // p 在压缩路径之中（或恰好在其末端）结束
+            if (m < n->prefix_len)
+                return 0;
+            depth += n->prefix_len;
+            __art_node **slot = __art_find_child(n, p[depth]);
+            if (slot == 0)
+                return 0;
+            x = *slot;
+            ++depth;
+        }
+        return 0;
+    }
+
+    template <class Value, class KeyOfValue, class Alloc>
+    typename radix_tree<Value, KeyOfValue, Alloc>::leaf_ptr
+    radix_tree<Value, KeyOfValue, Alloc>::__longest_prefix(const key_type &k) const
+    {
+        leaf_ptr best = header;
+        __art_node *x = root;
+        size_t depth = 0;
+        while (x != 0)
+        {
+            if (is_leaf(x))
+            {
+                const key_type &lk = key(static_cast<leaf_ptr>(x));
+                if (lk.size() <= k.size() && k.compare(0, lk.size(), lk) == 0)
+                    best = static_cast<leaf_ptr>(x);
+                break;
+            }
+            __art_inner *n = inner(x);
+            if (__prefix_match(n, k, depth) != n->prefix_len)
+                break;
+            depth += n->prefix_len;
+            if (n->term != 0)
+                best = n->term;
+            if (depth == k.size())
+                break;
+            __art_node **slot = __art_find_child(n, k[depth]);
+            if (slot == 0)
+                break;
+            x = *slot;
+            ++depth;
+        }
+        return best;
+    }
+
+    template <class Value, class KeyOfValue, class Alloc>
+    std::pair<typename radix_tree<Value, KeyOfValue, Alloc>::iterator, bool>
+    radix_tree<Value, KeyOfValue, Alloc>::insert_unique(const value_type &v)
+    {
+        // lower_bound 即新元素在叶节点串列中的下一个
+        leaf_ptr next = __lower_bound(KeyOfValue()(v));
+        if (next != header && key(next) == KeyOfValue()(v))
+            return std::pair<iterator, bool>(iterator(next), false);
+        leaf_ptr z = create_leaf(v);
+        __insert_leaf(z);
+        z->next = next;
+        z->prev = next->prev;
+        next->prev->next = z;
+        next->prev = z;
+        ++node_count;
+        return std::pair<iterator, bool>(iterator(z), true);
+    }
+
+    // 先销毁内部节点，再由串列逐一销毁叶节点
+    template <class Value, class KeyOfValue, class Alloc>
+    void radix_tree<Value, KeyOfValue, Alloc>::__destroy(__art_node *x)
+    {
+        // 内部节点的层数不超过最长键值的长度
+        struct free_inner
+        {
+            void operator()(unsigned char, __art_node *c)
+            {
+                if (!is_leaf(c))
+                {
+                    __art_for_each_child(inner(c), *this);
+                    free_node(inner(c));
+                }
+            }
+        } f;
+        f(0, x);
+        for (leaf_ptr y = header->next; y != header; )
+        {
+            leaf_ptr next = y->next;
+            destroy_leaf(y);
+            y = next;
+        }
+    }
+
+    // 复制以 x 为根的子树，复制出的叶节点依键值顺序接到 header 之前
+    template <class Value, class KeyOfValue, class Alloc>
+    __art_node *radix_tree<Value, KeyOfValue, Alloc>::__copy(__art_node *x)
+    {
+        if (is_leaf(x))
+        {
+            leaf_ptr z = create_leaf(static_cast<leaf_type *>(x)->value_field);
+            z->next = header;
+            z->prev = header->prev;
+            header->prev->next = z;
+            header->prev = z;
+            return z;
+        }
+        __art_inner *n = inner(x);
+        __art_inner *y;
+        size_t bytes;
+        switch (n->type)
+        {
+        case __art_node4_type:
+            y = node4_allocator::allocate(); bytes = sizeof(__art_node4); break;
+        case __art_node16_type:
+            y = node16_allocator::allocate(); bytes = sizeof(__art_node16); break;
+        case __art_node48_type:
+            y = node48_allocator::allocate(); bytes = sizeof(__art_node48); break;
+        default:
+            y = node256_allocator::allocate(); bytes = sizeof(__art_node256); break;
+        }
+        std::memcpy(y, n, bytes);
+        if (n->term != 0)
+            y->term = static_cast<leaf_ptr>(__copy(n->term));
+        // 子节点依键值顺序复制，叶节点串列也就依键值顺序接上
+        struct copy_child
+        {
+            radix_tree *tree;
+            __art_inner *to;
+            void operator()(unsigned char c, __art_node *child)
+            {
+                *__art_find_child(to, c) = tree->__copy(child);
+            }
+        } f = {this, y};
+        __art_for_each_child(n, f);
+        return y;
+    }
+
+    template <class Value, class KeyOfValue, class Alloc>
+    radix_tree<Value, KeyOfValue, Alloc> &
+    radix_tree<Value, KeyOfValue, Alloc>::operator=(const radix_tree &x)
+    {
+        if (this != &x)
+        {
+            clear();
+            if (x.root != 0)
+                root = __copy(x.root);
+            node_count = x.node_count;
+        }
+        return *this;
+    }
+}
+#endif
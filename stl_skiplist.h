@@ -0,0 +1,453 @@
+/***
+* 无锁跳表（lock-free skip list）：concurrent_set / concurrent_map 的底层机制。
+* 每个节点有 1 至 max_level 层 next 指针，层数以 1/2 的几率逐层递增，查找期望为 O(log n)。
+* 所有修改都以 CAS 完成，任何线程被挂起都不会阻挡其他线程：
+*   1. 插入：在第 0 层以一次 CAS 接上新节点即告完成（元素自此可见），之后再逐层接上较高的层；
+*   2. 删除：先由上而下把节点每一层的 next 指针标记（最低位设为 1），第 0 层标记成功者即为删除者；
+*      被标记的节点由之后经过的搜索顺手摘除；
+*   3. 查找、遍历只读不写，跳过已标记的节点。
+* 摘下的节点交由 stl_epoch.h 的 epoch 回收机制延后释放：迭代器与每个操作都身处临界区，
+* 它们看得见的节点在它们离开临界区之前不会被释放。
+* 注意：
+*   1. 插入与删除同一个节点可能同时进行，节点须等两者都完成后才能回收，由后完成者负责摘除并回收；
+*   2. size() 只是近似值；迭代器只保证看见遍历期间一直存在的元素；
+*   3. 迭代器持有临界区，不能跨线程使用，也不宜长期保留，否则所有线程的回收都会停滞；
+*   4. 节点可能由任何一个线程释放，故默认的配置器是线程安全的 alloc1。
+*/
+#ifndef _SIMPLE_STL_SKIPLIST_H_
+#define _SIMPLE_STL_SKIPLIST_H_
+
+#include "./stl_iterator.h"
+#include "./memory.h"
+#include "./stl_epoch.h"
+#include <cstddef>
+#include <utility>
+#include <atomic>
+#include <stdint.h>
+
+namespace SimpleSTL
+{
+    enum { __skiplist_max_level = 32 };
+
+    template <class Value>
+    struct __skiplist_node : public __epoch_node
+    {
+        enum { linking = 1, deleted = 2 };
+
+        Value value_field;
+        std::atomic<unsigned> state;    // linking：插入者还在接上较高的层；deleted：已被删除
+        int level;
+        std::atomic<uintptr_t> next[1]; // 实际有 level 层，最低位为删除标记
+
+        static __skiplist_node *ptr(uintptr_t p) { return reinterpret_cast<__skiplist_node *>(p & ~uintptr_t(1)); }
+        static bool marked(uintptr_t p) { return (p & 1) != 0; }
+        static size_t bytes(int level) { return sizeof(__skiplist_node) + (level - 1) * sizeof(std::atomic<uintptr_t>); }
+
+        // 第 0 层之后第一个未被删除的节点
+        __skiplist_node *successor() const
+        {
+            __skiplist_node *x = ptr(next[0].load(std::memory_order_acquire));
+            while (x != 0 && marked(x->next[0].load(std::memory_order_acquire)))
+                x = ptr(x->next[0].load(std::memory_order_acquire));
+            return x;
+        }
+    };
+
+    // 迭代器存在期间一直身处临界区，所指节点即使被删除也不会被释放
+    template <class Value, class Ref, class Ptr>
+    struct __skiplist_iterator
+    {
+        typedef forward_iterator_tag iterator_category;
+        typedef Value value_type;
+        typedef Ref reference;
+        typedef Ptr pointer;
+        typedef ptrdiff_t difference_type;
+        typedef __skiplist_iterator<Value, Ref, Ptr> self;
+        typedef __skiplist_node<Value> *node_ptr;
+
+        node_ptr node;
+        __epoch_guard guard;
+
+        __skiplist_iterator() : node(0) {}
+        explicit __skiplist_iterator(node_ptr x) : node(x) {}
+        __skiplist_iterator(const self &it) : node(it.node), guard(it.guard) {}
+        self &operator=(const self &it)
+        {
+            node = it.node;
+            return *this;
+        }
+
+        reference operator*() const { return node->value_field; }
+        pointer operator->() const { return &(operator*()); }
+
+        self &operator++()
+        {
+            node = node->successor();
+            return *this;
+        }
+        self operator++(int)
+        {
+            self tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const self &x) const { return node == x.node; }
+        bool operator!=(const self &x) const { return node != x.node; }
+    };
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc = alloc1>
+    class concurrent_skiplist
+    {
+    public:
+        typedef Key key_type;
+        typedef Value value_type;
+        typedef value_type *pointer;
+        typedef const value_type *const_pointer;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        // 其他线程可能同时读取元素，不能经由迭代器修改，iterator 与 const_iterator 同为常量迭代器
+        typedef __skiplist_iterator<value_type, const_reference, const_pointer> const_iterator;
+        typedef const_iterator iterator;
+
+    protected:
+        typedef __skiplist_node<Value> node_type;
+        typedef node_type *link_type;
+        enum { max_level = __skiplist_max_level };
+
+        link_type head;     // 哨兵节点，有 max_level 层，不含实值
+        std::atomic<difference_type> node_count;   // 删除可能先于插入者计数，暂时为负
+        Compare key_compare;
+
+        static const Key &key(link_type x) { return KeyOfValue()(x->value_field); }
+        static link_type ptr(uintptr_t p) { return node_type::ptr(p); }
+        static bool marked(uintptr_t p) { return node_type::marked(p); }
+
+        static link_type allocate_node(int level)
+        {
+            link_type x = static_cast<link_type>(Alloc::allocate(node_type::bytes(level)));
+            new (&x->state) std::atomic<unsigned>(node_type::linking);
+            x->level = level;
+            for (int i = 0; i < level; ++i)
+                new (&x->next[i]) std::atomic<uintptr_t>(0);
+            x->reclaim = &reclaim_node;
+            return x;
+        }
+        static void deallocate_node(link_type x) { Alloc::deallocate(x, node_type::bytes(x->level)); }
+        static link_type create_node(const value_type &v, int level)
+        {
+            link_type x = allocate_node(level);
+            try
+            {
+                construct(&x->value_field, v);
+            }
+            catch (...)
+            {
+                deallocate_node(x);
+                throw;
+            }
+            return x;
+        }
+        static void destroy_node(link_type x)
+        {
+            destroy(&x->value_field);
+            deallocate_node(x);
+        }
+        // 由 epoch 回收机制调用，此时容器本身可能已不存在
+        static void reclaim_node(__epoch_node *n) { destroy_node(static_cast<link_type>(n)); }
+
+        // 层数 l 的几率为 2^-l，以每个线程各自的 xorshift 产生
+        static int random_level()
+        {
+            static thread_local unsigned long long seed = 0;
+            if (seed == 0)
+                seed = reinterpret_cast<uintptr_t>(&seed) * 0x9E3779B97F4A7C15ULL | 1;
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            return 1 + __builtin_ctzll(seed | (1ULL << (max_level - 1)));
+        }
+
+        bool __search(const key_type &k, link_type *preds, link_type *succs, link_type target);
+        link_type __lower_bound(const key_type &k) const;
+        link_type __upper_bound(const key_type &k) const;
+        void __retire(link_type x, __epoch_guard &g);
+
+    public:
+        explicit concurrent_skiplist(const Compare &comp = Compare())
+            : head(allocate_node(max_level)), node_count(0), key_compare(comp) {}
+        ~concurrent_skiplist();
+
+        Compare key_comp() const { return key_compare; }
+        const_iterator begin() const
+        {
+            const_iterator it;
+            it.node = head->successor();
+            return it;
+        }
+        const_iterator end() const { return const_iterator(); }
+        bool empty() const { return begin() == end(); }
+        size_type size() const
+        {
+            difference_type n = node_count.load(std::memory_order_relaxed);
+            return n < 0 ? 0 : size_type(n);
+        }
+        size_type max_size() const { return size_type(-1); }
+
+        std::pair<iterator, bool> insert_unique(const value_type &v);
+        template <class InputIterator>
+        void insert_unique(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first)
+                insert_unique(*first);
+        }
+
+        size_type erase(const key_type &k);
+        void erase(iterator position) { erase(key(position.node)); }
+        void clear();
+
+        const_iterator find(const key_type &k) const
+        {
+            const_iterator it;
+            link_type x = __lower_bound(k);
+            if (x != 0 && !key_compare(k, key(x)))
+                it.node = x;
+            return it;
+        }
+        size_type count(const key_type &k) const { return find(k) == end() ? 0 : 1; }
+        const_iterator lower_bound(const key_type &k) const
+        {
+            const_iterator it;
+            it.node = __lower_bound(k);
+            return it;
+        }
+        const_iterator upper_bound(const key_type &k) const
+        {
+            const_iterator it;
+            it.node = __upper_bound(k);
+            return it;
+        }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const
+        {
+            return std::pair<const_iterator, const_iterator>(lower_bound(k), upper_bound(k));
+        }
+
+    private:
+        concurrent_skiplist(const concurrent_skiplist &);
+        concurrent_skiplist &operator=(const concurrent_skiplist &);
+    };
+
+    // 在每一层找出 k 的前驱与后继，沿途摘除已标记的节点；若摘除时前驱已变，从头再来。
+    // target 不为 0 时，越过键值相等但不是 target 的节点，确保 target 若仍在某一层上必定被摘除
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    bool concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::
+        __search(const key_type &k, link_type *preds, link_type *succs, link_type target)
+    {
+    retry:
+        link_type pred = head;
+        for (int i = max_level - 1; i >= 0; --i)
+        {
+            link_type curr = ptr(pred->next[i].load(std::memory_order_acquire));
+            while (curr != 0)
+            {
+                uintptr_t succ = curr->next[i].load(std::memory_order_acquire);
+                if (marked(succ))
+                {
+                    uintptr_t expected = reinterpret_cast<uintptr_t>(curr);
+                    if (!pred->next[i].compare_exchange_strong(expected, succ & ~uintptr_t(1),
+                                                               std::memory_order_acq_rel))
+                        goto retry;
+                    curr = ptr(succ);
+                    continue;
+                }
+                if (key_compare(key(curr), k) ||
+                    (target != 0 && curr != target && !key_compare(k, key(curr))))
+                {
+                    pred = curr;
+                    curr = ptr(succ);
+                }
+                else
+                    break;
+            }
+            preds[i] = pred;
+            succs[i] = curr;
+        }
+        return succs[0] != 0 && !key_compare(k, key(succs[0]));
+    }
+
+    // 只读的查找：跳过已标记的节点，不摘除
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+    concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::__lower_bound(const key_type &k) const
+    {
+        __epoch_guard g;
+        link_type pred = head, curr = 0;
+        for (int i = max_level - 1; i >= 0; --i)
+        {
+            curr = ptr(pred->next[i].load(std::memory_order_acquire));
+            while (curr != 0)
+            {
+                uintptr_t succ = curr->next[i].load(std::memory_order_acquire);
+                if (marked(succ))
+                    curr = ptr(succ);
+                else if (key_compare(key(curr), k))
+                {
+                    pred = curr;
+                    curr = ptr(succ);
+                }
+                else
+                    break;
+            }
+        }
+        return curr;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::link_type
+    concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::__upper_bound(const key_type &k) const
+    {
+        __epoch_guard g;
+        link_type pred = head, curr = 0;
+        for (int i = max_level - 1; i >= 0; --i)
+        {
+            curr = ptr(pred->next[i].load(std::memory_order_acquire));
+            while (curr != 0)
+            {
+                uintptr_t succ = curr->next[i].load(std::memory_order_acquire);
+                if (marked(succ))
+                    curr = ptr(succ);
+                else if (!key_compare(k, key(curr)))
+                {
+                    pred = curr;
+                    curr = ptr(succ);
+                }
+                else
+                    break;
+            }
+        }
+        return curr;
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    std::pair<typename concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::iterator, bool>
+    concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(const value_type &v)
+    {
+        __epoch_guard g;
+        const key_type &k = KeyOfValue()(v);
+        link_type preds[max_level], succs[max_level];
+        link_type x = 0;
+        int level = 0;
+        iterator it;
+        for (;;)
+        {
+            if (__search(k, preds, succs, 0))
+            {
+                if (x != 0)
+                    destroy_node(x);    // 尚未公开，直接释放
+                it.node = succs[0];
+                return std::pair<iterator, bool>(it, false);
+            }
+            if (x == 0)
+            {
+                level = random_level();
+                x = create_node(v, level);
+            }
+            for (int i = 0; i < level; ++i)
+                x->next[i].store(reinterpret_cast<uintptr_t>(succs[i]), std::memory_order_relaxed);
+            uintptr_t expected = reinterpret_cast<uintptr_t>(succs[0]);
+            if (preds[0]->next[0].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(x),
+                                                          std::memory_order_acq_rel))
+                break;
+        }
+        node_count.fetch_add(1, std::memory_order_relaxed);
+        it.node = x;
+
+        // 逐层接上较高的层；节点若已被删除（较高层已标记）就不再接
+        const key_type &xk = key(x);
+        for (int i = 1; i < level; ++i)
+        {
+            for (;;)
+            {
+                uintptr_t cur = x->next[i].load(std::memory_order_acquire);
+                uintptr_t succ = reinterpret_cast<uintptr_t>(succs[i]);
+                if (marked(cur) ||
+                    (cur != succ && !x->next[i].compare_exchange_strong(cur, succ, std::memory_order_acq_rel)))
+                    goto done;  // 只有删除者会改动 x->next[i]，CAS 失败即表示已被标记
+                uintptr_t expected = succ;
+                if (preds[i]->next[i].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(x),
+                                                              std::memory_order_acq_rel))
+                    break;
+                __search(xk, preds, succs, x);
+            }
+        }
+    done:
+        if (x->state.fetch_and(~unsigned(node_type::linking), std::memory_order_acq_rel) & node_type::deleted)
+            __retire(x, g);     // 接层期间已被删除，由插入者负责回收
+        return std::pair<iterator, bool>(it, true);
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    typename concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::size_type
+    concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::erase(const key_type &k)
+    {
+        __epoch_guard g;
+        link_type preds[max_level], succs[max_level];
+        if (!__search(k, preds, succs, 0))
+            return 0;
+        link_type x = succs[0];
+        for (int i = x->level - 1; i > 0; --i)
+        {
+            uintptr_t s = x->next[i].load(std::memory_order_acquire);
+            while (!marked(s) && !x->next[i].compare_exchange_weak(s, s | 1, std::memory_order_acq_rel))
+                ;
+        }
+        uintptr_t s = x->next[0].load(std::memory_order_acquire);
+        for (;;)
+        {
+            if (marked(s))
+                return 0;   // 另一个线程先删除了它
+            if (x->next[0].compare_exchange_weak(s, s | 1, std::memory_order_acq_rel))
+                break;
+        }
+        node_count.fetch_sub(1, std::memory_order_relaxed);
+        if (!(x->state.fetch_or(node_type::deleted, std::memory_order_acq_rel) & node_type::linking))
+            __retire(x, g);     // 插入者已接完各层，由删除者负责回收
+        return 1;
+    }
+
+    // x 已在每一层标记，且不会再被接上任何一层：自每一层摘除后交给 epoch 回收
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::__retire(link_type x, __epoch_guard &g)
+    {
+        link_type preds[max_level], succs[max_level];
+        __search(key(x), preds, succs, x);
+        g.retire(x);
+    }
+
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    void concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::clear()
+    {
+        __epoch_guard g;
+        for (link_type x = head->successor(); x != 0; x = head->successor())
+            erase(key(x));
+    }
+
+    // 析构时不得再有其他线程存取容器，仍在串列上的节点直接释放
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+    concurrent_skiplist<Key, Value, KeyOfValue, Compare, Alloc>::~concurrent_skiplist()
+    {
+        link_type x = ptr(head->next[0].load(std::memory_order_acquire));
+        while (x != 0)
+        {
+            link_type next = ptr(x->next[0].load(std::memory_order_relaxed));
+            destroy_node(x);
+            x = next;
+        }
+        deallocate_node(head);
+        __epoch_manager::quiesce(__epoch_local());  // 顺便释放本线程已摘下的节点
+    }
+}
+#endif
@@ -4,7 +4,13 @@
 #include "./stl_iterator.h"
 #include "./memory.h"
 #include <cstddef>
+#include <cstdlib>
+#include <stdint.h>
+#include <new>
 #include <utility>
+#include <future>
+#include <mutex>
+#include <type_traits>
 
 namespace SimpleSTL
 {
@@ -15,6 +21,7 @@ namespace SimpleSTL
     struct __rb_tree_node_base
     {
         typedef __rb_tree_color_type color_type;
+        typedef __rb_tree_node_base base_type;
         typedef __rb_tree_node_base *base_ptr;
 
         color_type color;
@@ -37,17 +44,696 @@ namespace SimpleSTL
         }
     };
 
+    // 节点的连结与颜色一律经由 __rb_left / __rb_right / __rb_parent / __rb_color 存取，
+    // 全局函数与 rb_tree 因此不必知道节点的实际布局。一般的节点直接传回成员的引用；
+    // 紧凑的节点（见下）把颜色藏在连结里，传回的是可读可写的代理对象
+    inline __rb_tree_node_base *&__rb_left(__rb_tree_node_base *x) { return x->left; }
+    inline __rb_tree_node_base *&__rb_right(__rb_tree_node_base *x) { return x->right; }
+    inline __rb_tree_node_base *&__rb_parent(__rb_tree_node_base *x) { return x->parent; }
+    inline __rb_tree_color_type &__rb_color(__rb_tree_node_base *x) { return x->color; }
+
+    // 节点增强（augmentation）的回调：依据 x 的左右子节点，重新计算 x 上附加的数据
+    // 树形改变（插入、删除、旋转）时由全局函数调用；为 0 表示节点没有附加数据
+    template <class Base>
+    struct __rb_tree_update
+    {
+        typedef void (*fn)(Base *x);
+    };
+    typedef __rb_tree_update<__rb_tree_node_base>::fn __rb_tree_update_fn;
+
     template <class Value>
     struct __rb_tree_node : public __rb_tree_node_base
     {
         typedef __rb_tree_node<Value> *link_type;
         Value value_field; // 节点值
+
+        static __rb_tree_update_fn update_fn() { return 0; }
+    };
+
+    // 带有子树大小的节点（order statistic tree），使 rank / select 只需 O(log n)
+    // 用法：rb_tree<..., Alloc, __rb_tree_os_node>，或 set<Key, Compare, Alloc, __rb_tree_os_node>
+    template <class Value>
+    struct __rb_tree_os_node : public __rb_tree_node<Value>
+    {
+        typedef __rb_tree_os_node<Value> *link_type;
+        size_t subtree_size;    // 以本节点为根的子树的节点数
+
+        static size_t size_of(__rb_tree_node_base *x)
+        {
+            return x == 0 ? 0 : static_cast<link_type>(x)->subtree_size;
+        }
+        static void update(__rb_tree_node_base *x)
+        {
+            static_cast<link_type>(x)->subtree_size = size_of(x->left) + size_of(x->right) + 1;
+        }
+        static __rb_tree_update_fn update_fn() { return &update; }
+    };
+
+    /************************ 紧凑节点 ************************/
+    enum { __rb_tree_left_link, __rb_tree_right_link, __rb_tree_parent_link };
+
+    // 代理对象：读写节点 x 的某个连结。Base 须提供 get_link(x, link) / set_link(x, link, y)
+    template <class Base, int Link>
+    struct __rb_tree_link_proxy
+    {
+        typedef Base *base_ptr;
+        base_ptr x;
+
+        explicit __rb_tree_link_proxy(base_ptr n) : x(n) {}
+        operator base_ptr() const { return Base::get_link(x, Link); }
+        __rb_tree_link_proxy &operator=(base_ptr y)
+        {
+            Base::set_link(x, Link, y);
+            return *this;
+        }
+        __rb_tree_link_proxy &operator=(const __rb_tree_link_proxy &p) { return *this = base_ptr(p); }
+    };
+
+    // 代理对象：读写节点 x 的颜色。Base 须提供 get_color(x) / set_color(x, c)
+    template <class Base>
+    struct __rb_tree_color_proxy
+    {
+        typedef Base *base_ptr;
+        base_ptr x;
+
+        explicit __rb_tree_color_proxy(base_ptr n) : x(n) {}
+        operator __rb_tree_color_type() const { return Base::get_color(x); }
+        __rb_tree_color_proxy &operator=(__rb_tree_color_type c)
+        {
+            Base::set_color(x, c);
+            return *this;
+        }
+        __rb_tree_color_proxy &operator=(const __rb_tree_color_proxy &p)
+        {
+            return *this = __rb_tree_color_type(p);
+        }
+    };
+
+    // 颜色存放在父节点指针的最低位（节点至少按指针对齐，最低位原本恒为 0），
+    // 每个节点省下 8 字节：set<int> 的节点由 40 字节降为 32 字节。
+    // 用法：set<Key, Compare, Alloc, __rb_tree_compact_node>
+    struct __rb_tree_compact_node_base
+    {
+        typedef __rb_tree_color_type color_type;
+        typedef __rb_tree_compact_node_base base_type;
+        typedef __rb_tree_compact_node_base *base_ptr;
+
+        uintptr_t parent_and_color;
+        base_ptr left;
+        base_ptr right;
+
+        // 只有父节点的连结需要代理
+        static base_ptr get_link(const base_type *x, int)
+        {
+            return reinterpret_cast<base_ptr>(x->parent_and_color & ~uintptr_t(1));
+        }
+        static void set_link(base_type *x, int, base_ptr p)
+        {
+            x->parent_and_color = reinterpret_cast<uintptr_t>(p) | (x->parent_and_color & 1);
+        }
+        static color_type get_color(const base_type *x) { return (x->parent_and_color & 1) != 0; }
+        static void set_color(base_type *x, color_type c)
+        {
+            x->parent_and_color = (x->parent_and_color & ~uintptr_t(1)) | uintptr_t(c);
+        }
+    };
+
+    inline __rb_tree_compact_node_base *&__rb_left(__rb_tree_compact_node_base *x) { return x->left; }
+    inline __rb_tree_compact_node_base *&__rb_right(__rb_tree_compact_node_base *x) { return x->right; }
+    inline __rb_tree_link_proxy<__rb_tree_compact_node_base, __rb_tree_parent_link>
+    __rb_parent(__rb_tree_compact_node_base *x)
+    {
+        return __rb_tree_link_proxy<__rb_tree_compact_node_base, __rb_tree_parent_link>(x);
+    }
+    inline __rb_tree_color_proxy<__rb_tree_compact_node_base> __rb_color(__rb_tree_compact_node_base *x)
+    {
+        return __rb_tree_color_proxy<__rb_tree_compact_node_base>(x);
+    }
+
+    template <class Value>
+    struct __rb_tree_compact_node : public __rb_tree_compact_node_base
+    {
+        typedef __rb_tree_compact_node<Value> *link_type;
+        Value value_field;
+
+        static __rb_tree_update<__rb_tree_compact_node_base>::fn update_fn() { return 0; }
+    };
+
+    /************************ 32 位序号连结的节点 ************************/
+    template <size_t N, size_t P = 1, bool = (P >= N)>
+    struct __rb_tree_pow2_ceil
+    {
+        static const size_t value = __rb_tree_pow2_ceil<N, P * 2>::value;
+    };
+    template <size_t N, size_t P>
+    struct __rb_tree_pow2_ceil<N, P, true>
+    {
+        static const size_t value = P;
+    };
+
+    // 序号节点的配置器：同一种节点共用一个节点池，序号 0 代表空节点。
+    // 节点池由区块组成，每个区块 chunk_slots 个节点，按区块大小向上取 2 的幂对齐，
+    // 于是由节点地址即可算出区块起点。区块的第 0 个位置存放区块编号（也使序号 0 不对应任何节点）。
+    // 节点池必须是全域的：连结只有 32 位序号，由节点找到相邻节点时没有树可以查询，
+    // split / join 等集合运算也会把节点移到另一棵树。因此有以下限制：
+    //   同一种节点（跨所有的树）至多约 2^31 个，超过时 allocate 抛出 bad_alloc；
+    //   释放的节点留在空闲串列中，直到这种节点全部释放（所有这种树都已清空、解构）才把区块归还给系统。
+    // 配置与释放以一把锁保护，不同线程可以各自使用不相干的树。区块目录分两层且只增不减，
+    // 已配置的区块地址永远不变，address() 不必加锁
+    template <class Node>
+    class __rb_tree_index_pool
+    {
+    public:
+        enum { chunk_shift = 12, chunk_slots = 1 << chunk_shift };
+        enum { max_chunks = (size_t(1) << 31) >> chunk_shift };     // 序号须放得进 31 位
+        enum { dir_shift = 10, dir_slots = 1 << dir_shift };        // 第二层目录每块记录 dir_slots 个区块
+        static const size_t chunk_bytes = chunk_slots * sizeof(Node);
+        static const size_t chunk_align = __rb_tree_pow2_ceil<chunk_bytes>::value;
+
+        static Node *address(uint32_t i)
+        {
+            if (i == 0)
+                return 0;
+            const uint32_t c = i >> chunk_shift;
+            return reinterpret_cast<Node *>(directory[c >> dir_shift][c & (dir_slots - 1)]
+                                            + (i & (chunk_slots - 1)) * sizeof(Node));
+        }
+        static uint32_t index(const Node *p)
+        {
+            if (p == 0)
+                return 0;
+            uintptr_t start = reinterpret_cast<uintptr_t>(p) & ~uintptr_t(chunk_align - 1);
+            uint32_t id = *reinterpret_cast<const uint32_t *>(start);
+            return (id << chunk_shift) | uint32_t((reinterpret_cast<uintptr_t>(p) - start) / sizeof(Node));
+        }
+
+        static Node *allocate()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            ++live;
+            if (free_list != 0)
+            {
+                Node *p = address(free_list);
+                free_list = *reinterpret_cast<uint32_t *>(p);
+                return p;
+            }
+            if ((next_index & (chunk_slots - 1)) == 0)
+            {
+                try {
+                    new_chunk();
+                }
+                catch (...) {
+                    --live;
+                    throw;
+                }
+            }
+            return address(next_index++);
+        }
+        static void deallocate(Node *p)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            *reinterpret_cast<uint32_t *>(p) = free_list;
+            free_list = index(p);
+            if (--live == 0)
+                release_chunks();
+        }
+
+    private:
+        static void new_chunk()
+        {
+            size_t id = next_index >> chunk_shift;
+            if (id >= size_t(max_chunks))
+                throw std::bad_alloc();
+            char **&dir = directory[id >> dir_shift];
+            if (dir == 0)
+            {
+                dir = static_cast<char **>(calloc(dir_slots, sizeof(char *)));
+                if (dir == 0)
+                    throw std::bad_alloc();
+            }
+            void *mem = 0;
+            if (posix_memalign(&mem, chunk_align < sizeof(void *) ? sizeof(void *) : chunk_align,
+                               chunk_bytes) != 0)
+                throw std::bad_alloc();
+            *static_cast<uint32_t *>(mem) = uint32_t(id);
+            dir[id & (dir_slots - 1)] = static_cast<char *>(mem);
+            next_index = uint32_t(id << chunk_shift) | 1;   // 第 0 个位置是区块编号
+        }
+
+        // 已没有任何节点：归还全部区块，序号从头开始。目录的第二层留着，下次直接沿用
+        static void release_chunks()
+        {
+            const size_t used = (size_t(next_index) + chunk_slots - 1) >> chunk_shift;
+            for (size_t id = 0; id < used; ++id)
+            {
+                char *&chunk = directory[id >> dir_shift][id & (dir_slots - 1)];
+                free(chunk);
+                chunk = 0;
+            }
+            free_list = 0;
+            next_index = 0;
+        }
+
+        static char **directory[max_chunks >> dir_shift];
+        static std::mutex lock;
+        static size_t live;             // 已配置而尚未释放的节点数
+        static uint32_t free_list;      // 空闲节点串列：节点的前 4 字节存放下一个空闲节点的序号
+        static uint32_t next_index;     // 尚未用过的下一个序号
+    };
+
+    template <class Node> char **__rb_tree_index_pool<Node>::directory[max_chunks >> dir_shift];
+    template <class Node> std::mutex __rb_tree_index_pool<Node>::lock;
+    template <class Node> size_t __rb_tree_index_pool<Node>::live = 0;
+    template <class Node> uint32_t __rb_tree_index_pool<Node>::free_list = 0;
+    template <class Node> uint32_t __rb_tree_index_pool<Node>::next_index = 0;
+
+    // 三个连结都以 32 位序号表示，父节点序号与颜色共用一个字，节点只有 12 字节再加上值：
+    // set<int> 的节点只有 16 字节。同一种节点至多 2^31 - 4096 个（由节点池统一配置）。
+    // 用法：set<Key, Compare, Alloc, __rb_tree_index_node>（此时 Alloc 不起作用）
+    template <class Node>
+    struct __rb_tree_index_node_base
+    {
+        typedef __rb_tree_color_type color_type;
+        typedef __rb_tree_index_node_base base_type;
+        typedef __rb_tree_index_node_base *base_ptr;
+        typedef __rb_tree_index_pool<Node> pool;
+
+        uint32_t parent_and_color;      // 父节点序号 << 1 | 颜色
+        uint32_t left_index;
+        uint32_t right_index;
+
+        static base_ptr get_link(const base_type *x, int link)
+        {
+            uint32_t i = link == __rb_tree_left_link ? x->left_index
+                       : link == __rb_tree_right_link ? x->right_index
+                       : x->parent_and_color >> 1;
+            return pool::address(i);
+        }
+        static void set_link(base_type *x, int link, base_ptr y)
+        {
+            uint32_t i = pool::index(static_cast<Node *>(y));
+            if (link == __rb_tree_left_link)
+                x->left_index = i;
+            else if (link == __rb_tree_right_link)
+                x->right_index = i;
+            else
+                x->parent_and_color = (i << 1) | (x->parent_and_color & 1);
+        }
+        static color_type get_color(const base_type *x) { return (x->parent_and_color & 1) != 0; }
+        static void set_color(base_type *x, color_type c)
+        {
+            x->parent_and_color = (x->parent_and_color & ~uint32_t(1)) | uint32_t(c);
+        }
+    };
+
+    template <class Node>
+    inline __rb_tree_link_proxy<__rb_tree_index_node_base<Node>, __rb_tree_left_link>
+    __rb_left(__rb_tree_index_node_base<Node> *x)
+    {
+        return __rb_tree_link_proxy<__rb_tree_index_node_base<Node>, __rb_tree_left_link>(x);
+    }
+    template <class Node>
+    inline __rb_tree_link_proxy<__rb_tree_index_node_base<Node>, __rb_tree_right_link>
+    __rb_right(__rb_tree_index_node_base<Node> *x)
+    {
+        return __rb_tree_link_proxy<__rb_tree_index_node_base<Node>, __rb_tree_right_link>(x);
+    }
+    template <class Node>
+    inline __rb_tree_link_proxy<__rb_tree_index_node_base<Node>, __rb_tree_parent_link>
+    __rb_parent(__rb_tree_index_node_base<Node> *x)
+    {
+        return __rb_tree_link_proxy<__rb_tree_index_node_base<Node>, __rb_tree_parent_link>(x);
+    }
+    template <class Node>
+    inline __rb_tree_color_proxy<__rb_tree_index_node_base<Node> >
+    __rb_color(__rb_tree_index_node_base<Node> *x)
+    {
+        return __rb_tree_color_proxy<__rb_tree_index_node_base<Node> >(x);
+    }
+
+    // 代理对象本身也可以作为参数，以便写出 __rb_left(__rb_parent(x)) 这样的连续存取
+    template <class Base, int Link>
+    inline typename __rb_tree_link_proxy<Base, Link>::base_ptr
+    __rb_link_target(const __rb_tree_link_proxy<Base, Link> &p) { return p; }
+    template <class Base, int Link>
+    inline auto __rb_left(const __rb_tree_link_proxy<Base, Link> &p) -> decltype(__rb_left(__rb_link_target(p)))
+    {
+        return __rb_left(__rb_link_target(p));
+    }
+    template <class Base, int Link>
+    inline auto __rb_right(const __rb_tree_link_proxy<Base, Link> &p) -> decltype(__rb_right(__rb_link_target(p)))
+    {
+        return __rb_right(__rb_link_target(p));
+    }
+    template <class Base, int Link>
+    inline auto __rb_parent(const __rb_tree_link_proxy<Base, Link> &p) -> decltype(__rb_parent(__rb_link_target(p)))
+    {
+        return __rb_parent(__rb_link_target(p));
+    }
+    template <class Base, int Link>
+    inline auto __rb_color(const __rb_tree_link_proxy<Base, Link> &p) -> decltype(__rb_color(__rb_link_target(p)))
+    {
+        return __rb_color(__rb_link_target(p));
+    }
+
+    template <class Value>
+    struct __rb_tree_index_node : public __rb_tree_index_node_base<__rb_tree_index_node<Value> >
+    {
+        typedef __rb_tree_index_node<Value> *link_type;
+        typedef __rb_tree_index_node_base<__rb_tree_index_node<Value> > base_type;
+        Value value_field;
+
+        static typename __rb_tree_update<base_type>::fn update_fn() { return 0; }
+    };
+
+    // 每棵树专属的节点池：节点取自成批配置的区块（slab），区块逐次加倍，至多 max_slab_nodes 个节点。
+    // 释放的节点挂在空闲串列上；清空整棵树时，若节点池只属于这棵树，便整批归还所有区块而不逐一释放，
+    // 值的型别有 trivial destructor 时连遍历都省了。split / join / merge_from 会在树之间搬移节点，
+    // 这时两棵树的节点池合而为一、由两者共用。和 alloc2 一样，不是线程安全的
+    // 用法：set<Key, Compare, __rb_tree_pool_alloc<Alloc> >，区块以 Alloc 配置
+    template <class Alloc = alloc2>
+    struct __rb_tree_pool_alloc {};
+
+    template <class Node, class Alloc>
+    class __rb_tree_node_pool
+    {
+    public:
+        enum { first_slab_nodes = 16, max_slab_nodes = 8192 };
+
+        __rb_tree_node_pool() : rep(0) {}
+        __rb_tree_node_pool(const __rb_tree_node_pool &) : rep(0) {}    // 复制出来的树另起节点池
+        __rb_tree_node_pool &operator=(const __rb_tree_node_pool &) { return *this; }
+        ~__rb_tree_node_pool()
+        {
+            if (rep != 0)
+                drop(rep);
+        }
+
+        Node *allocate()
+        {
+            pool_rep *r = get();
+            if (r->free_list != 0)
+            {
+                free_node *p = r->free_list;
+                if ((r->free_list = p->next) == 0)
+                    r->free_tail = 0;
+                return reinterpret_cast<Node *>(p);
+            }
+            if (r->cur == r->end)
+                new_slab(r);
+            Node *p = reinterpret_cast<Node *>(r->cur);
+            r->cur += sizeof(Node);
+            return p;
+        }
+        void deallocate(Node *p)
+        {
+            push_free(get(), reinterpret_cast<free_node *>(p));
+        }
+
+        // 节点池是否只属于这一棵树（只有这时才能整批归还区块）
+        bool exclusive() { return rep == 0 || get()->refs == 1; }
+        // 归还所有区块，调用者须保证其中已没有活着的节点
+        void release()
+        {
+            if (rep != 0)
+                free_slabs(get());
+        }
+        void swap(__rb_tree_node_pool &x) { std::swap(rep, x.rep); }
+
+        // 把 x 的节点池并入本节点池，此后两者（以及原先共用 x 节点池的树）共用同一个节点池
+        void share(__rb_tree_node_pool &x)
+        {
+            pool_rep *a = get(), *b = x.get();
+            if (a == b)
+                return;
+            if (b->slabs != 0)
+            {
+                b->slab_tail->next = a->slabs;
+                a->slabs = b->slabs;
+                if (a->slab_tail == 0)
+                    a->slab_tail = b->slab_tail;
+            }
+            if (b->free_list != 0)
+            {
+                b->free_tail->next = a->free_list;
+                a->free_list = b->free_list;
+                if (a->free_tail == 0)
+                    a->free_tail = b->free_tail;
+            }
+            for (; b->cur != b->end; b->cur += sizeof(Node))    // b 区块中尚未用过的部分
+                push_free(a, reinterpret_cast<free_node *>(b->cur));
+            b->slabs = b->slab_tail = 0;
+            b->free_list = b->free_tail = 0;
+            b->forward = a;         // 其他仍指向 b 的树，下次存取时转向 a
+            ++a->refs;
+            x.get();
+        }
+
+    private:
+        struct slab
+        {
+            slab *next;
+            size_t bytes;
+        };
+        struct free_node
+        {
+            free_node *next;
+        };
+        struct pool_rep
+        {
+            slab *slabs, *slab_tail;
+            free_node *free_list, *free_tail;
+            char *cur, *end;            // 目前区块中尚未用过的部分
+            size_t next_slab_nodes;
+            size_t refs;                // 共用者的个数（包括转向本节点池的 pool_rep）
+            pool_rep *forward;          // 已并入的节点池
+        };
+        typedef simple_alloc<pool_rep, Alloc> rep_allocator;
+        enum { slab_header = (sizeof(slab) + alignof(Node) - 1) / alignof(Node) * alignof(Node) };
+
+        pool_rep *get()
+        {
+            if (rep == 0)
+            {
+                rep = rep_allocator::allocate();
+                rep->slabs = rep->slab_tail = 0;
+                rep->free_list = rep->free_tail = 0;
+                rep->cur = rep->end = 0;
+                rep->next_slab_nodes = first_slab_nodes;
+                rep->refs = 1;
+                rep->forward = 0;
+            }
+            while (rep->forward != 0)
+            {
+                pool_rep *f = rep->forward;
+                ++f->refs;
+                drop(rep);
+                rep = f;
+            }
+            return rep;
+        }
+        static void drop(pool_rep *r)
+        {
+            while (r != 0 && --r->refs == 0)
+            {
+                pool_rep *f = r->forward;
+                free_slabs(r);
+                rep_allocator::deallocate(r);
+                r = f;
+            }
+        }
+        static void push_free(pool_rep *r, free_node *p)
+        {
+            p->next = r->free_list;
+            if (r->free_list == 0)
+                r->free_tail = p;
+            r->free_list = p;
+        }
+        static void new_slab(pool_rep *r)
+        {
+            size_t n = r->next_slab_nodes;
+            size_t bytes = slab_header + n * sizeof(Node);
+            char *mem = static_cast<char *>(Alloc::allocate(bytes));
+            slab *s = reinterpret_cast<slab *>(mem);
+            s->bytes = bytes;
+            s->next = r->slabs;
+            if (r->slabs == 0)
+                r->slab_tail = s;
+            r->slabs = s;
+            r->cur = mem + slab_header;
+            r->end = r->cur + n * sizeof(Node);
+            if (n < size_t(max_slab_nodes))
+                r->next_slab_nodes = n * 2;
+        }
+        static void free_slabs(pool_rep *r)
+        {
+            for (slab *s = r->slabs; s != 0; )
+            {
+                slab *next = s->next;
+                Alloc::deallocate(s, s->bytes);
+                s = next;
+            }
+            r->slabs = r->slab_tail = 0;
+            r->free_list = r->free_tail = 0;
+            r->cur = r->end = 0;
+        }
+
+        pool_rep *rep;      // 第一次配置节点时才产生
+    };
+
+    // 以下几个函数让 rb_tree 不必区分节点池与一般的配置器
+    template <class A>
+    inline bool __rb_tree_pool_exclusive(A &) { return false; }
+    template <class Node, class Alloc>
+    inline bool __rb_tree_pool_exclusive(__rb_tree_node_pool<Node, Alloc> &p) { return p.exclusive(); }
+    template <class A>
+    inline void __rb_tree_pool_release(A &) {}
+    template <class Node, class Alloc>
+    inline void __rb_tree_pool_release(__rb_tree_node_pool<Node, Alloc> &p) { p.release(); }
+    template <class A>
+    inline void __rb_tree_pool_swap(A &, A &) {}
+    template <class Node, class Alloc>
+    inline void __rb_tree_pool_swap(__rb_tree_node_pool<Node, Alloc> &p, __rb_tree_node_pool<Node, Alloc> &q) { p.swap(q); }
+    template <class A>
+    inline void __rb_tree_pool_share(A &, A &) {}
+    template <class Node, class Alloc>
+    inline void __rb_tree_pool_share(__rb_tree_node_pool<Node, Alloc> &p, __rb_tree_node_pool<Node, Alloc> &q) { p.share(q); }
+
+    // 节点的配置器：一般的节点以 Alloc 配置，序号节点一律配置于各自的节点池；
+    // header 不放进每棵树的节点池，清空时整批归还区块才不会连 header 一起归还
+    template <class Node, class Alloc>
+    struct __rb_tree_node_alloc
+    {
+        typedef simple_alloc<Node, Alloc> type;
+        typedef type header_type;
+    };
+    template <class Node, class Alloc>
+    struct __rb_tree_node_alloc<Node, __rb_tree_pool_alloc<Alloc> >
+    {
+        typedef __rb_tree_node_pool<Node, Alloc> type;
+        typedef simple_alloc<Node, Alloc> header_type;
+    };
+    template <class Value, class Alloc>
+    struct __rb_tree_node_alloc<__rb_tree_index_node<Value>, Alloc>
+    {
+        typedef __rb_tree_index_pool<__rb_tree_index_node<Value> > type;
+        typedef type header_type;
+    };
+    template <class Value, class Alloc>
+    struct __rb_tree_node_alloc<__rb_tree_index_node<Value>, __rb_tree_pool_alloc<Alloc> >
+    {
+        typedef __rb_tree_index_pool<__rb_tree_index_node<Value> > type;
+        typedef type header_type;
+    };
+
+    template <class Base>
+    inline Base *__rb_tree_minimum(Base *x)
+    {
+        for (Base *y; (y = __rb_left(x)) != 0; )
+            x = y;
+        return x;
+    }
+    template <class Base>
+    inline Base *__rb_tree_maximum(Base *x)
+    {
+        for (Base *y; (y = __rb_right(x)) != 0; )
+            x = y;
+        return x;
+    }
+
+    // 自 x 起一路向上直到根节点，重新计算沿途节点的附加数据（根节点的父节点即 header）
+    template <class Base>
+    inline void __rb_tree_update_to_root(Base *x, Base *root,
+                                         typename __rb_tree_update<Base>::fn update)
+    {
+        if (root == 0)
+            return;
+        for (Base *header = __rb_parent(root); x != header; x = __rb_parent(x))
+            update(x);
+    }
+
+    /************************ split / join ************************/
+    // 以下所说的 “独立的树”，是指根节点为黑、根的 parent 为 0 的一棵 RB-tree（不含 header）。
+    // 黑高：自根至任一空节点的路径上黑色节点的个数（含根），空树为 0
+
+    template <class Base>
+    inline size_t __rb_tree_black_height(Base *x)
+    {
+        size_t h = 0;
+        for (; x != 0; x = __rb_left(x))
+            if (__rb_color(x) == __rb_tree_black)
+                ++h;
+        return h;
+    }
+
+    // 把子树 x 从其父节点摘下成为独立的树，h 为其黑高（传入时为子树原本的黑高）
+    template <class Base>
+    inline Base *__rb_tree_make_root(Base *x, size_t &h)
+    {
+        if (x != 0)
+        {
+            __rb_parent(x) = 0;
+            if (__rb_color(x) == __rb_tree_red)
+            {
+                __rb_color(x) = __rb_tree_black;
+                ++h;
+            }
+        }
+        return x;
+    }
+
+    // 以 parent 连结串起来的节点链，用来收集集合运算中被剔除的节点（或子树）
+    template <class Base>
+    struct __rb_tree_chain
+    {
+        Base *head;
+        Base *tail;
+
+        __rb_tree_chain() : head(0), tail(0) {}
+        void push(Base *x)
+        {
+            __rb_parent(x) = 0;
+            if (tail) __rb_parent(tail) = x;
+            else head = x;
+            tail = x;
+        }
+        void splice(__rb_tree_chain &c)
+        {
+            if (c.head == 0)
+                return;
+            if (tail) __rb_parent(tail) = c.head;
+            else head = c.head;
+            tail = c.tail;
+            c.head = c.tail = 0;
+        }
     };
 
-    // 基层迭代器
-    struct __rb_tree_base_iterator
+    // 节点记录了子树大小时，直接传回子树大小；否则传回 size_t(-1) 表示未知
+    template <class Value>
+    inline size_t __rb_tree_size_hint(__rb_tree_os_node<Value>*, __rb_tree_node_base* x)
+    {
+        return __rb_tree_os_node<Value>::size_of(x);
+    }
+    template <class Base>
+    inline size_t __rb_tree_size_hint(void*, Base*)
+    {
+        return size_t(-1);
+    }
+
+    template <class Base>
+    inline size_t __rb_tree_subtree_count(Base *x)
+    {
+        size_t n = 0;
+        for (; x != 0; x = __rb_left(x))
+            n += __rb_tree_subtree_count<Base>(__rb_right(x)) + 1;
+        return n;
+    }
+
+    // 基层迭代器，Base 为节点的基类
+    template <class Base>
+    struct __rb_tree_iterator_base
     {
-        typedef __rb_tree_node_base::base_ptr base_ptr;
+        typedef Base *base_ptr;
         typedef bidirectional_iterator_tag iterator_category;
         typedef ptrdiff_t difference_type;
 
@@ -56,21 +742,21 @@ namespace SimpleSTL
         // 以下其实可实现于 operator++ 内，因为再无他处会调用此函数了（P216）
         void increment()
         {
-            if (node->right != 0)
+            if (__rb_right(node) != 0)
             {
-                node = node->right;
-                while (node->left != 0)
-                    node = node->left;
+                node = __rb_right(node);
+                while (__rb_left(node) != 0)
+                    node = __rb_left(node);
             }
             else
             {
-                base_ptr y = node->parent; // 找出父节点
-                while (node == y->right)   // 如果现行节点本身是个右子节点
+                base_ptr y = __rb_parent(node); // 找出父节点
+                while (node == __rb_right(y))   // 如果现行节点本身是个右子节点
                 {
                     node = y; // 就一直上溯，直到 “不为右子节点” 为止
-                    y = y->parent;
+                    y = __rb_parent(y);
                 }
-                if (node->right != y)
+                if (__rb_right(node) != y)
                     node = y;
             }
         }
@@ -78,86 +764,127 @@ namespace SimpleSTL
         // 以下其实可实现于 operator-- 内，因为再无他处会调用此函数了
         void decrement()
         {
-            if (node->color == __rb_tree_red &&
-                node->parent->parent == node)
-                node = node->right;
-            else if (node->left != 0)
+            if (__rb_color(node) == __rb_tree_red &&
+                __rb_parent(__rb_parent(node)) == node)
+                node = __rb_right(node);
+            else if (__rb_left(node) != 0)
             {
-                base_ptr y = node->left;
-                while (y->right != 0)
-                    y = y->right;
+                base_ptr y = __rb_left(node);
+                while (__rb_right(y) != 0)
+                    y = __rb_right(y);
                 node = y;
             }
             else
             {
-                base_ptr y = node->parent;
-                while (node == y->left)
+                base_ptr y = __rb_parent(node);
+                while (node == __rb_left(y))
                 {
                     node = y;
-                    y = y->parent;
+                    y = __rb_parent(y);
                 }
                 node = y;
             }
         }
     };
+    typedef __rb_tree_iterator_base<__rb_tree_node_base> __rb_tree_base_iterator;
 
     // RB-tree的正规迭代器
-    template <class Value, class Ref, class Ptr>
-    struct __rb_tree_iterator : public __rb_tree_base_iterator
+    template <class Value, class Ref, class Ptr, class Node = __rb_tree_node<Value> >
+    struct __rb_tree_iterator : public __rb_tree_iterator_base<typename Node::base_type>
     {
         typedef Value value_type;
         typedef Ref reference;
         typedef Ptr pointer;
-        typedef __rb_tree_iterator<Value, Value &, Value *> iterator;
-        typedef __rb_tree_iterator<Value, const Value &, const Value *> const_iterator;
-        typedef __rb_tree_iterator<Value, Ref, Ptr> self;
-        typedef __rb_tree_node<Value> *link_type;
+        typedef __rb_tree_iterator<Value, Value &, Value *, Node> iterator;
+        typedef __rb_tree_iterator<Value, const Value &, const Value *, Node> const_iterator;
+        typedef __rb_tree_iterator<Value, Ref, Ptr, Node> self;
+        typedef Node *link_type;
 
         __rb_tree_iterator() {}
-        __rb_tree_iterator(link_type x) { node = x; }
-        __rb_tree_iterator(const iterator &it) { node = it.node; }
+        __rb_tree_iterator(link_type x) { this->node = x; }
+        __rb_tree_iterator(const iterator &it) { this->node = it.node; }
 
-        reference operator*() const { return link_type(node)->value_field; }
+        reference operator*() const { return static_cast<link_type>(this->node)->value_field; }
         pointer operator->() const { return &(operator*()); }
 
         self &operator++()
         {
-            increment();
+            this->increment();
             return *this;
         }
         self operator++(int)
         {
             self tmp = *this;
-            increment();
+            this->increment();
             return tmp;
         }
 
         self &operator--()
         {
-            decrement();
+            this->decrement();
             return *this;
         }
         self operator--(int)
         {
             self tmp = *this;
-            decrement();
+            this->decrement();
             return tmp;
         }
 
-        bool operator==(const self &iter) const { return node == iter.node; }
-        bool operator!=(const self &iter) const { return node != iter.node; }
+        bool operator==(const self &iter) const { return this->node == iter.node; }
+        bool operator!=(const self &iter) const { return this->node != iter.node; }
+    };
+
+    // 以 Link 型别读写节点 node 的一个连结（link 为 __rb_tree_left_link 等）。
+    // 不论底层是指针成员还是代理对象，rb_tree 都可以写 left(y) = z、x = left(x) 之类的语句
+    template <class Link, class Base>
+    struct __rb_tree_link_ref
+    {
+        Base *node;
+        int link;
+
+        __rb_tree_link_ref(Base *x, int l) : node(x), link(l) {}
+        operator Link() const
+        {
+            Base *y;
+            if (link == __rb_tree_left_link)
+                y = __rb_left(node);
+            else if (link == __rb_tree_right_link)
+                y = __rb_right(node);
+            else
+                y = __rb_parent(node);
+            return static_cast<Link>(y);
+        }
+        Link operator->() const { return *this; }
+        __rb_tree_link_ref &operator=(Base *y)
+        {
+            if (link == __rb_tree_left_link)
+                __rb_left(node) = y;
+            else if (link == __rb_tree_right_link)
+                __rb_right(node) = y;
+            else
+                __rb_parent(node) = y;
+            return *this;
+        }
+        __rb_tree_link_ref &operator=(const __rb_tree_link_ref &r) { return *this = Link(r); }
     };
 
+    // Node 决定节点的型别：默认为 __rb_tree_node；__rb_tree_os_node 额外维护子树大小；
+    // __rb_tree_compact_node 把颜色存放在父节点指针中；__rb_tree_index_node 以 32 位序号连结
+    // Alloc 为 __rb_tree_pool_alloc<A> 时，节点取自每棵树专属的节点池，清空时整批归还
     template <class Key, class Value, class KeyOfValue, class Compare,
-              class Alloc = alloc2>
+              class Alloc = alloc2, template <class> class Node = __rb_tree_node>
     class rb_tree
     {
     protected:
         typedef void *void_pointer;
-        typedef __rb_tree_node_base *base_ptr;
-        typedef __rb_tree_node<Value> rb_tree_node;
-        typedef simple_alloc<rb_tree_node, Alloc> rb_tree_node_allocator;
+        typedef typename Node<Value>::base_type base_type;
+        typedef base_type *base_ptr;
+        typedef Node<Value> rb_tree_node;
+        typedef typename __rb_tree_node_alloc<rb_tree_node, Alloc>::type rb_tree_node_allocator;
+        typedef typename __rb_tree_node_alloc<rb_tree_node, Alloc>::header_type header_allocator;
         typedef __rb_tree_color_type color_type;
+        typedef typename __rb_tree_update<base_type>::fn update_type;
 
     public:
         typedef Key key_type;
@@ -173,22 +900,42 @@ namespace SimpleSTL
         typedef ptrdiff_t difference_type;
 
     protected:
-        link_type get_node() { return rb_tree_node_allocator::allocate(); }
-        void put_node(link_type p) { rb_tree_node_allocator::deallocate(p); }
+        typedef __rb_tree_link_ref<link_type, base_type> link_ref;
+        typedef decltype(__rb_color(base_ptr())) color_ref;
+
+        link_type get_node() { return node_allocator.allocate(); }
+        void put_node(link_type p) { node_allocator.deallocate(p); }
         // void destroy(Value *value_field) {}
         link_type create_node(const value_type &x)
         {
             link_type tmp = get_node();         // 配置空间
-            construct(&tmp->value_field, x);    // 构造内容
+            try {
+                construct(&tmp->value_field, x);    // 构造内容
+            }
+            catch (...) {
+                put_node(tmp);
+                throw;
+            }
             return tmp;
         }
 
         link_type clone_node(link_type x)       // 复制一个节点（的值和色）
         {
-            link_type tmp = create_node(x->value_field);
-            tmp->color = x->color;
-            tmp->left = 0;
-            tmp->right = 0;
+            link_type tmp = get_node();
+            try {
+                return clone_node(x, tmp);
+            }
+            catch (...) {
+                put_node(tmp);
+                throw;
+            }
+        }
+        link_type clone_node(link_type x, link_type tmp)    // 复制到已配置好的 tmp
+        {
+            construct(&tmp->value_field, x->value_field);
+            color(tmp) = color(x);
+            left(tmp) = 0;
+            right(tmp) = 0;
             return tmp;
         }
 
@@ -198,108 +945,279 @@ namespace SimpleSTL
             put_node(p);                    // 释放内存
         }
 
-        void clear() {
-            if (node_count != 0) {
-                erase(root());
-                leftmost() = header;
-                root() = 0;
-                rightmost() = header;
-                node_count = 0;
-            }
-        }
-
     protected:
         // RB-tree 只以三笔数据表现
         size_type node_count;   // 追踪记录树的大小（节点数量）
         link_type header;       // 这是实现上的一个小技巧，header与root互为父节点
         Compare key_compare;    // 节点间的键值大小比较准则，应该会是个 function object
+        rb_tree_node_allocator node_allocator;  // 只有每棵树专属的节点池才有状态
+        base_ptr finger;        // 最近一次插入的节点，下一次插入由此出发；0 表示没有
 
         // 以下三个函数用来方便取得header的成员
-        link_type& root() const { return (link_type&)header->parent; }
-        link_type& leftmost() const { return (link_type&)header->left; }
-        link_type& rightmost() const { return (link_type&)header->right; }
+        link_ref root() const { return link_ref(header, __rb_tree_parent_link); }
+        link_ref leftmost() const { return link_ref(header, __rb_tree_left_link); }
+        link_ref rightmost() const { return link_ref(header, __rb_tree_right_link); }
 
         // 以下六个函数用来方便取得节点 x 的成员
-        static link_type &left(link_type x)
-            { return (link_type &)(x->left); }
-        static link_type &right(link_type x)
-            { return (link_type &)(x->right); }
-        static link_type &parent(link_type x)
-            { return (link_type &)(x->parent); }
-        static reference value(link_type x)
-            { return x->value_field; }
-        static const Key &key(link_type x)
-            { return KeyOfValue()(value(x)); }
-        static color_type &color(link_type x)
-            { return (color_type &)(x->color); }
-
-        // 以下六个函数用来方便取得x的成员
-        static link_type &left(base_ptr x)
-            { return (link_type &)(x->left); }
-        static link_type &right(base_ptr x)
-            { return (link_type &)(x->right); }
-        static link_type &parent(base_ptr x)
-            { return (link_type &)(x->parent); }
+        static link_ref left(base_ptr x)
+            { return link_ref(x, __rb_tree_left_link); }
+        static link_ref right(base_ptr x)
+            { return link_ref(x, __rb_tree_right_link); }
+        static link_ref parent(base_ptr x)
+            { return link_ref(x, __rb_tree_parent_link); }
         static reference value(base_ptr x)
-            { return ((link_type)x)->value_field; }
+            { return static_cast<link_type>(x)->value_field; }
         static const Key &key(base_ptr x)
-            { return KeyOfValue()(value(link_type(x))); }
-        static color_type &color(base_ptr x)
-            { return (color_type &)(link_type(x)->color); }
+            { return KeyOfValue()(value(x)); }
+        static color_ref color(base_ptr x)
+            { return __rb_color(x); }
         
-        static link_type minimum(link_type x)
+        static link_type minimum(base_ptr x)
+        {
+            return static_cast<link_type>(__rb_tree_minimum(x));
+        }
+
+        static link_type maximum(base_ptr x)
+        {
+            return static_cast<link_type>(__rb_tree_maximum(x));
+        }
+
+        // 以下两个函数只在 Node 为 __rb_tree_os_node 时可用
+        static size_type subtree_size(base_ptr x)
+            { return rb_tree_node::size_of(x); }
+        size_type position(base_ptr x) const;
+
+    public:
+        typedef __rb_tree_iterator<value_type, reference, pointer, rb_tree_node> iterator;
+        typedef __rb_tree_iterator<value_type, const_reference, const_pointer, rb_tree_node> const_iterator;
+
+    private:
+        // 真正的插入执行程序
+        iterator __insert(base_ptr x_, base_ptr y_, const Value &v);
+        // 自 finger 往上，找出子树必定包含 k 之插入位置的最低祖先，插入时由此往下查找。
+        // k 在 finger 之后时，越过键值不大于 k 的父节点；在 finger 之前时，越过键值大于 k 的父节点。
+        // 与 finger 相距 d 个元素时只需 O(log d) 次比较
+        link_type __finger_start(const key_type& k) const;
+        // 复制时取得节点的来源。mu 为 0 时直接向 node_allocator 配置；否则供并行复制的各个线程使用，
+        // 每次加锁领取一小批，用不完的析构时归还
+        struct __node_batch
+        {
+            enum { batch_size = 64 };
+            rb_tree *tree;
+            std::mutex *mu;
+            link_type nodes[batch_size];
+            size_type n;
+
+            __node_batch(rb_tree *t, std::mutex *m) : tree(t), mu(m), n(0) {}
+            ~__node_batch()
+            {
+                if (n != 0)
+                {
+                    std::lock_guard<std::mutex> g(*mu);
+                    while (n != 0)
+                        tree->put_node(nodes[--n]);
+                }
+            }
+            link_type get()
+            {
+                if (mu == 0)
+                    return tree->get_node();
+                if (n == 0)
+                {
+                    std::lock_guard<std::mutex> g(*mu);
+                    for (; n < batch_size; ++n)
+                        nodes[n] = tree->get_node();
+                }
+                return nodes[--n];
+            }
+        };
+        // 黑高低于此值的子树（不足约一千个节点）不值得交给另一个线程
+        enum { __parallel_min_height = 10 };
+        link_type __copy(link_type x, link_type p, __node_batch& nodes);
+        link_type __parallel_copy(link_type x, link_type p, size_t h, unsigned depth, __node_batch& nodes);
+        // 依键值顺序走访以 x 为根的子树，以小数组代替父节点回溯
+        template <class Function>
+        static void __in_order(link_type x, Function& f)
+        {
+            link_type stack[2 * sizeof(size_type) * 8];
+            size_type n = 0;
+            for (;;)
+            {
+                for (; x != 0; x = left(x))
+                    stack[n++] = x;
+                if (n == 0)
+                    return;
+                x = stack[--n];
+                f(x);
+                x = right(x);
+            }
+        }
+        // 最上面 depth 层把左子树交给另一个线程，本线程处理节点本身与右子树
+        template <class Function>
+        static void __parallel_visit(link_type x, size_t h, unsigned depth, Function& f)
+        {
+            if (depth == 0 || h < __parallel_min_height)
+            {
+                __in_order(x, f);
+                return;
+            }
+            size_t ch = h - (color(x) == __rb_tree_black ? 1 : 0);
+            link_type l = left(x);
+            std::future<void> fl = std::async(std::launch::async, [&]() {
+                __parallel_visit(l, ch, depth - 1, f);
+            });
+            f(x);
+            __parallel_visit(link_type(right(x)), ch, depth - 1, f);
+            fl.get();
+        }
+        // 非空子树 x 依键值顺序的累积值：op(...op(f(v1), f(v2))..., f(vk))
+        template <class T, class BinaryOp, class UnaryOp>
+        static T __parallel_reduce(link_type x, size_t h, unsigned depth, BinaryOp& op, UnaryOp& f)
+        {
+            if (depth == 0 || h < __parallel_min_height)
+            {
+                link_type stack[2 * sizeof(size_type) * 8];
+                size_type n = 0;
+                for (; x != 0; x = left(x))
+                    stack[n++] = x;
+                x = stack[--n];
+                T acc = f(static_cast<const_reference>(x->value_field));
+                for (x = right(x);;)
+                {
+                    for (; x != 0; x = left(x))
+                        stack[n++] = x;
+                    if (n == 0)
+                        return acc;
+                    x = stack[--n];
+                    acc = op(acc, f(static_cast<const_reference>(x->value_field)));
+                    x = right(x);
+                }
+            }
+            size_t ch = h - (color(x) == __rb_tree_black ? 1 : 0);
+            link_type l = left(x), r = right(x);
+            std::future<T> fl;
+            if (l != 0)
+                fl = std::async(std::launch::async, [&]() {
+                    return __parallel_reduce<T>(l, ch, depth - 1, op, f);
+                });
+            T acc = f(static_cast<const_reference>(x->value_field));
+            if (r != 0)
+                acc = op(acc, __parallel_reduce<T>(r, ch, depth - 1, op, f));
+            return l != 0 ? op(fl.get(), acc) : acc;
+        }
+        size_type __erase(link_type x, bool free_nodes = true);
+        template <class ForwardIterator>
+        link_type __build_sorted(ForwardIterator &first, ForwardIterator last, size_type n,
+                                 size_type depth, size_type red_depth, bool unique);
+        // 全局函数以引用修改 root / leftmost / rightmost，而 header 的连结未必是真正的指针成员，
+        // 故先取出，调用之后再写回
+        void __rebalance(base_ptr x)
         {
-            return (link_type)__rb_tree_node_base::minimum(x);
+            base_ptr r = root();
+            __rb_tree_rebalance(x, r, rb_tree_node::update_fn());
+            root() = r;
         }
-
-        static link_type maximum(link_type x)
+        base_ptr __rebalance_for_erase(base_ptr z)
         {
-            return (link_type)__rb_tree_node_base::maximum(x);
+            base_ptr r = root(), lm = leftmost(), rm = rightmost();
+            base_ptr y = __rb_tree_rebalance_for_erase(z, r, lm, rm, rb_tree_node::update_fn());
+            root() = r;
+            leftmost() = lm;
+            rightmost() = rm;
+            return y;
         }
-
-    public:
-        typedef __rb_tree_iterator<value_type, reference, pointer> iterator;
-        typedef __rb_tree_iterator<value_type, const_reference, const_pointer> const_iterator;
-
-    private:
-        // 真正的插入执行程序
-        iterator __insert(base_ptr x_, base_ptr y_, const Value &v);
-        link_type __copy(link_type x, link_type p);
-        void __erase(link_type x);
         void init()
         {
-            header = get_node();            // 产生一个节点空间，令 header 指向它
+            header = header_allocator::allocate();  // 产生一个节点空间，令 header 指向它
             color(header) = __rb_tree_red;  // 令 header 为红色，用来区分 header 与 root
 
             root() = 0;
             leftmost() = header;        // 令 header 的左子节点为自己
             rightmost() = header;       // 令 header 的右子节点为自己
+            finger = 0;
         }
 
     public:
         rb_tree(const Compare &comp = Compare())
             : node_count(0), key_compare(comp) { init(); }
+        rb_tree(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node> &x)
+            : node_count(0), key_compare(x.key_compare)
+        {
+            init();
+            *this = x;
+        }
 
         ~rb_tree()
         {
             clear();
-            put_node(header);
+            header_allocator::deallocate(header);
         }
-        rb_tree<Key, Value, KeyOfValue, Compare, Alloc> &
-            operator=(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc> &x);
+        rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node> &
+            operator=(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node> &x);
         link_type _M_copy(link_type __x, link_type __p);
+        // 以 x 的内容取代本树，与 operator= 相同。parallel_depth > 0 时，最上面 parallel_depth 层
+        // 把较大的子树交给不同线程复制（最多 2^parallel_depth 个线程），此时元素的复制构造必须可以被
+        // 并发调用。节点为 __rb_tree_index_node 时一律由本线程复制
+        void copy_from(const rb_tree& x, unsigned parallel_depth = 0);
+
+        // 对每个元素调用 f，最上面 parallel_depth 层按子树分给不同线程（最多 2^parallel_depth 个）。
+        // 各线程共用同一个 f，f 必须可以被并发调用；调用的先后次序不定。f 不可增删本树的元素
+        template <class Function>
+        void parallel_for_each(Function f, unsigned parallel_depth)
+        {
+            __apply<Function, reference> a(f);
+            if (node_count != 0)
+                __parallel_visit(root(), __rb_tree_black_height(base_ptr(root())), parallel_depth, a);
+        }
+        template <class Function>
+        void parallel_for_each(Function f, unsigned parallel_depth) const
+        {
+            __apply<Function, const_reference> a(f);
+            if (node_count != 0)
+                __parallel_visit(root(), __rb_tree_black_height(base_ptr(root())), parallel_depth, a);
+        }
+        // 依键值顺序累积：op(...op(op(init, f(v1)), f(v2))..., f(vn))，空树传回 init。
+        // 子树各自在不同线程累积后依序合并，故 op 必须满足结合律；op 与 f 都必须可以被并发调用
+        template <class T, class BinaryOp, class UnaryOp>
+        T parallel_reduce(T init, BinaryOp op, UnaryOp f, unsigned parallel_depth) const
+        {
+            if (node_count == 0)
+                return init;
+            return op(init, __parallel_reduce<T>(root(), __rb_tree_black_height(base_ptr(root())),
+                                                 parallel_depth, op, f));
+        }
 
     public:
         Compare key_comp() const { return key_compare; }
-        iterator begin() const { return leftmost(); }
+        iterator begin() const { return link_type(leftmost()); }
         iterator end() const { return header; }
         bool empty() const { return node_count == 0; }
         size_type size() const { return node_count; }
         size_type max_size() const { return size_type(-1); }
-        void swap(rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& t) {
+        void swap(rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>& t) {
             std::swap(header, t.header);
             std::swap(node_count, t.node_count);
             std::swap(key_compare, t.key_compare);
+            std::swap(finger, t.finger);
+            __rb_tree_pool_swap(node_allocator, t.node_allocator);
+        }
+
+        void clear() {
+            if (node_count != 0) {
+                if (__rb_tree_pool_exclusive(node_allocator)) {
+                    // 节点池只属于这棵树：析构各个值之后整批归还区块
+                    if (!std::is_trivially_destructible<value_type>::value)
+                        __erase(root(), false);
+                    __rb_tree_pool_release(node_allocator);
+                }
+                else
+                    __erase(root());
+                leftmost() = header;
+                root() = 0;
+                rightmost() = header;
+                node_count = 0;
+                finger = 0;
+            }
         }
 
     public:
@@ -309,19 +1227,69 @@ namespace SimpleSTL
         // 将 x 插入到 RB-tree 中（保持节点值独一无二）
         std::pair<iterator, bool> insert_unique(const value_type &v);
         iterator insert_unique(iterator position, const value_type& x);
+        // 以 end() 为提示逐一插入：输入若已排序，每个元素只需与最大元素比较一次，
+        // 不必自根而下查找，重新平衡也只是均摊 O(1)
         template <class InputIterator>
-        bool insert_unique(InputIterator first, InputIterator last)
+        void insert_unique(InputIterator first, InputIterator last)
         {
-            for (auto it = first; it != last; it++)
-            {
-                insert_unique(*it);
-            }
+            for (; first != last; ++first)
+                insert_unique(end(), *first);
+        }
+        // 插入一段已排序的元素（可以落在树的中间）：每个元素都由前一个元素的位置（finger）出发，
+        // 相邻元素在树中相距 d 个元素时只需 O(log d) 次比较
+        template <class InputIterator>
+        void insert_sorted_run(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first)
+                insert_unique(*first);
+        }
+        template <class InputIterator>
+        void insert_sorted_run_equal(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first)
+                insert_equal(*first);
         }
 
+        // 以已排序的 [first, last) 取代树中的全部元素，O(n) 建出一棵完全平衡、着色正确的树，
+        // 节点按键值顺序配置。输入必须已排序（不做检查），且须为 forward iterator（会走访两次）。
+        // assign_sorted_unique 只保留重复键值中的第一个，assign_sorted_equal 全部保留
+        template <class ForwardIterator>
+        void assign_sorted_unique(ForwardIterator first, ForwardIterator last)
+            { __assign_sorted(first, last, true); }
+        template <class ForwardIterator>
+        void assign_sorted_equal(ForwardIterator first, ForwardIterator last)
+            { __assign_sorted(first, last, false); }
+    private:
+        template <class ForwardIterator>
+        void __assign_sorted(ForwardIterator first, ForwardIterator last, bool unique);
+    public:
+
         void erase(iterator position);
         size_type erase(const key_type& x);
         void erase(iterator first, iterator last);
         void erase(const key_type* first, const key_type* last);
+        // 删除键值在 [lo, hi) 范围内的全部元素，传回删除的个数。以两次 split 摘下整段、
+        // 一次 join 接回其余部分，树形调整只需 O(log n)，再不经重新平衡地销毁摘下的 k 个节点；
+        // 不像 erase(first, last) 那样每删除一个元素就重新平衡一次
+        size_type erase_range(const key_type& lo, const key_type& hi)
+        {
+            return key_compare(lo, hi) ? __erase_range(lo, hi, false) : 0;
+        }
+        // 依键值顺序对 [lo, hi) 范围内的每个元素调用 f。f 不可增删本树的元素
+        template <class Function>
+        Function for_each_in_range(const key_type& lo, const key_type& hi, Function f)
+        {
+            __apply<Function, reference> a(f);
+            __visit_range(lo, hi, false, a);
+            return f;
+        }
+        template <class Function>
+        Function for_each_in_range(const key_type& lo, const key_type& hi, Function f) const
+        {
+            __apply<Function, const_reference> a(f);
+            __visit_range(lo, hi, false, a);
+            return f;
+        }
 
         iterator find(const key_type& __x);
         const_iterator find(const key_type& __x) const;
@@ -332,36 +1300,168 @@ namespace SimpleSTL
         const_iterator upper_bound(const key_type& __x) const;
         std::pair<iterator,iterator> equal_range(const key_type& __x);
         std::pair<const_iterator, const_iterator> equal_range(const key_type& __x) const;
+
+    public:
+        // 以下皆只搬移节点，不复制元素，也不配置新节点
+        // 把键值不小于 k 的元素全部移到 x（x 原有的元素先被清除）。树形调整为 O(log n)；
+        // 重新计算两侧的元素个数时，__rb_tree_os_node 为 O(1)，否则为 O(较小一侧的元素个数)
+        void split(const key_type& k, rb_tree& x);
+        // 把 x 的全部元素移入本树，x 成为空树。本树的每个元素都不可大于 x 的任一元素。O(log n)
+        void join(rb_tree& x);
+        // 把 [lo, hi) 范围内的元素移到 x（x 原有的元素先被清除）
+        void extract_range(const key_type& lo, const key_type& hi, rb_tree& x);
+
+        // 以 split / join 实现的集合运算（键值唯一的树），O(m log(n/m + 1))。
+        // parallel_depth > 0 时，递归的最上面 parallel_depth 层把左右两个子问题交给不同线程
+        // 同时处理（最多 2^parallel_depth 个线程），此时 Compare 必须可以被并发调用
+        // 并集：x 中键值不重复的元素移入本树，键值重复者留在 x
+        void merge_from(rb_tree& x, unsigned parallel_depth = 0);
+        // 交集：只保留 x 中也有的键值，其余元素被销毁。x 不变
+        void intersect_with(const rb_tree& x, unsigned parallel_depth = 0);
+        // 差集：销毁 x 中也有的键值。x 不变
+        void subtract(const rb_tree& x, unsigned parallel_depth = 0);
+
+    private:
+        // 把整棵树摘下成为独立的树（根的 parent 为 0），本树成为空树
+        base_ptr __detach(size_t& h)
+        {
+            base_ptr r = root();
+            if (r != 0)
+                parent(r) = 0;
+            h = __rb_tree_black_height(r);
+            root() = 0;
+            leftmost() = header;
+            rightmost() = header;
+            node_count = 0;
+            finger = 0;
+            return r;
+        }
+        // 以独立的树 r（n 个元素）作为本树的内容；本树原本须为空
+        void __attach(base_ptr r, size_type n)
+        {
+            root() = (link_type)r;
+            if (r != 0)
+            {
+                parent(r) = header;
+                leftmost() = minimum((link_type)r);
+                rightmost() = maximum((link_type)r);
+            }
+            node_count = n;
+            finger = 0;
+        }
+        static void __recount(rb_tree& a, rb_tree& b, size_type total);
+        void __append_node(base_ptr z);
+        size_type __destroy_chain(base_ptr chain);
+        void __split(base_ptr x, size_t h, const key_type& k,
+                     base_ptr& l, size_t& lh, base_ptr& r, size_t& rh, bool upper = false) const;
+        size_type __erase_range(const key_type& lo, const key_type& hi, bool closed);
+        // 依键值顺序走访键值在 [lo, hi)（closed 时为 [lo, hi]）范围内的节点，对每个节点调用 f。
+        // 以一个小数组记下尚待走访的祖先，不必经由父节点指针回溯，也不配置内存
+        template <class Function>
+        void __visit_range(const key_type& lo, const key_type& hi, bool closed, Function& f) const
+        {
+            link_type stack[2 * sizeof(size_type) * 8];    // 树高不超过 2 log2(n + 1)
+            size_type n = 0;
+            link_type x = root();
+            bool seek = true;   // 还没找到第一个不小于 lo 的节点
+            for (;;)
+            {
+                while (x != 0)
+                    if (seek && key_compare(key(x), lo))
+                        x = right(x);   // x 及其左子树都在范围之前
+                    else
+                    {
+                        stack[n++] = x;
+                        x = left(x);
+                    }
+                if (n == 0)
+                    return;
+                x = stack[--n];
+                seek = false;   // 之后走访的节点都不小于 x
+                if (closed ? key_compare(hi, key(x)) : !key_compare(key(x), hi))
+                    return;
+                f(x);
+                x = right(x);
+            }
+        }
+        template <class Function, class Ref>
+        struct __apply
+        {
+            Function &f;
+            __apply(Function &fn) : f(fn) {}
+            void operator()(link_type x) { f(static_cast<Ref>(x->value_field)); }
+        };
+        struct __counter
+        {
+            size_type n;
+            __counter() : n(0) {}
+            void operator()(link_type) { ++n; }
+        };
+        base_ptr __extract_min_equal(base_ptr& t, size_t& h, const key_type& k) const;
+        base_ptr __union(base_ptr t1, size_t h1, base_ptr t2, size_t h2,
+                         size_t& h, __rb_tree_chain<base_type>& dups, unsigned depth) const;
+        base_ptr __filter(base_ptr t1, size_t h1, base_ptr t2, bool keep_common,
+                          size_t& h, __rb_tree_chain<base_type>& dropped, unsigned depth) const;
+
+    public:
+        // order statistic：以下只在 Node 为 __rb_tree_os_node 时可用，皆为 O(log n)
+        // 小于 k 的元素个数，即 lower_bound(k) 的序号
+        size_type rank(const key_type& k) const;
+        // 第 n 个元素（从 0 起算），n >= size() 时传回 end()
+        iterator select(size_type n) const;
+        // 等价于 SimpleSTL::distance(first, last)，但不必逐一走访
+        difference_type distance(const_iterator first, const_iterator last) const
+        {
+            return difference_type(position(last.node)) - difference_type(position(first.node));
+        }
     };
 
-    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator 
-    rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal(const value_type &v)
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc,
+              template <class> class Node>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>::iterator 
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>::insert_equal(const value_type &v)
     {
+        const Key &k = KeyOfValue()(v);
+        if (node_count != 0)    // 不小于最大元素（递增的键值）或小于最小元素：O(1)
+        {
+            if (!key_compare(k, key(rightmost())))
+                return __insert(0, rightmost(), v);
+            if (key_compare(k, key(leftmost())))
+                return __insert(leftmost(), leftmost(), v);
+        }
         link_type y = header;
-        link_type x = root();   // 从根节点开始
-        while (x != 0)          // 从根节点开始，往下寻找适当的插入点
+        link_type x = __finger_start(k);    // 从 finger 的某个祖先（或根节点）开始
+        while (x != 0)          // 往下寻找适当的插入点
         {
             y = x;
-            x = key_compare(KeyOfValue()(v), key(x)) ? left(x) : right(x);
+            x = key_compare(k, key(x)) ? left(x) : right(x);
             // 以上，遇“大”则往左，遇“小于或等于”则往右
         }
         return __insert(x, y, v);
         // 以上，x 为新值插入点，y 为插入点之父节点，v 为新值
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-    std::pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator, bool>
-    rb_tree<Key, Value, KeyOfValue, Compare, Alloc>:: 
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc,
+              template <class> class Node>
+    std::pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>::iterator, bool>
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>:: 
         insert_unique(const value_type &v)
     {
+        const Key &k = KeyOfValue()(v);
+        if (node_count != 0)    // 大于最大元素（递增的键值）或小于最小元素：O(1)
+        {
+            if (key_compare(key(rightmost()), k))
+                return pair<iterator, bool>(__insert(0, rightmost(), v), true);
+            if (key_compare(k, key(leftmost())))
+                return pair<iterator, bool>(__insert(leftmost(), leftmost(), v), true);
+        }
         link_type y = header;
-        link_type x = root();
+        link_type x = __finger_start(k);    // 从 finger 的某个祖先（或根节点）开始
         bool comp = true;
         while (x != 0)
         {
             y = x;
-            comp = key_compare(KeyOfValue()(v), key(x));
+            comp = key_compare(k, key(x));
             x = comp ? left(x) : right(x);
         }
         //离开 while 循环之后，y 所指即插入点之父节点（此时的它必为叶节点），x 必定为 NULL
@@ -373,30 +1473,60 @@ namespace SimpleSTL
                 // 以上，x 为新值插入点，y 为插入点之父节点，v 为新值
             else
                 --j;    // 调整 j，回头准备测试
-        if (key_compare(key(j.node), KeyOfValue()(v)))
+        if (key_compare(key(j.node), k))
             // 新键值不与既有节点之键值重复，于是以下执行安插操作
             return pair<iterator, bool>(__insert(x, y, v), true);
         
         // 进行至此，表示新值一定与树中键值重复，那么就不该插入该值
+        finger = j.node;
         return pair<iterator, bool>(j, false);
     }
 
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc,
+              template <class> class Node>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>::link_type
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>::__finger_start(const key_type &k) const
+    {
+        link_type x = (link_type) finger;
+        link_type r = root();
+        if (x == 0)
+            return r;
+        if (!key_compare(k, key(x)))    // k 在 finger 之后（或相等）
+            while (x != r)
+            {
+                link_type p = parent(x);
+                if (x == (link_type) left(p) && key_compare(k, key(p)))
+                    break;  // k 的位置在 p 之前，必在 x 的子树中
+                x = p;
+            }
+        else                            // k 在 finger 之前
+            while (x != r)
+            {
+                link_type p = parent(x);
+                if (x == (link_type) right(p) && !key_compare(k, key(p)))
+                    break;  // k 的位置在 p 之后，必在 x 的子树中
+                x = p;
+            }
+        return x;
+    }
+
     // 侯捷代码中没有，从 SGI_STL 中改写
-    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator 
-    rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc,
+              template <class> class Node>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>::iterator 
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>::
         insert_unique(iterator position, const value_type& v)
     {
-        if (position.node == header->left) { // begin()
+        if (position.node == leftmost()) { // begin()
             if (size() > 0 && 
-                key_compare(KeyOfValue()(v), Key(position.node)))
+                key_compare(KeyOfValue()(v), key(position.node)))
             return __insert(position.node, position.node, v);
             // first argument just needs to be non-null 
             else
                 return insert_unique(v).first;
         } 
         else if (position.node == header) { // end()
-            if (key_compare(Key(rightmost()), KeyOfValue()(v)))
+            if (key_compare(key(rightmost()), KeyOfValue()(v)))
                 return __insert(0, rightmost(), v);
             else
                 return insert_unique(v).first;
@@ -404,8 +1534,8 @@ namespace SimpleSTL
         else {
             iterator __before = position;
             --__before;
-            if (key_compare(Key(__before.node), KeyOfValue()(v)) 
-              && key_compare(KeyOfValue()(v), Key(position.node))) {
+            if (key_compare(key(__before.node), KeyOfValue()(v)) 
+              && key_compare(KeyOfValue()(v), key(position.node))) {
             if (right(__before.node) == 0)
                 return __insert(0, __before.node, v); 
             else
@@ -417,9 +1547,10 @@ namespace SimpleSTL
         }        
     }
 
-    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
-    rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+    template <class Key, class Value, class KeyOfValue, class Compare, class Alloc,
+              template <class> class Node>
+    typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>::iterator
+    rb_tree<Key, Value, KeyOfValue, Compare, Alloc, Node>::
         __insert(base_ptr x_, base_ptr y_, const Value &v)
     {   // 参数 x_ 为新值插入点，参数 y_ 为插入点之父节点，参数 v 为新值
         link_type x = (link_type) x_;
@@ -449,41 +1580,49 @@ namespace SimpleSTL
         left(z) = 0;
         right(z) = 0;
         
-        __rb_tree_rebalance(z, header->parent);
+        __rebalance(z);
         ++node_count;
+        finger = z;
         return iterator(z);     // 返回一个迭代器，指向新增节点
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-          class _Compare, class _Alloc>
-    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::size_type 
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::erase(const _Key& __x)
+          class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::size_type 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::erase(const _Key& __x)
     {
-      pair<iterator,iterator> __p = equal_range(__x);
-      size_type __n = 0;
-      distance(__p.first, __p.second, __n);
-      erase(__p.first, __p.second);
-      return __n;
+      iterator __first = lower_bound(__x);
+      if (__first == end() || key_compare(__x, key(__first.node)))
+        return 0;
+      iterator __next = __first;
+      ++__next;
+      if (__next == end() || key_compare(__x, key(__next.node))) {
+        erase(__first);     // 键值唯一时只删一个节点，不必切开整棵树
+        return 1;
+      }
+      return __erase_range(__x, __x, true);
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-          class _Compare, class _Alloc>
-    inline void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
+          class _Compare, class _Alloc,
+              template <class> class _Node>
+    inline void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
     ::erase(iterator __position)
     {
+        if (__position.node == finger)
+          finger = 0;
         link_type __y = 
-          (link_type) __rb_tree_rebalance_for_erase(__position.node,
-                                                    header->parent,
-                                                    header->left,
-                                                    header->right);
+          (link_type) __rebalance_for_erase(__position.node);
         destroy_node(__y);
         --node_count;
     }
 
 
     template <class _Key, class _Value, class _KeyOfValue, 
-              class _Compare, class _Alloc>
-    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
       ::erase(iterator __first, iterator __last)
     {
       if (__first == begin() && __last == end())
@@ -493,8 +1632,9 @@ namespace SimpleSTL
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-              class _Compare, class _Alloc>
-    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
       ::erase(const _Key* __first, const _Key* __last) 
     {
       while (__first != __last) erase(*__first++);
@@ -503,298 +1643,600 @@ namespace SimpleSTL
         // 全局函数
         // 新节点必为红节点。如果插入处之父节点亦为红节点，就违反红黑树规则
         // 此时可能需做树形旋转及颜色改变
+        // 以下的全局函数皆以节点的基类 Base 为模板参数，由参数 root 推导
+        template <class Base>
         inline void
-        __rb_tree_rotate_left(__rb_tree_node_base* x,
-                              __rb_tree_node_base*& root)
+        __rb_tree_rotate_left(typename Base::base_ptr x,
+                              Base*& root,
+                              typename __rb_tree_update<Base>::fn update = 0)
         {
             // x 为旋转点
-            __rb_tree_node_base *y = x->right;
-            x->right = y->left;
-            if (y->left != 0)
-                y->left->parent = x;    // 别忘了回马枪设定父节点
-            y->parent = x->parent;
+            Base *y = __rb_right(x);
+            __rb_right(x) = __rb_left(y);
+            if (__rb_left(y) != 0)
+                __rb_parent(__rb_left(y)) = x;    // 别忘了回马枪设定父节点
+            __rb_parent(y) = __rb_parent(x);
 
             // 令 y 完全顶替 x 的地位（必须将 x 对其父节点的关系完全接收过来）
             if (x == root)
                 root = y;
-            else if (x == x->parent->left)
-                x->parent->left = y;
+            else if (x == __rb_left(__rb_parent(x)))
+                __rb_left(__rb_parent(x)) = y;
             else
-                x->parent->right = y;
-            y->left = x;
-            x->parent = y;
+                __rb_right(__rb_parent(x)) = y;
+            __rb_left(y) = x;
+            __rb_parent(x) = y;
+            if (update)     // x 已成为 y 的子节点，先更新 x 再更新 y
+            {
+                update(x);
+                update(y);
+            }
         }
 
     // 全局函数
     // 新节点必为红节点。如果插入处之父节点亦为红节点，就违反红黑树规则
     // 此时可能需做树形旋转及颜色改变
+    template <class Base>
     inline void
-    __rb_tree_rotate_right(__rb_tree_node_base *x,
-                           __rb_tree_node_base *&root)
+    __rb_tree_rotate_right(typename Base::base_ptr x,
+                           Base *&root,
+                           typename __rb_tree_update<Base>::fn update = 0)
     {
         //x为旋转点
-        __rb_tree_node_base *y = x->left;
-        x->left = y->right;
-        if (y->right != 0)
-            y->right->parent = x;
-        y->parent = x->parent;
+        Base *y = __rb_left(x);
+        __rb_left(x) = __rb_right(y);
+        if (__rb_right(y) != 0)
+            __rb_parent(__rb_right(y)) = x;
+        __rb_parent(y) = __rb_parent(x);
         
         // 令 y 完全顶替 x 的地位（必须将 x 对其父节点的关系完全接收过来）
         if (x == root)
             root = y;
-        else if (x == x->parent->right)
-            x->parent->right = y;
+        else if (x == __rb_right(__rb_parent(x)))
+            __rb_right(__rb_parent(x)) = y;
         else
-            x->parent->left = y;
-        y->right = x;
-        x->parent = y;
+            __rb_left(__rb_parent(x)) = y;
+        __rb_right(y) = x;
+        __rb_parent(x) = y;
+        if (update)
+        {
+            update(x);
+            update(y);
+        }
     }
 
     // 全局函数
     // 重新令树形平衡（改变颜色及旋转树形）
-    // 参数 1 为新增节点，参数 2 为 root
-    inline void __rb_tree_rebalance(__rb_tree_node_base* x, __rb_tree_node_base*& root)
+    // 参数 1 为新增节点，参数 2 为 root，参数 3 为节点增强的回调（可为 0）
+    // 传回值表示根节点是否由红转黑，亦即整棵树的黑高是否增加了 1
+    template <class Base>
+    inline bool __rb_tree_rebalance(typename Base::base_ptr x, Base*& root,
+                                    typename __rb_tree_update<Base>::fn update = 0)
     {
-        x->color = __rb_tree_red;           // 新节点必为红色
-        while (x != root && x->parent->color == __rb_tree_red)  // 父节点为红
+        if (update)     // 新节点的所有祖先都多了一个后代，先自下而上更新，其后旋转只需局部维护
+            __rb_tree_update_to_root(x, root, update);
+        __rb_color(x) = __rb_tree_red;           // 新节点必为红色
+        while (x != root && __rb_color(__rb_parent(x)) == __rb_tree_red)  // 父节点为红
         {
-            if (x->parent == x->parent->parent->left)   // 父节点为祖父节点之左子节点
+            if (__rb_parent(x) == __rb_left(__rb_parent(__rb_parent(x))))   // 父节点为祖父节点之左子节点
             { 
-                __rb_tree_node_base *y = x->parent->parent->right; //令 y 为伯父节点
-                if (y && y->color == __rb_tree_red)             //伯父节点存在，且为红
+                Base *y = __rb_right(__rb_parent(__rb_parent(x))); //令 y 为伯父节点
+                if (y && __rb_color(y) == __rb_tree_red)             //伯父节点存在，且为红
                 {                                             
-                    x->parent->color = __rb_tree_black;         // 更改父节点为黑
-                    y->color = __rb_tree_black;                 // 更改伯父节点为黑
-                    x->parent->parent->color = __rb_tree_red;   // 更改祖父节点为红
-                    x = x->parent->parent;                      // 准备继续往上层检查
+                    __rb_color(__rb_parent(x)) = __rb_tree_black;         // 更改父节点为黑
+                    __rb_color(y) = __rb_tree_black;                 // 更改伯父节点为黑
+                    __rb_color(__rb_parent(__rb_parent(x))) = __rb_tree_red;   // 更改祖父节点为红
+                    x = __rb_parent(__rb_parent(x));                      // 准备继续往上层检查
                 }
                 else    // 无伯父节点，或伯父节点为黑
                 { 
-                    if (x == x->parent->right)  //如果新节点为父节点之右子节点
+                    if (x == __rb_right(__rb_parent(x)))  //如果新节点为父节点之右子节点
                     {
-                        x = x->parent;
-                        __rb_tree_rotate_left(x, root);     // 第一参数为左旋点
+                        x = __rb_parent(x);
+                        __rb_tree_rotate_left(x, root, update);     // 第一参数为左旋点
                     }
-                    x->parent->color = __rb_tree_black;
-                    x->parent->parent->color = __rb_tree_red;
-                    __rb_tree_rotate_right(x->parent->parent, root); // 第一参数为右旋点
+                    __rb_color(__rb_parent(x)) = __rb_tree_black;
+                    __rb_color(__rb_parent(__rb_parent(x))) = __rb_tree_red;
+                    __rb_tree_rotate_right(__rb_parent(__rb_parent(x)), root, update); // 第一参数为右旋点
                 }
             }
             else    // 父节点为祖父节点之右子节点
             {                                                     
-                __rb_tree_node_base *y = x->parent->parent->left; // 令 y 为伯父节点
-                if (y && y->color == __rb_tree_red)
+                Base *y = __rb_left(__rb_parent(__rb_parent(x))); // 令 y 为伯父节点
+                if (y && __rb_color(y) == __rb_tree_red)
                 {                                               // 有伯父节点，且为红
-                    x->parent->color = __rb_tree_black;         // 更改父节点为黑
-                    y->color = __rb_tree_black;                 // 更改伯父节点为黑
-                    x->parent->parent->color = __rb_tree_red;   // 更改祖父节点为红
-                    x = x->parent->parent;                      // 准备继续往上层检查
+                    __rb_color(__rb_parent(x)) = __rb_tree_black;         // 更改父节点为黑
+                    __rb_color(y) = __rb_tree_black;                 // 更改伯父节点为黑
+                    __rb_color(__rb_parent(__rb_parent(x))) = __rb_tree_red;   // 更改祖父节点为红
+                    x = __rb_parent(__rb_parent(x));                      // 准备继续往上层检查
                 }
                 else     // 无伯父节点，或伯父节点为黑
                 {
-                    if (x == x->parent->left)   // 如果新节点为父节点之左子节点
+                    if (x == __rb_left(__rb_parent(x)))   // 如果新节点为父节点之左子节点
                     { 
-                        x = x->parent;
-                        __rb_tree_rotate_right(x, root);    // 第一参数为右旋点
+                        x = __rb_parent(x);
+                        __rb_tree_rotate_right(x, root, update);    // 第一参数为右旋点
                     }
-                    x->parent->color = __rb_tree_black;
-                    x->parent->parent->color = __rb_tree_red;
-                    __rb_tree_rotate_left(x->parent->parent, root); //第一参数为左旋点
+                    __rb_color(__rb_parent(x)) = __rb_tree_black;
+                    __rb_color(__rb_parent(__rb_parent(x))) = __rb_tree_red;
+                    __rb_tree_rotate_left(__rb_parent(__rb_parent(x)), root, update); //第一参数为左旋点
                 }
             }
         }   // while 结束
         
-        root->color = __rb_tree_black;  // 根节点永远为黑
+        bool grew = __rb_color(root) == __rb_tree_red;
+        __rb_color(root) = __rb_tree_black;  // 根节点永远为黑
+        return grew;
     }
 
-    inline __rb_tree_node_base*
-    __rb_tree_rebalance_for_erase(__rb_tree_node_base* __z,
-                                 __rb_tree_node_base*& __root,
-                                 __rb_tree_node_base*& __leftmost,
-                                 __rb_tree_node_base*& __rightmost)
+    template <class Base>
+    inline Base*
+    __rb_tree_rebalance_for_erase(typename Base::base_ptr __z,
+                                 Base*& __root,
+                                 Base*& __leftmost,
+                                 Base*& __rightmost,
+                                 typename __rb_tree_update<Base>::fn __update = 0)
     {
-      __rb_tree_node_base* __y = __z;
-      __rb_tree_node_base* __x = 0;
-      __rb_tree_node_base* __x_parent = 0;
-      if (__y->left == 0)     // __z has at most one non-null child. y == z.
-        __x = __y->right;     // __x might be null.
+      Base* __y = __z;
+      Base* __x = 0;
+      Base* __x_parent = 0;
+      if (__rb_left(__y) == 0)     // __z has at most one non-null child. y == z.
+        __x = __rb_right(__y);     // __x might be null.
       else
-        if (__y->right == 0)  // __z has exactly one non-null child. y == z.
-          __x = __y->left;    // __x is not null.
+        if (__rb_right(__y) == 0)  // __z has exactly one non-null child. y == z.
+          __x = __rb_left(__y);    // __x is not null.
         else {                   // __z has two non-null children.  Set __y to
-          __y = __y->right;   //   __z's successor.  __x might be null.
-          while (__y->left != 0)
-            __y = __y->left;
-          __x = __y->right;
+          __y = __rb_right(__y);   //   __z's successor.  __x might be null.
+          while (__rb_left(__y) != 0)
+            __y = __rb_left(__y);
+          __x = __rb_right(__y);
         }
       if (__y != __z) {          // relink y in place of z.  y is z's successor
-        __z->left->parent = __y; 
-        __y->left = __z->left;
-        if (__y != __z->right) {
-          __x_parent = __y->parent;
-          if (__x) __x->parent = __y->parent;
-          __y->parent->left = __x;      // __y must be a child of left
-          __y->right = __z->right;
-          __z->right->parent = __y;
+        __rb_parent(__rb_left(__z)) = __y; 
+        __rb_left(__y) = __rb_left(__z);
+        if (__y != __rb_right(__z)) {
+          __x_parent = __rb_parent(__y);
+          if (__x) __rb_parent(__x) = __rb_parent(__y);
+          __rb_left(__rb_parent(__y)) = __x;      // __y must be a child of left
+          __rb_right(__y) = __rb_right(__z);
+          __rb_parent(__rb_right(__z)) = __y;
         }
         else
           __x_parent = __y;  
         if (__root == __z)
           __root = __y;
-        else if (__z->parent->left == __z)
-          __z->parent->left = __y;
+        else if (__rb_left(__rb_parent(__z)) == __z)
+          __rb_left(__rb_parent(__z)) = __y;
         else 
-          __z->parent->right = __y;
-        __y->parent = __z->parent;
-        std::swap(__y->color, __z->color);
+          __rb_right(__rb_parent(__z)) = __y;
+        __rb_parent(__y) = __rb_parent(__z);
+        __rb_tree_color_type __c = __rb_color(__y);
+        __rb_color(__y) = __rb_color(__z);
+        __rb_color(__z) = __c;
         __y = __z;
         // __y now points to node to be actually deleted
       }
       else {                        // __y == __z
-        __x_parent = __y->parent;
-        if (__x) __x->parent = __y->parent;   
+        __x_parent = __rb_parent(__y);
+        if (__x) __rb_parent(__x) = __rb_parent(__y);   
         if (__root == __z)
           __root = __x;
         else 
-          if (__z->parent->left == __z)
-            __z->parent->left = __x;
+          if (__rb_left(__rb_parent(__z)) == __z)
+            __rb_left(__rb_parent(__z)) = __x;
           else
-            __z->parent->right = __x;
+            __rb_right(__rb_parent(__z)) = __x;
         if (__leftmost == __z) 
-          if (__z->right == 0)        // __z->left must be null also
-            __leftmost = __z->parent;
+          if (__rb_right(__z) == 0)        // __rb_left(__z) must be null also
+            __leftmost = __rb_parent(__z);
         // makes __leftmost == header if __z == __root
           else
-            __leftmost = __rb_tree_node_base::minimum(__x);
+            __leftmost = __rb_tree_minimum(__x);
         if (__rightmost == __z)  
-          if (__z->left == 0)         // __z->right must be null also
-            __rightmost = __z->parent;  
+          if (__rb_left(__z) == 0)         // __rb_right(__z) must be null also
+            __rightmost = __rb_parent(__z);  
         // makes __rightmost == header if __z == __root
-          else                      // __x == __z->left
-            __rightmost = __rb_tree_node_base::maximum(__x);
+          else                      // __x == __rb_left(__z)
+            __rightmost = __rb_tree_maximum(__x);
       }
-      if (__y->color != __rb_tree_red) { 
-        while (__x != __root && (__x == 0 || __x->color == __rb_tree_black))
-          if (__x == __x_parent->left) {
-            __rb_tree_node_base* __w = __x_parent->right;
-            if (__w->color == __rb_tree_red) {
-              __w->color = __rb_tree_black;
-              __x_parent->color = __rb_tree_red;
-              __rb_tree_rotate_left(__x_parent, __root);
-              __w = __x_parent->right;
-            }
-            if ((__w->left == 0 || 
-                 __w->left->color == __rb_tree_black) &&
-                (__w->right == 0 || 
-                 __w->right->color == __rb_tree_black)) {
-              __w->color = __rb_tree_red;
+      // 树形已重新连结：自 __x_parent（结构有变化的最低节点）向上更新附加数据
+      if (__update && __x_parent != 0)
+        __rb_tree_update_to_root(__x_parent, __root, __update);
+      if (__rb_color(__y) != __rb_tree_red) { 
+        while (__x != __root && (__x == 0 || __rb_color(__x) == __rb_tree_black))
+          if (__x == __rb_left(__x_parent)) {
+            Base* __w = __rb_right(__x_parent);
+            if (__rb_color(__w) == __rb_tree_red) {
+              __rb_color(__w) = __rb_tree_black;
+              __rb_color(__x_parent) = __rb_tree_red;
+              __rb_tree_rotate_left(__x_parent, __root, __update);
+              __w = __rb_right(__x_parent);
+            }
+            if ((__rb_left(__w) == 0 || 
+                 __rb_color(__rb_left(__w)) == __rb_tree_black) &&
+                (__rb_right(__w) == 0 || 
+                 __rb_color(__rb_right(__w)) == __rb_tree_black)) {
+              __rb_color(__w) = __rb_tree_red;
               __x = __x_parent;
-              __x_parent = __x_parent->parent;
+              __x_parent = __rb_parent(__x_parent);
             } else {
-              if (__w->right == 0 || 
-                  __w->right->color == __rb_tree_black) {
-                if (__w->left) __w->left->color = __rb_tree_black;
-                __w->color = __rb_tree_red;
-                __rb_tree_rotate_right(__w, __root);
-                __w = __x_parent->right;
+              if (__rb_right(__w) == 0 || 
+                  __rb_color(__rb_right(__w)) == __rb_tree_black) {
+                if (__rb_left(__w)) __rb_color(__rb_left(__w)) = __rb_tree_black;
+                __rb_color(__w) = __rb_tree_red;
+                __rb_tree_rotate_right(__w, __root, __update);
+                __w = __rb_right(__x_parent);
               }
-              __w->color = __x_parent->color;
-              __x_parent->color = __rb_tree_black;
-              if (__w->right) __w->right->color = __rb_tree_black;
-              __rb_tree_rotate_left(__x_parent, __root);
+              __rb_color(__w) = __rb_color(__x_parent);
+              __rb_color(__x_parent) = __rb_tree_black;
+              if (__rb_right(__w)) __rb_color(__rb_right(__w)) = __rb_tree_black;
+              __rb_tree_rotate_left(__x_parent, __root, __update);
               break;
             }
           } else {                  // same as above, with right <-> left.
-            __rb_tree_node_base* __w = __x_parent->left;
-            if (__w->color == __rb_tree_red) {
-              __w->color = __rb_tree_black;
-              __x_parent->color = __rb_tree_red;
-              __rb_tree_rotate_right(__x_parent, __root);
-              __w = __x_parent->left;
-            }
-            if ((__w->right == 0 || 
-                 __w->right->color == __rb_tree_black) &&
-                (__w->left == 0 || 
-                 __w->left->color == __rb_tree_black)) {
-              __w->color = __rb_tree_red;
+            Base* __w = __rb_left(__x_parent);
+            if (__rb_color(__w) == __rb_tree_red) {
+              __rb_color(__w) = __rb_tree_black;
+              __rb_color(__x_parent) = __rb_tree_red;
+              __rb_tree_rotate_right(__x_parent, __root, __update);
+              __w = __rb_left(__x_parent);
+            }
+            if ((__rb_right(__w) == 0 || 
+                 __rb_color(__rb_right(__w)) == __rb_tree_black) &&
+                (__rb_left(__w) == 0 || 
+                 __rb_color(__rb_left(__w)) == __rb_tree_black)) {
+              __rb_color(__w) = __rb_tree_red;
               __x = __x_parent;
-              __x_parent = __x_parent->parent;
+              __x_parent = __rb_parent(__x_parent);
             } else {
-              if (__w->left == 0 || 
-                  __w->left->color == __rb_tree_black) {
-                if (__w->right) __w->right->color = __rb_tree_black;
-                __w->color = __rb_tree_red;
-                __rb_tree_rotate_left(__w, __root);
-                __w = __x_parent->left;
+              if (__rb_left(__w) == 0 || 
+                  __rb_color(__rb_left(__w)) == __rb_tree_black) {
+                if (__rb_right(__w)) __rb_color(__rb_right(__w)) = __rb_tree_black;
+                __rb_color(__w) = __rb_tree_red;
+                __rb_tree_rotate_left(__w, __root, __update);
+                __w = __rb_left(__x_parent);
               }
-              __w->color = __x_parent->color;
-              __x_parent->color = __rb_tree_black;
-              if (__w->left) __w->left->color = __rb_tree_black;
-              __rb_tree_rotate_right(__x_parent, __root);
+              __rb_color(__w) = __rb_color(__x_parent);
+              __rb_color(__x_parent) = __rb_tree_black;
+              if (__rb_left(__w)) __rb_color(__rb_left(__w)) = __rb_tree_black;
+              __rb_tree_rotate_right(__x_parent, __root, __update);
               break;
             }
           }
-        if (__x) __x->color = __rb_tree_black;
+        if (__x) __rb_color(__x) = __rb_tree_black;
       }
       return __y;
     }
 
-    template <class _Key, class _Value, class _KeyOfValue, 
-          class _Compare, class _Alloc>
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>& 
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
-      ::operator=(const rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>& __x)
+    // join 须借助上面的 __rb_tree_rebalance / __rb_tree_rebalance_for_erase，故置于此处
+    // 以单一节点 k 连接两棵独立的树 l、r（l 中所有元素 < k < r 中所有元素），
+    // lh、rh 为其黑高。传回新树之根，h 为新树的黑高。O(|lh - rh| + 1)
+    template <class Base>
+    inline Base*
+    __rb_tree_join(Base* l, size_t lh, Base* k, Base* r, size_t rh, size_t& h,
+                   typename __rb_tree_update<Base>::fn update = 0)
     {
-        if (this != &__x) {
-            // Note that _Key may be a constant type.
-            clear();
-            node_count = 0;
-            key_compare = __x.key_compare;        
-            if (__x.root() == 0) {
-                root() = 0;
-                leftmost() = header;
-                rightmost() = header;
+        if (lh == rh)
+        {
+            // 黑高相同：k 直接成为新根
+            __rb_parent(k) = 0;
+            __rb_left(k) = l;
+            __rb_right(k) = r;
+            if (l) __rb_parent(l) = k;
+            if (r) __rb_parent(r) = k;
+            __rb_color(k) = __rb_tree_black;
+            if (update)
+                update(k);
+            h = lh + 1;
+            return k;
+        }
+
+        Base* root;
+        Base* p = 0;
+        if (lh > rh)
+        {
+            // 沿 l 的右侧往下，找到黑高等于 rh 的黑节点（或空节点）c，以 k 取代 c 的位置
+            root = l;
+            Base* c = l;
+            size_t ch = lh;
+            while (c != 0 && !(__rb_color(c) == __rb_tree_black && ch == rh))
+            {
+                if (__rb_color(c) == __rb_tree_black)
+                    --ch;
+                p = c;
+                c = __rb_right(c);
             }
-            else {
-                root() = _M_copy(__x.root(), header);
-                leftmost() = minimum(root());
-                rightmost() = maximum(root());
-                node_count = __x.node_count;
+            __rb_left(k) = c;
+            __rb_right(k) = r;
+            __rb_right(p) = k;
+            h = lh;
+        }
+        else
+        {
+            // 对称地，沿 r 的左侧往下
+            root = r;
+            Base* c = r;
+            size_t ch = rh;
+            while (c != 0 && !(__rb_color(c) == __rb_tree_black && ch == lh))
+            {
+                if (__rb_color(c) == __rb_tree_black)
+                    --ch;
+                p = c;
+                c = __rb_left(c);
             }
+            __rb_left(k) = l;
+            __rb_right(k) = c;
+            __rb_left(p) = k;
+            h = rh;
+        }
+        __rb_parent(k) = p;
+        if (__rb_left(k)) __rb_parent(__rb_left(k)) = k;
+        if (__rb_right(k)) __rb_parent(__rb_right(k)) = k;
+        // k 视为新插入的红色节点，照插入的方式重新平衡（沿途的附加数据也一并更新）
+        if (__rb_tree_rebalance(k, root, update))
+            ++h;
+        return root;
+    }
+
+    // 连接两棵独立的树 l、r（l 中所有元素 < r 中所有元素），取 r 的最小节点作为中间节点
+    template <class Base>
+    inline Base*
+    __rb_tree_join2(Base* l, size_t lh, Base* r, size_t rh, size_t& h,
+                    typename __rb_tree_update<Base>::fn update = 0)
+    {
+        if (l == 0)
+        {
+            h = rh;
+            return r;
+        }
+        if (r == 0)
+        {
+            h = lh;
+            return l;
+        }
+        Base* k = __rb_tree_minimum(r);
+        Base* lm = k;
+        Base* rm = __rb_tree_maximum(r);
+        __rb_tree_rebalance_for_erase(k, r, lm, rm, update);
+        return __rb_tree_join(l, lh, k, r, __rb_tree_black_height(r), h, update);
+    }
+
+
+    // 不经重新平衡，直接删除以 __x 为根的整棵子树（__free_nodes 为 false 时只析构值，不释放节点），
+    // 传回删除的节点个数。不递归，也不改动任何节点的连结
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::size_type
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__erase(link_type __x, bool __free_nodes)
+    {
+      // 先序：取出左右子节点后随即删除自己，右子节点记在数组里留待稍后，自己往左走。
+      // 每个节点只读一次；数组中的节点都是目前路径上某个祖先的右子节点，
+      // 而 RB-tree 的高度不超过 2log(n+1)，故数组的大小足以应付任何节点数
+      link_type __stack[2 * sizeof(size_type) * 8];
+      size_type __n = 0, __count = 0;
+      for (;;) {
+        if (__x == 0) {
+          if (__n == 0)
+            return __count;
+          __x = __stack[--__n];
         }
+        ++__count;
+        link_type __l = left(__x), __r = right(__x);
+        if (__free_nodes)
+          destroy_node(__x);
+        else
+          destroy(&__x->value_field);
+        if (__r != 0)
+          __stack[__n++] = __r;
+        __x = __l;
+      }
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    template <class _ForwardIterator>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__assign_sorted(_ForwardIterator __first, _ForwardIterator __last, bool __unique)
+    {
+      clear();
+      // 第一遍：计算（去重后的）元素个数
+      size_type __n = 0;
+      _ForwardIterator __prev = __first;
+      for (_ForwardIterator __it = __first; __it != __last; __prev = __it, ++__it)
+        if (__n == 0 || !__unique ||
+            key_compare(_KeyOfValue()(*__prev), _KeyOfValue()(*__it)))
+          ++__n;
+      if (__n == 0)
+        return;
+
+      // 前 floor(log2(n+1)) 层是满的，最底下那一层（若不满）着红色，其余皆黑，
+      // 于是每条路径的黑色节点数相同，且红色节点没有红色子节点
+      size_type __red_depth = 0;
+      while ((size_type(2) << __red_depth) <= __n + 1)
+        ++__red_depth;
+
+      // 第二遍：按中序建树，节点也就按键值顺序配置
+      root() = __build_sorted(__first, __last, __n, 0, __red_depth, __unique);
+      parent(root()) = header;
+      leftmost() = minimum(root());
+      rightmost() = maximum(root());
+      node_count = __n;
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    template <class _ForwardIterator>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::link_type
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__build_sorted(_ForwardIterator& __first, _ForwardIterator __last, size_type __n,
+                       size_type __depth, size_type __red_depth, bool __unique)
+    {
+      if (__n == 0)
+        return 0;
+      size_type __nl = (__n - 1) / 2;     // 左右子树的节点数至多相差 1
+      // 构造元素时抛出异常：已建好的子树还没有接上 root()，须在这里删除（与 btree 的 copy_subtree 相同）
+      link_type __l = __build_sorted(__first, __last, __nl, __depth + 1, __red_depth, __unique);
+      link_type __x;
+      try {
+        __x = create_node(*__first);
+      }
+      catch (...) {
+        if (__l) __erase(__l);
+        throw;
+      }
+      color(__x) = __depth == __red_depth ? __rb_tree_red : __rb_tree_black;
+      left(__x) = __l;
+      right(__x) = 0;
+      if (__l) parent(__l) = __x;
+      link_type __r;
+      try {
+        for (++__first; __unique && __first != __last &&
+                        !key_compare(key(__x), _KeyOfValue()(*__first)); ++__first)
+          ;   // 跳过重复的键值
+        __r = __build_sorted(__first, __last, __n - 1 - __nl, __depth + 1, __red_depth, __unique);
+      }
+      catch (...) {
+        __erase(__x);     // 连同左子树一起删除
+        throw;
+      }
+      right(__x) = __r;
+      if (__r) parent(__r) = __x;
+      update_type __update = rb_tree_node::update_fn();
+      if (__update)
+        __update(__x);
+      return __x;
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+          class _Compare, class _Alloc,
+              template <class> class _Node>
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>& 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::operator=(const rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>& __x)
+    {
+        if (this != &__x)
+            copy_from(__x, 0);
         return *this;
     }
 
-    template <class _Key, class _Val, class _KoV, class _Compare, class _Alloc>
-    typename rb_tree<_Key, _Val, _KoV, _Compare, _Alloc>::link_type 
-    rb_tree<_Key,_Val,_KoV,_Compare,_Alloc>
+    template <class _Key, class _Value, class _KeyOfValue, 
+          class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::copy_from(const rb_tree& __x, unsigned __parallel_depth)
+    {
+        if (this == &__x)
+            return;
+        // Note that _Key may be a constant type.
+        clear();
+        node_count = 0;
+        key_compare = __x.key_compare;        
+        if (__x.root() == 0) {
+            root() = 0;
+            leftmost() = header;
+            rightmost() = header;
+        }
+        else {
+            if (__parallel_depth > 0) {
+                std::mutex __mu;
+                __node_batch __nodes(this, &__mu);
+                root() = __parallel_copy(__x.root(), header,
+                                         __rb_tree_black_height(base_ptr(__x.root())),
+                                         __parallel_depth, __nodes);
+            }
+            else
+                root() = _M_copy(__x.root(), header);
+            leftmost() = minimum(root());
+            rightmost() = maximum(root());
+            node_count = __x.node_count;
+        }
+    }
+
+    template <class _Key, class _Val, class _KoV, class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key, _Val, _KoV, _Compare, _Alloc, _Node>::link_type 
+    rb_tree<_Key,_Val,_KoV,_Compare,_Alloc,_Node>
       ::_M_copy(link_type __x, link_type __p)
+    {
+      __node_batch __nodes(this, 0);
+      return __copy(__x, __p, __nodes);
+    }
+
+    template <class _Key, class _Val, class _KoV, class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key, _Val, _KoV, _Compare, _Alloc, _Node>::link_type 
+    rb_tree<_Key,_Val,_KoV,_Compare,_Alloc,_Node>
+      ::__copy(link_type __x, link_type __p, __node_batch& __nodes)
     {
                             // structural copy.  __x and __p must be non-null.
-      link_type __top = clone_node(__x);
-      __top->_M_parent = __p;
+      link_type __top = clone_node(__x, __nodes.get());
+      parent(__top) = __p;
     
-        if (__x->_M_right)
-          __top->_M_right = _M_copy(right(__x), __top);
+        if (right(__x))
+          right(__top) = __copy(right(__x), __top, __nodes);
         __p = __top;
         __x = left(__x);
     
         while (__x != 0) {
-          link_type __y = clone_node(__x);
-          __p->_M_left = __y;
-          __y->_M_parent = __p;
-          if (__x->_M_right)
-            __y->_M_right = _M_copy(right(__x), __y);
+          link_type __y = clone_node(__x, __nodes.get());
+          left(__p) = __y;
+          parent(__y) = __p;
+          if (right(__x))
+            right(__y) = __copy(right(__x), __y, __nodes);
           __p = __y;
           __x = left(__x);
         }
+
+        // 左侧一路复制下来的节点，其附加数据须自下而上重新计算
+        update_type __update = rb_tree_node::update_fn();
+        if (__update)
+          for (base_ptr __q = __p; ; __q = parent(__q)) {
+            __update(__q);
+            if (__q == __top) break;
+          }
+      return __top;
+    }
+
+    // 复制子树 __x（黑高 __h）：右子树交给另一个线程，本线程复制左子树，两边都完成后再更新 __top。
+    // 子树够小或已到 __depth 层时改由 __copy 在本线程复制
+    template <class _Key, class _Val, class _KoV, class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key, _Val, _KoV, _Compare, _Alloc, _Node>::link_type 
+    rb_tree<_Key,_Val,_KoV,_Compare,_Alloc,_Node>
+      ::__parallel_copy(link_type __x, link_type __p, size_t __h, unsigned __depth,
+                        __node_batch& __nodes)
+    {
+      if (__depth == 0 || __h < __parallel_min_height)
+        return __copy(__x, __p, __nodes);
+      link_type __top = clone_node(__x, __nodes.get());
+      parent(__top) = __p;
+      size_t __ch = __h - (color(__x) == __rb_tree_black ? 1 : 0);
+      link_type __l = left(__x), __r = right(__x);
+      std::future<link_type> __f;
+      if (__r != 0)
+        __f = std::async(std::launch::async, [&]() {
+          __node_batch __local(this, __nodes.mu);
+          return __parallel_copy(__r, __top, __ch, __depth - 1, __local);
+        });
+      if (__l != 0)
+        left(__top) = __parallel_copy(__l, __top, __ch, __depth - 1, __nodes);
+      if (__r != 0)
+        right(__top) = __f.get();
+      update_type __update = rb_tree_node::update_fn();
+      if (__update)
+        __update(__top);
       return __top;
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-          class _Compare, class _Alloc>
-    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::iterator 
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::find(const key_type &k)
+          class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::iterator 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::find(const key_type &k)
     {
         link_type y = header;   // last node which is not less than k
         link_type x = root();   // current node
@@ -811,9 +2253,10 @@ namespace SimpleSTL
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-          class _Compare, class _Alloc>
-    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::const_iterator 
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::find(const key_type &k) const
+          class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::const_iterator 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::find(const key_type &k) const
     {
         link_type y = header;   // last node which is not less than k
         link_type x = root();   // current node
@@ -830,21 +2273,22 @@ namespace SimpleSTL
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-          class _Compare, class _Alloc>
-    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::size_type 
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
+          class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::size_type 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
       ::count(const key_type& __k) const
     {
-        pair<const_iterator, const_iterator> __p = equal_range(__k);
-        size_type __n = 0;
-        distance(__p.first, __p.second, __n);
-        return __n;
+        __counter __c;
+        __visit_range(__k, __k, true, __c);
+        return __c.n;
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-              class _Compare, class _Alloc>
-    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::iterator 
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::iterator 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
       ::lower_bound(const _Key& __k)
     {
       link_type __y = header; /* Last node which is not less than __k. */
@@ -860,9 +2304,10 @@ namespace SimpleSTL
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-              class _Compare, class _Alloc>
-    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::const_iterator 
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::const_iterator 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
       ::lower_bound(const _Key& __k) const
     {
       link_type __y = header; /* Last node which is not less than __k. */
@@ -878,9 +2323,10 @@ namespace SimpleSTL
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-              class _Compare, class _Alloc>
-    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::iterator 
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::iterator 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
       ::upper_bound(const _Key& __k)
     {
       link_type __y = header; /* Last node which is greater than __k. */
@@ -896,9 +2342,10 @@ namespace SimpleSTL
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-              class _Compare, class _Alloc>
-    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::const_iterator 
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::const_iterator 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
       ::upper_bound(const _Key& __k) const
     {
       link_type __y = header; /* Last node which is greater than __k. */
@@ -914,25 +2361,421 @@ namespace SimpleSTL
     }
 
     template <class _Key, class _Value, class _KeyOfValue, 
-              class _Compare, class _Alloc>
+              class _Compare, class _Alloc,
+              template <class> class _Node>
     inline 
-    std::pair<typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::iterator,
-         typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>::iterator>
-    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc>
+    std::pair<typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::iterator,
+         typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::iterator>
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
       ::equal_range(const _Key& __k)
     {
       return pair<iterator, iterator>(lower_bound(__k), upper_bound(__k));
     }
 
-    template <class _Key, class _Value, class _KoV, class _Compare, class _Alloc>
+    template <class _Key, class _Value, class _KoV, class _Compare, class _Alloc,
+              template <class> class _Node>
     inline 
-    std::pair<typename rb_tree<_Key, _Value, _KoV, _Compare, _Alloc>::const_iterator,
-         typename rb_tree<_Key, _Value, _KoV, _Compare, _Alloc>::const_iterator >
-    rb_tree<_Key, _Value, _KoV, _Compare, _Alloc>
+    std::pair<typename rb_tree<_Key, _Value, _KoV, _Compare, _Alloc, _Node>::const_iterator,
+         typename rb_tree<_Key, _Value, _KoV, _Compare, _Alloc, _Node>::const_iterator >
+    rb_tree<_Key, _Value, _KoV, _Compare, _Alloc, _Node>
       ::equal_range(const _Key& __k) const
     {
       return pair<const_iterator,const_iterator>(lower_bound(__k),
                                                  upper_bound(__k));
     }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::size_type 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::rank(const _Key& __k) const
+    {
+      size_type __r = 0;
+      link_type __x = root();
+      while (__x != 0)
+        if (key_compare(key(__x), __k)) {
+          // __x 及其左子树皆小于 __k
+          __r += subtree_size(left(__x)) + 1;
+          __x = right(__x);
+        }
+        else
+          __x = left(__x);
+      return __r;
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::iterator 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::select(size_type __n) const
+    {
+      link_type __x = root();
+      while (__x != 0) {
+        size_type __l = subtree_size(left(__x));
+        if (__n < __l)
+          __x = left(__x);
+        else if (__n == __l)
+          return iterator(__x);
+        else {
+          __n -= __l + 1;
+          __x = right(__x);
+        }
+      }
+      return end();
+    }
+
+    // 节点 __x 的序号（中序排名，从 0 起算）；header（即 end()）的序号为 size()
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::size_type 
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::position(base_ptr __x) const
+    {
+      if (__x == header)
+        return node_count;
+      size_type __r = subtree_size(left(__x));
+      for (base_ptr __y = __x; __y != root(); __y = parent(__y))
+        if (__y == right(parent(__y)))     // 自右侧上溯，父节点及其左子树都排在前面
+          __r += subtree_size(left(parent(__y))) + 1;
+      return __r;
+    }
+
+    // 树形被 split / join 改动之后，重新计算 __a、__b 的元素个数（两者合计 __total 个）
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__recount(rb_tree& __a, rb_tree& __b, size_type __total)
+    {
+      size_type __n = __rb_tree_size_hint((link_type)0, base_ptr(__a.root()));
+      if (__n == size_type(-1)) {
+        // 两棵树同步走访，较小的一棵走完即可得知两者的大小
+        iterator __i = __a.begin(), __j = __b.begin();
+        __n = 0;
+        while (__i != __a.end() && __j != __b.end()) {
+          ++__i; ++__j; ++__n;
+        }
+        if (__i != __a.end())
+          __n = __total - __n;
+      }
+      __a.node_count = __n;
+      __b.node_count = __total - __n;
+    }
+
+    // 把独立的节点 __z 接到本树的最右端（__z 不小于树中任何元素）
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__append_node(base_ptr __z)
+    {
+      left(__z) = 0;
+      right(__z) = 0;
+      if (node_count == 0) {
+        parent(__z) = header;
+        root() = (link_type)__z;
+        leftmost() = (link_type)__z;
+      }
+      else {
+        parent(__z) = rightmost();
+        right(rightmost()) = __z;
+      }
+      rightmost() = (link_type)__z;
+      __rebalance(__z);
+      ++node_count;
+    }
+
+    // 销毁以 parent 指针串起来的一串子树，传回销毁的节点数
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::size_type
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__destroy_chain(base_ptr __chain)
+    {
+      size_type __n = 0;
+      while (__chain != 0) {
+        base_ptr __next = parent(__chain);
+        __n += __erase((link_type)__chain);
+        __chain = __next;
+      }
+      return __n;
+    }
+
+    // 把独立的树 __x（黑高 __h）分为两棵独立的树：__l 中的键值皆小于 __k
+    //（__upper 时为不大于 __k），其余在 __r
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__split(base_ptr __x, size_t __h, const _Key& __k,
+                base_ptr& __l, size_t& __lh, base_ptr& __r, size_t& __rh, bool __upper) const
+    {
+      if (__x == 0) {
+        __l = __r = 0;
+        __lh = __rh = 0;
+        return;
+      }
+      size_t __ch = __h - (color(__x) == __rb_tree_black ? 1 : 0);
+      size_t __Lh = __ch, __Rh = __ch;
+      base_ptr __L = __rb_tree_make_root(base_ptr(left(__x)), __Lh);
+      base_ptr __R = __rb_tree_make_root(base_ptr(right(__x)), __Rh);
+      update_type __update = rb_tree_node::update_fn();
+      base_ptr __m;
+      size_t __mh;
+      if (__upper ? !key_compare(__k, key(__x)) : key_compare(key(__x), __k)) {
+        __split(__R, __Rh, __k, __m, __mh, __r, __rh, __upper);
+        __l = __rb_tree_join(__L, __Lh, __x, __m, __mh, __lh, __update);
+      }
+      else {
+        __split(__L, __Lh, __k, __l, __lh, __m, __mh, __upper);
+        __r = __rb_tree_join(__m, __mh, __x, __R, __Rh, __rh, __update);
+      }
+    }
+
+    // 若独立的树 __t（黑高 __h）的最小元素与 __k 相等，将它摘下并传回，否则传回 0
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::base_ptr
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__extract_min_equal(base_ptr& __t, size_t& __h, const _Key& __k) const
+    {
+      if (__t == 0)
+        return 0;
+      base_ptr __m = __rb_tree_minimum(__t);
+      if (key_compare(__k, key(__m)))
+        return 0;
+      base_ptr __lm = __m, __rm = __rb_tree_maximum(__t);
+      __rb_tree_rebalance_for_erase(__m, __t, __lm, __rm, rb_tree_node::update_fn());
+      __h = __rb_tree_black_height(__t);
+      return __m;
+    }
+
+    // 并集：__t1 来自本树，__t2 来自另一棵树。键值重复时保留 __t1 的节点，
+    // __t2 的节点依键值顺序串入 __dups
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::base_ptr
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__union(base_ptr __t1, size_t __h1, base_ptr __t2, size_t __h2,
+                size_t& __h, __rb_tree_chain<base_type>& __dups, unsigned __depth) const
+    {
+      if (__t2 == 0) { __h = __h1; return __t1; }
+      if (__t1 == 0) { __h = __h2; return __t2; }
+
+      // 以 __t2 的根为界切开 __t1，再分别合并左右两半
+      base_ptr __k = __t2;
+      size_t __ch = __h2 - (color(__k) == __rb_tree_black ? 1 : 0);
+      size_t __Lh2 = __ch, __Rh2 = __ch;
+      base_ptr __L2 = __rb_tree_make_root(base_ptr(left(__k)), __Lh2);
+      base_ptr __R2 = __rb_tree_make_root(base_ptr(right(__k)), __Rh2);
+      base_ptr __L1, __R1;
+      size_t __Lh1, __Rh1;
+      __split(__t1, __h1, key(__k), __L1, __Lh1, __R1, __Rh1);
+      base_ptr __e = __extract_min_equal(__R1, __Rh1, key(__k));
+
+      base_ptr __L, __R;
+      size_t __Lh, __Rh;
+      __rb_tree_chain<base_type> __ldups, __rdups;
+      if (__depth > 0) {
+        std::future<base_ptr> __f = std::async(std::launch::async, [&]() {
+          return __union(__L1, __Lh1, __L2, __Lh2, __Lh, __ldups, __depth - 1);
+        });
+        __R = __union(__R1, __Rh1, __R2, __Rh2, __Rh, __rdups, __depth - 1);
+        __L = __f.get();
+      }
+      else {
+        __L = __union(__L1, __Lh1, __L2, __Lh2, __Lh, __ldups, 0);
+        __R = __union(__R1, __Rh1, __R2, __Rh2, __Rh, __rdups, 0);
+      }
+
+      __dups.splice(__ldups);
+      if (__e != 0)
+        __dups.push(__k);
+      __dups.splice(__rdups);
+      return __rb_tree_join(__L, __Lh, __e != 0 ? __e : __k, __R, __Rh, __h,
+                            rb_tree_node::update_fn());
+    }
+
+    // 交集（__keep_common 为 true）或差集：__t1 来自本树，__t2 是另一棵树的子树（不会被改动）。
+    // 被剔除的节点（或整棵子树）串入 __dropped
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::base_ptr
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__filter(base_ptr __t1, size_t __h1, base_ptr __t2, bool __keep_common,
+                 size_t& __h, __rb_tree_chain<base_type>& __dropped, unsigned __depth) const
+    {
+      if (__t1 == 0) { __h = 0; return 0; }
+      if (__t2 == 0) {
+        if (__keep_common) {
+          __dropped.push(__t1);
+          __h = 0;
+          return 0;
+        }
+        __h = __h1;
+        return __t1;
+      }
+
+      base_ptr __L1, __R1;
+      size_t __Lh1, __Rh1;
+      __split(__t1, __h1, key(__t2), __L1, __Lh1, __R1, __Rh1);
+      base_ptr __e = __extract_min_equal(__R1, __Rh1, key(__t2));
+
+      base_ptr __L, __R;
+      size_t __Lh, __Rh;
+      __rb_tree_chain<base_type> __ldropped, __rdropped;
+      if (__depth > 0) {
+        std::future<base_ptr> __f = std::async(std::launch::async, [&]() {
+          return __filter(__L1, __Lh1, left(__t2), __keep_common, __Lh, __ldropped, __depth - 1);
+        });
+        __R = __filter(__R1, __Rh1, right(__t2), __keep_common, __Rh, __rdropped, __depth - 1);
+        __L = __f.get();
+      }
+      else {
+        __L = __filter(__L1, __Lh1, left(__t2), __keep_common, __Lh, __ldropped, 0);
+        __R = __filter(__R1, __Rh1, right(__t2), __keep_common, __Rh, __rdropped, 0);
+      }
+
+      __dropped.splice(__ldropped);
+      __dropped.splice(__rdropped);
+      if (__e != 0 && __keep_common)
+        return __rb_tree_join(__L, __Lh, __e, __R, __Rh, __h, rb_tree_node::update_fn());
+      if (__e != 0) {
+        left(__e) = right(__e) = 0;
+        __dropped.push(__e);
+      }
+      return __rb_tree_join2(__L, __Lh, __R, __Rh, __h, rb_tree_node::update_fn());
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::split(const _Key& __k, rb_tree& __x)
+    {
+      __x.clear();
+      __rb_tree_pool_share(node_allocator, __x.node_allocator);
+      size_type __total = node_count;
+      size_t __h, __lh, __rh;
+      base_ptr __l, __r;
+      base_ptr __t = __detach(__h);
+      __split(__t, __h, __k, __l, __lh, __r, __rh);
+      __attach(__l, 0);
+      __x.__attach(__r, 0);
+      __recount(*this, __x, __total);
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::join(rb_tree& __x)
+    {
+      if (__x.node_count == 0)
+        return;
+      __rb_tree_pool_share(node_allocator, __x.node_allocator);
+      size_type __total = node_count + __x.node_count;
+      size_t __h1, __h2, __h;
+      base_ptr __t1 = __detach(__h1);
+      base_ptr __t2 = __x.__detach(__h2);
+      __attach(__rb_tree_join2(__t1, __h1, __t2, __h2, __h, rb_tree_node::update_fn()), __total);
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::extract_range(const _Key& __lo, const _Key& __hi, rb_tree& __x)
+    {
+      rb_tree __tail(key_compare);
+      split(__lo, __x);
+      __x.split(__hi, __tail);
+      join(__tail);
+    }
+
+    // 摘下键值在 [__lo, __hi)（__closed 时为 [__lo, __hi]）之间的独立子树，把两侧接回，再销毁摘下的节点
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    typename rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>::size_type
+    rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::__erase_range(const _Key& __lo, const _Key& __hi, bool __closed)
+    {
+      if (node_count == 0)
+        return 0;
+      size_type __total = node_count;
+      size_t __h, __lh, __mh, __rh;
+      base_ptr __l, __m, __r;
+      base_ptr __t = __detach(__h);
+      __split(__t, __h, __lo, __l, __lh, __t, __h);
+      __split(__t, __h, __hi, __m, __mh, __r, __rh, __closed);
+      __attach(__rb_tree_join2(__l, __lh, __r, __rh, __h, rb_tree_node::update_fn()), 0);
+      size_type __n = __m == 0 ? 0 : __erase((link_type)__m);
+      node_count = __total - __n;
+      return __n;
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::merge_from(rb_tree& __x, unsigned __parallel_depth)
+    {
+      if (__x.node_count == 0)
+        return;
+      __rb_tree_pool_share(node_allocator, __x.node_allocator);
+      size_type __total = node_count + __x.node_count;
+      size_t __h1, __h2, __h;
+      base_ptr __t1 = __detach(__h1);
+      base_ptr __t2 = __x.__detach(__h2);
+      __rb_tree_chain<base_type> __dups;
+      __attach(__union(__t1, __h1, __t2, __h2, __h, __dups, __parallel_depth), 0);
+      // 重复的节点已按键值排序，逐一接回 __x 的最右端
+      for (base_ptr __z = __dups.head; __z != 0; ) {
+        base_ptr __next = parent(__z);
+        __x.__append_node(__z);
+        __z = __next;
+      }
+      node_count = __total - __x.node_count;
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::intersect_with(const rb_tree& __x, unsigned __parallel_depth)
+    {
+      if (node_count == 0)
+        return;
+      size_type __total = node_count;
+      size_t __h1, __h;
+      base_ptr __t1 = __detach(__h1);
+      __rb_tree_chain<base_type> __dropped;
+      __attach(__filter(__t1, __h1, __x.root(), true, __h, __dropped, __parallel_depth), 0);
+      node_count = __total - __destroy_chain(__dropped.head);
+    }
+
+    template <class _Key, class _Value, class _KeyOfValue, 
+              class _Compare, class _Alloc,
+              template <class> class _Node>
+    void rb_tree<_Key,_Value,_KeyOfValue,_Compare,_Alloc,_Node>
+      ::subtract(const rb_tree& __x, unsigned __parallel_depth)
+    {
+      if (__x.node_count == 0 || node_count == 0)
+        return;
+      size_type __total = node_count;
+      size_t __h1, __h;
+      base_ptr __t1 = __detach(__h1);
+      __rb_tree_chain<base_type> __dropped;
+      __attach(__filter(__t1, __h1, __x.root(), false, __h, __dropped, __parallel_depth), 0);
+      node_count = __total - __destroy_chain(__dropped.head);
+    }
 }
 #endif
\ No newline at end of file
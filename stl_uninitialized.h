@@ -26,8 +26,14 @@ namespace SimpleSTL
         InputIter first, InputIter last, ForwardIter result, _false_type)
     {
         ForwardIter cur = result;
-        for (; first != last; ++first, ++cur)
-            construct(&*cur, *first);
+        try {
+            for (; first != last; ++first, ++cur)
+                construct(&*cur, *first);
+        }
+        catch(...) {    // commit or rollback：析构已构造的元素
+            SimpleSTL::destroy(result, cur);
+            throw;
+        }
         return cur;
     }
 
@@ -122,6 +128,47 @@ namespace SimpleSTL
     {
         return __uninitialized_fill_n(first, n, x, value_type(first));
     }
+
+    /**************************** uninitialized_default_n ****************************/
+    // 预设初始化 n 个元素：默认构造函数是 trivial 的型别什么也不做，内存保持原来的内容
+    template <class ForwardIter, class size>
+    inline ForwardIter
+    __uninitialized_default_n_aux(ForwardIter first, size n, _true_type)
+    {
+        SimpleSTL::advance(first, n);
+        return first;
+    }
+
+    template <class ForwardIter, class size>
+    ForwardIter
+    __uninitialized_default_n_aux(ForwardIter first, size n, _false_type)
+    {
+        ForwardIter cur = first;
+        try {
+            for (; n > 0; --n, ++cur)
+                construct(&*cur);
+        }
+        catch(...) {
+            destroy(first, cur);
+            throw;
+        }
+        return cur;
+    }
+
+    template <class ForwardIter, class size, class T>
+    inline ForwardIter
+    __uninitialized_default_n(ForwardIter first, size n, T *)
+    {
+        typedef typename _type_traits<T>::has_trivial_default_constructor Trivial_ctor;
+        return __uninitialized_default_n_aux(first, n, Trivial_ctor());
+    }
+
+    template <class ForwardIter, class size>
+    inline ForwardIter
+    uninitialized_default_n(ForwardIter first, size n)
+    {
+        return __uninitialized_default_n(first, n, value_type(first));
+    }
 }
 
 #endif
\ No newline at end of file
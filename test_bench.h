@@ -0,0 +1,27 @@
+/***
+* 测试程式共用的计时工具。测试本身只以 assert 检查行为；
+* 效能比较只在以 --bench 执行时才进行，所量得的时间只印出来，不影响测试是否通过。
+*/
+#ifndef _SIMPLE_STL_TEST_BENCH_H_
+#define _SIMPLE_STL_TEST_BENCH_H_
+
+#include <chrono>
+#include <cstring>
+
+namespace SimpleSTL
+{
+    inline bool bench_requested(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; ++i)
+            if (strcmp(argv[i], "--bench") == 0)
+                return true;
+        return false;
+    }
+
+    inline double ms_since(std::chrono::steady_clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+}
+
+#endif
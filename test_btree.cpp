@@ -0,0 +1,114 @@
+// file: btree-test.cpp
+
+#include "btree_set.h"
+#include "btree_map.h"
+#include <iostream>
+#include <string>
+#include <map>
+#include <cassert>
+
+using namespace SimpleSTL;
+using namespace std;
+
+// 第 fail_at 次复制时抛出异常，live 记录存活的对象数
+static int live = 0, copies = 0, fail_at = -1;
+struct fragile
+{
+    int v;
+    fragile(int x) : v(x) { ++live; }
+    fragile(const fragile &x) : v(x.v)
+    {
+        if (++copies == fail_at)
+            throw 1;
+        ++live;
+    }
+    ~fragile() { --live; }
+    bool operator<(const fragile &x) const { return v < x.v; }
+};
+
+int main() {
+    // 每个节点只放 4 个元素，方便观察分裂与合并
+    btree_set<int, less<int>, alloc2, 4> iset;
+    for (int i = 0; i < 20; ++i)
+        iset.insert((i * 7) % 20);
+    cout << "size=" << iset.size() << endl;
+    cout << "3 count =" << iset.count(3) << endl;
+
+    btree_set<int, less<int>, alloc2, 4>::iterator ite1 = iset.begin();
+    for (; ite1 != iset.end(); ++ite1)
+        cout << *ite1 << ' ';
+    cout << endl;
+
+    iset.erase(3);
+    iset.erase(iset.lower_bound(10), iset.upper_bound(14));
+    cout << "size=" << iset.size() << endl;
+    for (ite1 = iset.begin(); ite1 != iset.end(); ++ite1)
+        cout << *ite1 << ' ';
+    cout << endl;
+
+    ite1 = iset.find(3);
+    if (ite1 == iset.end())
+        cout << "3 not found" << endl;
+
+    // 默认的 fan-out：顺序插入时每个节点都会被填满
+    btree_set<int> big;
+    for (int i = 0; i < 1000000; ++i)
+        big.insert(big.end(), i);
+    cout << "size=" << big.size() << endl;
+    cout << "999999 found=" << (big.find(999999) != big.end()) << endl;
+
+    btree_map<string, int> simap;
+    simap[string("jjhou")] = 1;
+    simap[string("jerry")] = 2;
+    simap[string("jason")] = 3;
+    simap[string("jimmy")] = 4;
+    simap.insert(pair<string, int>(string("david"), 5));
+    btree_map<string, int>::iterator simap_iter = simap.begin();
+    for (; simap_iter != simap.end(); ++simap_iter)
+        cout << simap_iter->first << ' ' << simap_iter->second << endl;
+
+    btree_multimap<int, string> mm;
+    mm.insert(pair<int, string>(1, "a"));
+    mm.insert(pair<int, string>(1, "b"));
+    mm.insert(pair<int, string>(2, "c"));
+    cout << "1 count =" << mm.count(1) << endl;
+
+    // 复制构造与赋值：与 std::map 逐一比较（<map> 也在本档案中，std::pair 的 ADL 不得造成歧义）
+    btree_map<string, int, less<string>, alloc2, 4> bm;
+    std::map<string, int> ref;
+    for (int i = 0; i < 200; ++i)
+        bm[to_string(i * 37 % 200)] = ref[to_string(i * 37 % 200)] = i;
+    btree_map<string, int, less<string>, alloc2, 4> bm2(bm), bm3;
+    bm3 = bm;
+    bm.clear();
+    bm3.erase(string("5"));
+    ref.erase(string("5"));
+    assert(bm2.size() == 200 && bm3.size() == ref.size());
+    std::map<string, int>::iterator r = ref.begin();
+    for (btree_map<string, int, less<string>, alloc2, 4>::iterator it = bm3.begin(); it != bm3.end(); ++it, ++r)
+        assert(it->first == r->first && it->second == r->second);
+    cout << "copy size=" << bm2.size() << " assigned size=" << bm3.size() << endl;
+
+    // 复制到一半抛出异常：已复制的节点都要释放，被赋值的一方保持原状
+    {
+        btree_set<fragile, less<fragile>, alloc2, 4> fs, target;
+        for (int i = 0; i < 100; ++i)
+            fs.insert(fragile(i));
+        target.insert(fragile(-1));
+        const int before = live;
+        for (fail_at = 1; fail_at <= 100; fail_at += 7)
+        {
+            copies = 0;
+            try {
+                target = fs;
+                assert(false);
+            }
+            catch (int) {}
+            assert(live == before);
+            assert(target.size() == 1 && target.begin()->v == -1);
+        }
+        fail_at = -1;
+    }
+    assert(live == 0);
+    cout << "copy is exception safe" << endl;
+}
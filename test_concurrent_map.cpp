@@ -0,0 +1,232 @@
+// concurrent_map：无锁跳表，多个线程同时插入、删除、查找，结果与 std::map 比对
+// 线程数依序为 1、2、4……，最后一定是 N（hardware_concurrency，至少为 4）；
+// 以 --bench 执行时另外以同样的线程数比较无锁跳表与以 mutex 保护的 map 的吞吐量
+
+#include "concurrent_map.h"
+#include "concurrent_set.h"
+#include "map.h"
+#include "test_bench.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <map>
+#include <cassert>
+
+using namespace SimpleSTL;
+using namespace std;
+
+typedef SimpleSTL::concurrent_map<int, int> cmap;
+
+// 1、2、4……小于 n 的 2 的幂，最后加上 n 本身
+std::vector<unsigned> thread_counts(unsigned n)
+{
+    std::vector<unsigned> counts;
+    for (unsigned threads = 1; threads < n; threads *= 2)
+        counts.push_back(threads);
+    counts.push_back(n);
+    return counts;
+}
+
+unsigned next_random(unsigned &seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+// 每个线程只改动 k % threads == t 的键值，并以自己的 std::map 记录预期的内容；
+// 查找也只查自己的键值，结果必须与记录相符。全部结束后合并各线程的记录与跳表比对
+void disjoint_updates(unsigned threads, int range, int ops)
+{
+    cmap c;
+    std::vector<std::map<int, int> > refs(threads);
+    for (int k = 0; k < range; k += 2)
+    {
+        c.insert(cmap::value_type(k, k));
+        refs[k % threads][k] = k;
+    }
+    std::vector<thread> ts;
+    for (unsigned t = 0; t < threads; ++t)
+        ts.push_back(thread([&c, &refs, t, threads, range, ops] {
+            std::map<int, int> &ref = refs[t];
+            unsigned seed = 12345 + t * 7919;
+            for (int i = 0; i < ops; ++i)
+            {
+                unsigned x = next_random(seed);
+                int k = int(x % (range / threads)) * threads + t;
+                switch (x >> 16 & 3)
+                {
+                case 0:
+                    assert(c.insert(cmap::value_type(k, i)).second == ref.insert(make_pair(k, i)).second);
+                    break;
+                case 1:
+                    assert(c.erase(k) == ref.erase(k));
+                    break;
+                default: {
+                    cmap::const_iterator it = c.find(k);
+                    std::map<int, int>::iterator r = ref.find(k);
+                    assert((it == c.end()) == (r == ref.end()));
+                    assert(it == c.end() || it->second == r->second);
+                }
+                }
+            }
+        }));
+    for (size_t t = 0; t < ts.size(); ++t)
+        ts[t].join();
+
+    std::map<int, int> all;
+    for (unsigned t = 0; t < threads; ++t)
+        all.insert(refs[t].begin(), refs[t].end());
+    assert(c.size() == all.size());
+    std::map<int, int>::iterator r = all.begin();
+    for (cmap::const_iterator it = c.begin(); it != c.end(); ++it, ++r)
+        assert(r != all.end() && it->first == r->first && it->second == r->second);
+    assert(r == all.end());
+}
+
+// 所有线程插入、再删除同一批键值：每个键值恰好一个线程插入成功、恰好一个线程删除成功
+void contended_updates(unsigned threads, int keys)
+{
+    SimpleSTL::concurrent_set<int> s;
+    atomic<long> inserted(0), erased(0);
+    std::vector<thread> ts;
+    for (unsigned t = 0; t < threads; ++t)
+        ts.push_back(thread([&s, &inserted, t, keys] {
+            long n = 0;
+            for (int i = 0; i < keys; ++i)
+                n += s.insert((i + t * 97) % keys).second;
+            inserted += n;
+        }));
+    for (size_t t = 0; t < ts.size(); ++t)
+        ts[t].join();
+    assert(inserted == keys && s.size() == size_t(keys));
+    int expected = 0;
+    for (SimpleSTL::concurrent_set<int>::iterator it = s.begin(); it != s.end(); ++it)
+        assert(*it == expected++);
+    assert(expected == keys);
+
+    ts.clear();
+    for (unsigned t = 0; t < threads; ++t)
+        ts.push_back(thread([&s, &erased, t, keys] {
+            long n = 0;
+            for (int i = keys; i-- > 0; )
+                n += s.erase((i + t * 31) % keys);
+            erased += n;
+        }));
+    for (size_t t = 0; t < ts.size(); ++t)
+        ts[t].join();
+    assert(erased == keys && s.empty() && s.begin() == s.end());
+}
+
+// 每个线程做 ops 次操作：一半查找，四分之一插入，四分之一删除，键值随机落在 [0, range)
+template <class Op>
+double run(int threads, int ops, Op op)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    std::vector<thread> ts;
+    for (int t = 0; t < threads; ++t)
+        ts.push_back(thread([=] {
+            unsigned seed = 12345 + t * 7919;
+            for (int i = 0; i < ops; ++i)
+                op(next_random(seed));
+        }));
+    for (size_t t = 0; t < ts.size(); ++t)
+        ts[t].join();
+    return threads * ops / (ms_since(start) / 1000) / 1e6;
+}
+
+// 吞吐量：无锁跳表对照以 mutex 保护的 map
+void bench(const std::vector<unsigned> &counts)
+{
+    const int ops = 200000, range = 1 << 16;
+    cout << "threads  skiplist Mops/s  map+mutex Mops/s" << endl;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        cmap c;
+        SimpleSTL::map<int, int> b;
+        mutex mu;
+        for (int k = 0; k < range; k += 2)
+        {
+            c.insert(cmap::value_type(k, k));
+            b[k] = k;
+        }
+        double r1 = run(counts[i], ops, [&c](unsigned x) {
+            int k = x % range;
+            switch (x >> 16 & 3)
+            {
+            case 0: c.insert(cmap::value_type(k, k)); break;
+            case 1: c.erase(k); break;
+            default: c.find(k); break;
+            }
+        });
+        double r2 = run(counts[i], ops, [&b, &mu](unsigned x) {
+            int k = x % range;
+            lock_guard<mutex> g(mu);
+            switch (x >> 16 & 3)
+            {
+            case 0: b.insert(SimpleSTL::map<int, int>::value_type(k, k)); break;
+            case 1: b.erase(k); break;
+            default: b.find(k); break;
+            }
+        });
+        cout << counts[i] << "\t " << r1 << "\t\t  " << r2 << endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    cmap m;
+    for (int i = 0; i < 10; ++i)
+        m.insert(cmap::value_type(i * 10, i));
+    m.erase(30);
+    cout << "m(" << m.size() << "): ";
+    for (cmap::const_iterator it = m.begin(); it != m.end(); ++it)
+        cout << it->first << "=" << it->second << ' ';
+    cout << endl;
+    assert(m.size() == 9 && m.count(30) == 0 && m.count(40) == 1);
+    assert(m.lower_bound(25)->first == 40 && m.upper_bound(40)->first == 50);
+    assert(m.equal_range(50).first->second == 5 && m.find(35) == m.end());
+    assert(!m.insert(cmap::value_type(40, 99)).second && m.find(40)->second == 4);
+
+    // 四个线程各自插入一段键值，同时另外两个线程删除偶数键
+    SimpleSTL::concurrent_set<int> s;
+    std::vector<thread> ts;
+    for (int t = 0; t < 4; ++t)
+        ts.push_back(thread([&s, t] {
+            for (int i = t * 25000; i < (t + 1) * 25000; ++i)
+                s.insert(i);
+        }));
+    for (int t = 0; t < 2; ++t)
+        ts.push_back(thread([&s, t] {
+            for (int pass = 0; pass < 3; ++pass)
+                for (int i = t * 2; i < 100000; i += 4)
+                    s.erase(i);
+        }));
+    for (size_t t = 0; t < ts.size(); ++t)
+        ts[t].join();
+    for (int i = 0; i < 100000; i += 2)
+        s.erase(i);
+    int expected = 1;
+    for (SimpleSTL::concurrent_set<int>::iterator it = s.begin(); it != s.end(); ++it, expected += 2)
+        assert(*it == expected);
+    assert(expected == 100001);
+    cout << "odd keys left: " << s.size() << endl;
+
+    unsigned n = thread::hardware_concurrency();
+    if (n < 4)
+        n = 4;
+    std::vector<unsigned> counts = thread_counts(n);
+    assert(counts.back() == n);
+    assert(thread_counts(6).size() == 4 && thread_counts(6).back() == 6);   // 1 2 4 6
+    assert(thread_counts(8).size() == 4 && thread_counts(8).back() == 8);   // 1 2 4 8
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        disjoint_updates(counts[i], 1 << 14, 50000);
+        contended_updates(counts[i], 20000);
+    }
+    cout << "ok" << endl;
+
+    if (bench_requested(argc, argv))
+        bench(counts);
+}
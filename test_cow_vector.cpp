@@ -0,0 +1,85 @@
+// cow_vector：复制只增加引用计数，第一次修改时才真正复制元素
+
+#include "cow_vector.h"
+#include <iostream>
+#include <vector>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+void check(const cow_vector<long> &v, const std::vector<long> &ref)
+{
+    assert(v.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i)
+        assert(v[i] == ref[i]);
+}
+
+// 管线中只读取资料的一站：以值传入，不会复制元素
+long stage(cow_vector<long> v, const long *expected)
+{
+    assert(v.cbegin() == expected);
+    return v.as_const()[v.size() / 2];
+}
+
+int main() {
+    cow_vector<long> a(5, 1);
+    cow_vector<long> b = a;
+    cout << "after copy: shared=" << a.shared() << " use_count=" << a.use_count()
+         << " same buffer=" << (a.cbegin() == b.cbegin()) << endl;
+    assert(a.shared() && a.use_count() == 2 && a.cbegin() == b.cbegin());
+    assert(b.as_const()[0] == 1 && b.shared());    // 只读不复制
+    assert(stage(a, a.cbegin()) == 1);
+    assert(a.use_count() == 2);
+
+    b[0] = 42;      // 第一次写入：b 复制出自己的一份
+    cout << "after write: shared=" << a.shared() << " a[0]=" << a.as_const()[0]
+         << " b[0]=" << b.as_const()[0] << endl;
+    assert(!a.shared() && !b.shared());
+    check(a, std::vector<long>(5, 1));
+
+    // 可写的引用流出之后再复制：副本必须有自己的元素，经由旧的引用写入不会改到副本
+    cow_vector<long> c(3, 7);
+    long &r = c[1];
+    long *p = c.data();
+    cow_vector<long> d = c;
+    assert(!c.shared() && c.cbegin() != d.cbegin());
+    r = 100;
+    p[2] = 200;
+    check(c, {7, 100, 200});
+    check(d, {7, 7, 7});
+    cow_vector<long> e;
+    e = c;
+    *c.begin() = -1;
+    check(e, {7, 100, 200});
+
+    // clear 之后没有有效的引用，又可以共用
+    c.clear();
+    c.push_back(5);
+    cow_vector<long> f = c;
+    assert(c.shared() && f.cbegin() == c.cbegin());
+
+    // 与 std::vector 对照各种修改
+    cow_vector<long> v;
+    std::vector<long> ref;
+    for (long i = 0; i < 100; ++i)
+    {
+        v.push_back(i);
+        ref.push_back(i);
+        cow_vector<long> snapshot = v;  // 每次都留一份共用的快照，迫使下一次修改先复制
+    }
+    v.insert(v.cbegin() + 10, 3, -5);
+    ref.insert(ref.begin() + 10, 3, -5);
+    v.erase(v.cbegin() + 50, v.cbegin() + 60);
+    ref.erase(ref.begin() + 50, ref.begin() + 60);
+    v.resize(120, 9);
+    ref.resize(120, 9);
+    v.pop_back();
+    ref.pop_back();
+    check(v, ref);
+    cow_vector<long> w = v;
+    w.push_back(w.as_const()[0]);   // 引数就在共用的区块中
+    ref.push_back(ref[0]);
+    check(w, ref);
+    cout << "ok" << endl;
+}
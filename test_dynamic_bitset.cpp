@@ -0,0 +1,226 @@
+// dynamic_bitset：每个旗标只占 1 bit，集合运算与计数都一次处理整个区块
+// make test_dynamic_bitset_avx2.o 以 -mavx2 -mbmi 编译同一个测试，检查 vpshufb 计数与 tzcnt 的路径；
+// 以 --bench 执行时另外量测十亿个位元的计数、or 与稀疏搜寻的时间
+
+#include "dynamic_bitset.h"
+#include "test_bench.h"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+typedef dynamic_bitset<> bitset_type;
+typedef dynamic_bitset<__inline_alloc<4, alloc2> > inline_bitset;
+
+static_assert(is_same<_is_trivially_relocatable<bitset_type>::type, _true_type>::value,
+              "dynamic_bitset is trivially relocatable");
+static_assert(is_same<_is_trivially_relocatable<inline_bitset>::type, _false_type>::value,
+              "blocks may live inside the bitset");
+
+// 逐位元与 vector<bool> 比对，并检查 count、find_first/find_next 与 any/none/all
+template <class Bits>
+void check(const Bits &b, const std::vector<bool> &ref)
+{
+    assert(b.size() == ref.size());
+    size_t ones = 0, expected = Bits::npos;
+    for (size_t i = ref.size(); i-- > 0; )
+    {
+        assert(b.test(i) == ref[i]);
+        if (ref[i])
+        {
+            ++ones;
+            assert(b.find_next(i) == expected);
+            expected = i;
+        }
+    }
+    assert(b.find_first() == expected);
+    assert(b.count() == ones);
+    assert(b.any() == (ones != 0) && b.none() == (ones == 0) && b.all() == (ones == ref.size()));
+    assert(b.find_next(Bits::npos) == Bits::npos);
+    if (!ref.empty())
+        assert(b.find_next(ref.size() - 1) == Bits::npos);
+}
+
+template <class Bits>
+void random_ops(unsigned seed)
+{
+    srand(seed);
+    Bits b;
+    std::vector<bool> ref;
+    for (int round = 0; round < 300; ++round)
+    {
+        const size_t n = ref.size();
+        switch (rand() % 7)
+        {
+        case 0: {       // 一段范围，长度可能跨越多个区块
+            size_t first = n ? rand() % n : 0, last = first + (n ? rand() % (n - first + 1) : 0);
+            bool value = rand() % 2;
+            b.set_range(first, last, value);
+            for (size_t i = first; i < last; ++i)
+                ref[i] = value;
+            break;
+        }
+        case 1: {
+            size_t first = n ? rand() % n : 0, last = first + (n ? rand() % (n - first + 1) : 0);
+            b.flip_range(first, last);
+            for (size_t i = first; i < last; ++i)
+                ref[i] = !ref[i];
+            break;
+        }
+        case 2: {       // resize 到不是 64 倍数的大小
+            size_t m = rand() % 1500;
+            bool value = rand() % 2;
+            b.resize(m, value);
+            ref.resize(m, value);
+            break;
+        }
+        case 3:
+            for (int k = rand() % 130; k > 0; --k)
+            {
+                bool value = rand() % 3 == 0;
+                b.push_back(value);
+                ref.push_back(value);
+            }
+            break;
+        case 4:
+            if (n)
+            {
+                size_t i = rand() % n;
+                b[i].flip();
+                ref[i] = !ref[i];
+                i = rand() % n;
+                b.set(i, false);
+                ref[i] = false;
+            }
+            break;
+        case 5:
+            b.flip();
+            ref.flip();
+            break;
+        default:
+            if (rand() % 2)
+                b.set();
+            else
+                b.reset();
+            ref.assign(n, b.any());
+            break;
+        }
+        check(b, ref);
+    }
+}
+
+// 集合运算与逐位元的结果比对
+template <class Bits>
+void set_ops(size_t n)
+{
+    Bits x(n), y(n);
+    std::vector<bool> rx(n), ry(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        rx[i] = rand() % 3 == 0;
+        ry[i] = rand() % 2 == 0;
+        x[i] = rx[i];
+        y[i] = ry[i];
+    }
+    std::vector<bool> r_and(n), r_or(n), r_xor(n), r_andnot(n), r_not(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        r_and[i] = rx[i] && ry[i];
+        r_or[i] = rx[i] || ry[i];
+        r_xor[i] = rx[i] != ry[i];
+        r_andnot[i] = rx[i] && !ry[i];
+        r_not[i] = !rx[i];
+    }
+    check(x & y, r_and);
+    check(x | y, r_or);
+    check(x ^ y, r_xor);
+    check(~x, r_not);
+    Bits d(x);
+    d.andnot(y);
+    check(d, r_andnot);
+    assert((x & y).is_subset_of(x) && (x & y).is_subset_of(y));
+    assert(x.is_subset_of(x | y) && d.is_subset_of(x));
+    assert((d == x) == (x & y).none());
+    Bits e(x);
+    e.swap(d);
+    check(e, r_andnot);
+    check(d, rx);
+}
+
+void bench()
+{
+    const size_t N = 1000000000;
+    bitset_type even(N), odd(N);
+    for (size_t i = 0; i < N; i += 2)
+        even.set(i);
+    odd.set_range(0, N).andnot(even);
+    cout << "memory: " << even.memory_usage() / (1 << 20) << " MB (vector<bool>: "
+         << N * sizeof(bool) / (1 << 20) << " MB)" << endl;
+
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    size_t c = even.count() + odd.count();
+    cout << "count: " << c << " " << ms_since(t0) << " ms" << endl;
+
+    t0 = chrono::steady_clock::now();
+    bitset_type all = even | odd;
+    cout << "or: all=" << all.all() << " " << ms_since(t0) << " ms" << endl;
+
+    // 稀疏的遮罩：find_next 直接跳过整段的 0
+    bitset_type sparse(N);
+    for (size_t i = 0; i < N; i += 1000003)
+        sparse.set(i);
+    t0 = chrono::steady_clock::now();
+    size_t hits = 0;
+    for (size_t p = sparse.find_first(); p != bitset_type::npos; p = sparse.find_next(p))
+        ++hits;
+    cout << "find_next: " << hits << " hits " << ms_since(t0) << " ms" << endl;
+}
+
+int main(int argc, char **argv) {
+    // 埃拉托斯特尼筛法：找出 100 以内的质数
+    bitset_type prime(100, true);
+    prime.reset(0).reset(1);
+    for (size_t i = 2; i * i < prime.size(); ++i)
+        if (prime[i])
+            for (size_t j = i * i; j < prime.size(); j += i)
+                prime.reset(j);
+    for (size_t p = prime.find_first(); p != bitset_type::npos; p = prime.find_next(p))
+        cout << p << ' ';
+    cout << endl << "count=" << prime.count() << endl;
+    assert(prime.count() == 25 && prime.find_first() == 2 && prime.find_next(89) == 97);
+    assert(prime.find_next(97) == bitset_type::npos && prime.find_next(bitset_type::npos) == bitset_type::npos);
+
+    // 空的集合
+    bitset_type empty;
+    check(empty, std::vector<bool>());
+
+    for (unsigned seed = 1; seed <= 20; ++seed)
+    {
+        random_ops<bitset_type>(seed);
+        random_ops<inline_bitset>(seed);
+    }
+    // 长度跨过 AVX2 一次处理的 4 个区块与 8 轮累计的边界
+    const size_t sizes[] = {0, 1, 63, 64, 65, 255, 256, 257, 2047, 2048, 2049, 64 * 33 + 5};
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k)
+    {
+        set_ops<bitset_type>(sizes[k]);
+        set_ops<inline_bitset>(sizes[k]);
+    }
+
+    // 区块位于内部空间的 bitset 放在 vector 中，扩充时逐一复制而不是逐位元搬移
+    SimpleSTL::vector<inline_bitset> many;
+    for (int i = 0; i < 100; ++i)
+    {
+        many.push_back(inline_bitset(i * 3 + 1));
+        many.back().set(i * 3);
+    }
+    for (int i = 0; i < 100; ++i)
+        assert(many[i].count() == 1 && many[i].find_first() == size_t(i * 3));
+    cout << "ok" << endl;
+
+    if (bench_requested(argc, argv))
+        bench();
+}
@@ -0,0 +1,115 @@
+// flat_map / flat_set / flat_multimap：有序 vector，二分搜索查找，成批插入一趟合并
+
+#include "flat_map.h"
+#include "flat_multimap.h"
+#include "flat_set.h"
+#include "set.h"
+#include <iostream>
+#include <string>
+#include <map>
+#include <set>
+#include <cassert>
+
+using namespace SimpleSTL;
+using namespace std;
+
+template <class Map>
+void print(const char *name, const Map &m)
+{
+    cout << name << "(" << m.size() << "): ";
+    for (typename Map::const_iterator it = m.begin(); it != m.end(); ++it)
+        cout << it->first << "=" << it->second << ' ';
+    cout << endl;
+}
+
+// 与参考容器逐一比较
+template <class Flat, class Ref>
+void check_map(const Flat &m, const Ref &ref)
+{
+    assert(m.size() == ref.size());
+    typename Ref::const_iterator r = ref.begin();
+    for (typename Flat::const_iterator it = m.begin(); it != m.end(); ++it, ++r)
+        assert(it->first == r->first && it->second == r->second);
+}
+
+template <class Flat, class Ref>
+void check_set(const Flat &s, const Ref &ref)
+{
+    assert(s.size() == ref.size());
+    typename Ref::const_iterator r = ref.begin();
+    for (typename Flat::const_iterator it = s.begin(); it != s.end(); ++it, ++r)
+        assert(*it == *r);
+}
+
+int main() {
+    typedef SimpleSTL::flat_map<string, int> word_map;
+    word_map m;
+    std::map<string, int> ref;
+    m["delta"] = ref["delta"] = 4;
+    m["alpha"] = ref["alpha"] = 1;
+    m["charlie"] = ref["charlie"] = 3;
+    m.insert(word_map::value_type("bravo", 2));
+    ref.insert(make_pair(string("bravo"), 2));
+    assert(!m.insert(word_map::value_type("alpha", 100)).second);   // 已存在，不插入
+    print("m", m);
+    check_map(m, ref);
+
+    // 成批插入：未排序的输入先排序再一趟合并；已排序的输入直接合并
+    pair<string, int> more[] = {make_pair("golf", 7), make_pair("echo", 5), make_pair("foxtrot", 6)};
+    m.insert(more, more + 3);
+    ref.insert(more, more + 3);
+    pair<string, int> sorted_more[] = {make_pair("bravo", 0), make_pair("hotel", 8), make_pair("india", 9)};
+    m.insert_sorted(sorted_more, sorted_more + 3);
+    ref.insert(sorted_more, sorted_more + 3);
+    print("m", m);
+    check_map(m, ref);
+    assert(m.lower_bound("c")->first == "charlie");
+    assert(m.upper_bound("golf")->first == "hotel");
+    assert(m.count("echo") == 1 && m.count("zulu") == 0);
+
+    m.erase("charlie");
+    ref.erase("charlie");
+    m.erase(m.find("india"));
+    ref.erase("india");
+    check_map(m, ref);
+    word_map copy = m;
+    copy["alpha"] = 10;
+    assert(!(m == copy) && m < copy);
+
+    SimpleSTL::flat_multimap<int, char> mm;
+    std::multimap<int, char> mref;
+    const char *s = "mississippi";
+    for (int i = 0; s[i]; ++i)
+    {
+        mm.insert(SimpleSTL::flat_multimap<int, char>::value_type(s[i] - 'a', s[i]));
+        mref.insert(make_pair(s[i] - 'a', s[i]));
+    }
+    check_map(mm, mref);
+    pair<SimpleSTL::flat_multimap<int, char>::iterator,
+         SimpleSTL::flat_multimap<int, char>::iterator> r = mm.equal_range('s' - 'a');
+    assert(mm.count('s' - 'a') == 4 && r.second - r.first == 4);
+
+    int keys[] = {5, 1, 4, 1, 5, 9, 2, 6, 5, 3};
+    SimpleSTL::flat_set<int> fs(keys, keys + 10);
+    check_set(fs, std::set<int>(keys, keys + 10));
+
+    // 以 SimpleSTL 容器的迭代器区间建立、合并：迭代器带的是 SimpleSTL 的标记
+    SimpleSTL::set<int> sorted;
+    std::set<int> sref;
+    for (int i = 0; i < 1000; i += 3)
+    {
+        sorted.insert(i);
+        sref.insert(i);
+    }
+    SimpleSTL::flat_set<int> from_set(sorted_unique_tag(), sorted.begin(), sorted.end());
+    check_set(from_set, sref);
+    SimpleSTL::set<int> evens;
+    for (int i = 0; i < 1000; i += 2)
+    {
+        evens.insert(i);
+        sref.insert(i);
+    }
+    from_set.insert_sorted(evens.begin(), evens.end());
+    check_set(from_set, sref);
+    cout << "ok" << endl;
+}
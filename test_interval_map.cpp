@@ -0,0 +1,100 @@
+// interval_map / interval_set：每个节点记录子树中最大的右端点，重叠与刺探查询不必线性扫描
+
+#include "interval_map.h"
+#include "interval_set.h"
+#include "vector.h"
+#include <iostream>
+#include <string>
+#include <set>
+#include <cassert>
+
+using namespace SimpleSTL;
+using namespace std;
+
+typedef SimpleSTL::interval_map<int, string> booking_map;
+
+struct counter
+{
+    long n;
+    counter() : n(0) {}
+    template <class Value>
+    void operator()(const Value &) { ++n; }
+};
+
+int main() {
+    booking_map rooms;
+    rooms.insert(9, 12, "alice");
+    rooms.insert(10, 11, "bob");
+    rooms.insert(13, 17, "carol");
+    rooms.insert(0, 24, "maintenance");     // 一个很长的区间
+    rooms.insert(15, 16, "dave");
+    rooms.insert(9, 12, "erin");            // 键值可以重复
+
+    SimpleSTL::vector<booking_map::iterator> hits;
+    rooms.overlapping(booking_map::key_type(11, 14), back_inserter(hits));
+    cout << "overlapping [11,14): ";
+    for (size_t i = 0; i < hits.size(); ++i)
+        cout << hits[i]->second << "[" << hits[i]->first.low << "," << hits[i]->first.high << ") ";
+    cout << endl;
+    assert(hits.size() == 4);   // alice erin carol maintenance
+
+    hits.clear();
+    rooms.stabbing(15, back_inserter(hits));
+    cout << "stabbing 15: ";
+    for (size_t i = 0; i < hits.size(); ++i)
+        cout << hits[i]->second << ' ';
+    cout << endl;
+    assert(hits.size() == 3);   // carol maintenance dave
+
+    rooms.erase(rooms.find_stab(0));        // 删除 maintenance
+    assert(rooms.find_overlap(booking_map::key_type(12, 13)) == rooms.end());
+    assert(rooms.find_stab(16)->second == "carol");
+
+    SimpleSTL::interval_set<int> free_slots;
+    free_slots.insert(1, 3);
+    free_slots.insert(5, 8);
+    free_slots.insert(1, 3);                // 重复，不插入
+    assert(free_slots.size() == 2);
+    assert(!free_slots.overlaps(interval<int>(3, 5)));
+    assert(free_slots.overlaps(interval<int>(2, 6)));
+
+    // 随机区间，其中夹杂着一些很长的区间；插入、删除之后与暴力扫描比对
+    typedef SimpleSTL::interval_map<int, int> id_map;
+    id_map big;
+    SimpleSTL::vector<interval<int> > all;
+    std::set<int> erased;
+    unsigned seed = 7;
+    for (int i = 0; i < 20000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int low = (seed >> 4) % 200000;
+        int len = i % 1000 == 0 ? 100000 : 1 + (seed >> 20) % 100;
+        big.insert(low, low + len, i);
+        all.push_back(interval<int>(low, low + len));
+    }
+    for (int i = 0; i < 20000; i += 7)
+    {
+        SimpleSTL::vector<id_map::iterator> at;
+        big.stabbing(all[i].low, back_inserter(at));
+        for (size_t j = 0; j < at.size(); ++j)
+            if (at[j]->second == i)
+                big.erase(at[j]);
+        erased.insert(i);
+    }
+    assert(big.size() == all.size() - erased.size());
+    for (int q = 0; q < 200; ++q)
+    {
+        interval<int> probe(q * 1000, q * 1000 + 50);
+        SimpleSTL::vector<id_map::iterator> found;
+        big.overlapping(probe, back_inserter(found));
+        std::set<int> got, expected;
+        for (size_t i = 0; i < found.size(); ++i)
+            got.insert(found[i]->second);
+        for (size_t i = 0; i < all.size(); ++i)
+            if (all[i].overlaps(probe) && !erased.count(int(i)))
+                expected.insert(int(i));
+        assert(got == expected && found.size() == got.size());
+        assert(big.for_each_overlapping(probe, counter()).n == long(expected.size()));
+    }
+    cout << "ok" << endl;
+}
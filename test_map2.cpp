@@ -0,0 +1,118 @@
+// 由已排序的输入以 O(n) 建立 map
+
+#include "map.h"
+#include <iostream>
+#include <string>
+#include <map>
+#include <vector>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+template <class Map, class Ref>
+void check(Map &m, const Ref &ref)
+{
+    assert(m.size() == ref.size());
+    typename Ref::const_iterator r = ref.begin();
+    for (typename Map::iterator it = m.begin(); it != m.end(); ++it, ++r)
+        assert(it->first == r->first && it->second == r->second);
+    assert(r == ref.end());
+}
+
+// 第 fail_at 次复制时抛出异常，live 记录存活的对象数
+static int live = 0, copies = 0, fail_at = -1;
+struct fragile
+{
+    int v;
+    fragile(int x = 0) : v(x) { ++live; }
+    fragile(const fragile &x) : v(x.v)
+    {
+        if (++copies == fail_at)
+            throw 1;
+        ++live;
+    }
+    ~fragile() { --live; }
+};
+
+int main() {
+    pair<int, string> snapshot[5] = {
+        pair<int, string>(1, "david"), pair<int, string>(2, "jason"),
+        pair<int, string>(3, "jerry"), pair<int, string>(4, "jimmy"),
+        pair<int, string>(5, "jjhou")};
+    std::map<int, string> ref;
+    for (int i = 0; i < 5; ++i)
+        ref[snapshot[i].first] = snapshot[i].second;
+
+    // 声明输入已排序且无重复，直接建出平衡的树，不逐一插入
+    SimpleSTL::map<int, string> imap(sorted_unique_tag(), snapshot, snapshot + 5);
+    SimpleSTL::map<int, string>::iterator ite = imap.begin();
+    for (; ite != imap.end(); ++ite)
+        cout << ite->first << ' ' << ite->second << endl;
+    check(imap, ref);
+
+    // 以新的快照整个取代
+    imap.assign_sorted(snapshot + 2, snapshot + 5);
+    ref.erase(1);
+    ref.erase(2);
+    check(imap, ref);
+    assert(imap.begin()->second == "jerry");
+
+    imap[6] = "mchen";
+    ref[6] = "mchen";
+    check(imap, ref);
+    imap.clear();
+    assert(imap.size() == 0 && imap.begin() == imap.end());
+
+    // 各种大小都建出正确的树，之后的插入、删除照常平衡
+    for (int n = 0; n < 300; n += 7)
+    {
+        std::vector<pair<int, int> > in;
+        std::map<int, int> r;
+        for (int i = 0; i < n; ++i)
+        {
+            in.push_back(pair<int, int>(i * 2, i));
+            r[i * 2] = i;
+        }
+        SimpleSTL::map<int, int> m(sorted_unique_tag(), in.begin(), in.end());
+        check(m, r);
+        for (int i = 0; i < n; i += 3)
+        {
+            m.erase(i * 2);
+            r.erase(i * 2);
+            m[i * 2 + 1] = i;
+            r[i * 2 + 1] = i;
+        }
+        check(m, r);
+    }
+
+    // 建树到一半复制元素时抛出异常：已建好的子树全部释放
+    {
+        // 输入直接是 value_type，复制只发生在构造节点时
+        typedef SimpleSTL::map<int, fragile>::value_type value_type;
+        std::vector<value_type> in;
+        for (int i = 0; i < 100; ++i)
+            in.push_back(value_type(i, fragile(i)));
+        const int before = live;
+        for (int n = 1; n <= 100; n += 9)
+        {
+            SimpleSTL::map<int, fragile> m;
+            m[-1] = fragile(-1);
+            copies = 0;
+            fail_at = n;
+            try {
+                m.assign_sorted(in.begin(), in.end());
+                assert(false);
+            }
+            catch (int) {}
+            fail_at = -1;
+            assert(m.size() == 0 && m.begin() == m.end());
+            m[7] = fragile(7);      // 容器仍然可以使用
+            assert(m.size() == 1);
+            m.clear();
+            assert(live == before);
+        }
+    }
+    assert(live == 0);
+    cout << "ok" << endl;
+}
@@ -0,0 +1,55 @@
+// 每棵树专属的节点池：清空时整批归还区块，不必逐一释放节点
+
+#include "map.h"
+#include <iostream>
+#include <string>
+
+using namespace SimpleSTL;
+using namespace std;
+
+typedef SimpleSTL::map<int, int, less<int>, __rb_tree_pool_alloc<alloc2> > pool_map;
+typedef SimpleSTL::map<int, string, less<int>, __rb_tree_pool_alloc<alloc2> > pool_str_map;
+
+template <class Map>
+void print(const char *name, const Map &m)
+{
+    cout << name << "(" << m.size() << "): ";
+    for (typename Map::const_iterator it = m.begin(); it != m.end(); ++it)
+        cout << it->first << "=" << it->second << ' ';
+    cout << endl;
+}
+
+int main() {
+    pool_map a;
+    for (int i = 0; i < 10; ++i)
+        a[i] = i * i;
+    a.erase(3);
+    a.erase(7);
+    a[100] = 1;         // 重复利用刚释放的节点
+    print("a", a);
+
+    // 节点在两棵树之间搬移之后，两者共用同一个节点池
+    pool_map b;
+    a.split(5, b);
+    print("a.split(5) a", a);
+    print("a.split(5) b", b);
+    a.clear();          // b 仍在使用节点池，只能逐一释放
+    print("a.clear() b", b);
+
+    // 值的型别不是 trivial destructor 时，先析构各个值，再整批归还
+    pool_str_map s;
+    s[2] = "two";
+    s[1] = "one";
+    s[3] = "three";
+    print("s", s);
+    s.clear();
+    s[4] = "four";
+    print("s.clear(); s[4]", s);
+
+    pool_map *big = new pool_map;
+    for (int i = 0; i < 1000000; ++i)
+        (*big)[i] = i;
+    cout << "big: " << big->size() << endl;
+    delete big;         // 不遍历树，直接归还区块
+    cout << "big deleted" << endl;
+}
@@ -0,0 +1,77 @@
+// map 记住最近一次插入的位置（finger）：递增的键值、落在上一次插入点附近的键值，只需常数次比较
+
+#include "map.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace SimpleSTL;
+
+static long compares = 0;
+
+// 计算比较次数的比较函数
+struct counting_less
+{
+    bool operator()(long x, long y) const
+    {
+        ++compares;
+        return x < y;
+    }
+};
+
+typedef SimpleSTL::map<long, int, counting_less> ts_map;
+
+bool check(const ts_map &m)
+{
+    ts_map::const_iterator it = m.begin(), prev = it;
+    for (size_t n = 0; it != m.end(); prev = it++, ++n)
+        if (n > 0 && !(prev->first < it->first))
+            return false;
+    return true;
+}
+
+int main() {
+    const int N = 1000000;
+
+    // 递增的时间戳：每次插入都落在最右端
+    ts_map m;
+    compares = 0;
+    for (long t = 0; t < N; ++t)
+        m.insert(ts_map::value_type(t * 10, 0));
+    cout << "append:      " << double(compares) / N << " compares/insert" << endl;
+
+    // 与上一次插入点相距不远的键值（乱序到达的时间戳）
+    compares = 0;
+    long t = 5;
+    for (int i = 0; i < N / 2; ++i)
+    {
+        t += (rand() % 7) * 10;
+        m.insert(ts_map::value_type(t, 1));
+    }
+    cout << "near finger: " << double(compares) / (N / 2) << " compares/insert" << endl;
+
+    // 一段已排序的键值，整段落在树的中间
+    long run[100000];
+    for (int i = 0; i < 100000; ++i)
+        run[i] = 3000001 + i * 20;
+    pair<long, int> vals[1000];
+    compares = 0;
+    for (int i = 0; i < 100000; i += 1000)
+    {
+        for (int j = 0; j < 1000; ++j)
+            vals[j] = pair<long, int>(run[i + j], 2);
+        m.insert_sorted_run(vals, vals + 1000);
+    }
+    cout << "sorted run:  " << double(compares) / 100000 << " compares/insert" << endl;
+
+    // 对照：没有局部性的随机键值仍是 O(log n)
+    compares = 0;
+    for (int i = 0; i < 100000; ++i)
+        m.insert(ts_map::value_type(long(rand()) * 2 + 1, 3));
+    cout << "random:      " << double(compares) / 100000 << " compares/insert" << endl;
+
+    cout << "size=" << m.size() << (check(m) ? " ordered" : " BROKEN") << endl;
+    m.erase(m.begin());     // 删除之后插入仍然正确
+    m.insert(ts_map::value_type(-1, 0));
+    cout << "begin=" << m.begin()->first << endl;
+}
@@ -0,0 +1,84 @@
+// 区间走访与区间删除：for_each_in_range 以小数组代替父节点回溯，erase_range 整段摘下、只重新平衡一次
+
+#include "map.h"
+#include <iostream>
+#include <map>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+typedef SimpleSTL::map<int, int> imap;
+
+struct sum_values
+{
+    long sum;
+    sum_values() : sum(0) {}
+    void operator()(const imap::value_type &v) { sum += v.second; }
+};
+
+struct bump
+{
+    void operator()(imap::value_type &v) { ++v.second; }
+};
+
+void check(const imap &m, const std::map<int, int> &ref)
+{
+    assert(m.size() == ref.size());
+    std::map<int, int>::const_iterator r = ref.begin();
+    for (imap::const_iterator it = m.begin(); it != m.end(); ++it, ++r)
+        assert(it->first == r->first && it->second == r->second);
+}
+
+long ref_sum(const std::map<int, int> &ref, int first, int last)
+{
+    long sum = 0;
+    for (std::map<int, int>::const_iterator it = ref.lower_bound(first); it != ref.lower_bound(last); ++it)
+        sum += it->second;
+    return sum;
+}
+
+int main() {
+    imap m;
+    for (int i = 0; i < 10; ++i)
+        m[i * 10] = i;
+    m.for_each_in_range(20, 60, bump());    // 20 30 40 50
+    cout << "sum [0, 100) = " << m.for_each_in_range(0, 100, sum_values()).sum << endl;
+    assert(m.for_each_in_range(0, 100, sum_values()).sum == 49);
+    cout << "erased " << m.erase_range(15, 45) << ", size=" << m.size() << endl;
+    for (imap::iterator it = m.begin(); it != m.end(); ++it)
+        cout << it->first << ':' << it->second << ' ';
+    cout << endl;
+    assert(m.size() == 7);
+
+    // 随机的区间走访与区间删除，与 std::map 比对
+    imap a;
+    std::map<int, int> ref;
+    unsigned seed = 3;
+    for (int i = 0; i < 20000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int k = (seed >> 8) % 100000;
+        a[k] = ref[k] = i;
+    }
+    for (int round = 0; round < 300; ++round)
+    {
+        seed = seed * 1103515245 + 12345;
+        int first = (seed >> 8) % 100000, last = first + (seed >> 20) % 2000;
+        assert(a.for_each_in_range(first, last, sum_values()).sum == ref_sum(ref, first, last));
+        if (round % 3 == 0)
+        {
+            size_t n = a.erase_range(first, last);
+            size_t expected = 0;
+            while (ref.lower_bound(first) != ref.lower_bound(last))
+            {
+                ref.erase(ref.lower_bound(first));
+                ++expected;
+            }
+            assert(n == expected);
+        }
+    }
+    check(a, ref);
+    assert(a.for_each_in_range(0, 100000, sum_values()).sum == ref_sum(ref, 0, 100000));
+    cout << "ok" << endl;
+}
@@ -0,0 +1,63 @@
+// 并行复制与并行走访：按子树把工作分给多个线程
+
+#include "map.h"
+#include <iostream>
+#include <map>
+#include <thread>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+typedef SimpleSTL::map<long, long> lmap;
+
+struct plus_long
+{
+    long operator()(long x, long y) const { return x + y; }
+};
+
+struct mapped
+{
+    long operator()(const lmap::value_type &v) const { return v.second; }
+};
+
+struct scale
+{
+    void operator()(lmap::value_type &v) const { v.second *= 2; }
+};
+
+int main() {
+    const long N = 200000;
+    lmap m;
+    std::map<long, long> ref;
+    for (long i = 0; i < N; ++i)
+    {
+        m.insert(lmap::value_type(i * 3, i));
+        ref[i * 3] = i;
+    }
+
+    unsigned depth = 0;     // 2^depth 个线程
+    while ((1u << depth) < thread::hardware_concurrency())
+        ++depth;
+    cout << "threads: " << (1u << depth) << endl;
+
+    // depth 为 0 时是单线程的版本，结果必须与并行的版本相同
+    unsigned depths[3] = {0, 2, depth == 0 ? 1 : depth};
+    for (int i = 0; i < 3; ++i)
+    {
+        unsigned d = depths[i];
+        lmap c;
+        c.insert(lmap::value_type(-1, -1));     // copy_from 取代原有的内容
+        c.copy_from(m, d);
+        assert(c.size() == ref.size());
+        std::map<long, long>::const_iterator r = ref.begin();
+        for (lmap::iterator it = c.begin(); it != c.end(); ++it, ++r)
+            assert(it->first == r->first && it->second == r->second);
+
+        c.parallel_for_each(scale(), d);
+        long sum = c.parallel_reduce(0L, plus_long(), mapped(), d);
+        assert(sum == 2 * (N * (N - 1) / 2));
+        assert(m.parallel_reduce(0L, plus_long(), mapped(), d) == N * (N - 1) / 2);
+        cout << "depth " << d << ": size=" << c.size() << " sum=" << sum << endl;
+    }
+}
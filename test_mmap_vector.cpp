@@ -0,0 +1,186 @@
+// mmap_vector：元素直接存放在档案中，程序重新启动时映射档案即可使用，不必重建
+// 以 --bench 执行时另外比较「从一般档案读回 vector」与「直接映射」的时间，结果只印出来
+
+#include "mmap_vector.h"
+#include "vector.h"
+#include "test_bench.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+#include <csignal>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace SimpleSTL;
+
+struct record
+{
+    long id;
+    double price;
+    int quantity;
+};
+
+bool operator==(const record &a, const record &b)
+{
+    return a.id == b.id && a.price == b.price && a.quantity == b.quantity;
+}
+
+record make_record(long i)
+{
+    record r = {i, i * 0.5, int(i % 100)};
+    return r;
+}
+
+// 测试用的档案放在 /tmp，档名带上 pid 以免与同时执行的测试冲突
+static string path, plain;
+
+// 正常结束或抛出异常时删除档案
+struct file_remover
+{
+    ~file_remover()
+    {
+        remove(path.c_str());
+        remove(plain.c_str());
+    }
+};
+
+// assert 失败时 abort 不会执行解构式，在信号处理中删除档案
+extern "C" void remove_on_abort(int sig)
+{
+    unlink(path.c_str());
+    unlink(plain.c_str());
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+template <class V>
+void check(V &v, const std::vector<record> &ref)
+{
+    assert(v.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i)
+        assert(v[i] == ref[i]);
+}
+
+off_t file_size(const string &p)
+{
+    struct stat st;
+    assert(stat(p.c_str(), &st) == 0);
+    return st.st_size;
+}
+
+void bench()
+{
+    const long N = 1000000;     // 约 24 MB
+    {
+        mmap_vector<record> v(path.c_str(), mmap_create);
+        FILE *f = fopen(plain.c_str(), "wb");
+        for (long i = 0; i < N; ++i) {
+            record r = make_record(i);
+            v.push_back(r);
+            fwrite(&r, sizeof(r), 1, f);
+        }
+        fclose(f);
+        v.sync();
+    }
+
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    SimpleSTL::vector<record> copy;
+    {
+        FILE *f = fopen(plain.c_str(), "rb");
+        record r;
+        while (fread(&r, sizeof(r), 1, f) == 1)
+            copy.push_back(r);
+        fclose(f);
+    }
+    cout << "read into vector: " << ms_since(t0) << " ms, size=" << copy.size() << endl;
+
+    t0 = chrono::steady_clock::now();
+    mmap_vector<record> v(path.c_str(), mmap_open);
+    cout << "open mmap_vector: " << ms_since(t0) << " ms, size=" << v.size() << endl;
+}
+
+int main(int argc, char **argv) {
+    path = "/tmp/test_mmap_vector." + to_string(getpid()) + ".dat";
+    plain = "/tmp/test_mmap_vector." + to_string(getpid()) + ".bin";
+    file_remover remover;
+    signal(SIGABRT, remove_on_abort);
+
+    const long N = 100000;      // 约 2.4 MB
+    std::vector<record> ref;
+    {
+        mmap_vector<record> v(path.c_str(), mmap_create);
+        assert(v.empty());
+        for (long i = 0; i < N; ++i) {
+            v.push_back(make_record(i));
+            ref.push_back(make_record(i));
+        }
+        v.sync();
+        cout << "written: size=" << v.size() << " capacity=" << v.capacity() << endl;
+        check(v, ref);
+    }
+
+    // 「重新启动」：重新映射档案，内容不变
+    {
+        mmap_vector<record> v(path.c_str(), mmap_open);
+        check(v, ref);
+        cout << "v[12345].price=" << v[12345].price << " back().id=" << v.back().id << endl;
+
+        // 在容量用尽时追加本 vector 的元素：重新映射之后仍写入正确的值
+        v.shrink_to_fit();
+        assert(v.capacity() == v.size());
+        v.push_back(v[7]);
+        ref.push_back(ref[7]);
+        check(v, ref);
+
+        // insert、erase、resize 与 std::vector 比对
+        v.insert(v.begin() + 3, 5, make_record(-3));
+        ref.insert(ref.begin() + 3, 5, make_record(-3));
+        record extra[3] = {make_record(-7), make_record(-8), make_record(-9)};
+        v.insert(v.begin() + 1000, extra, extra + 3);
+        ref.insert(ref.begin() + 1000, extra, extra + 3);
+        v.erase(v.begin() + 50, v.begin() + 5000);
+        ref.erase(ref.begin() + 50, ref.begin() + 5000);
+        v.pop_back();
+        ref.pop_back();
+        v.resize(v.size() + 10, make_record(42));
+        ref.resize(ref.size() + 10, make_record(42));
+        check(v, ref);
+
+        // 截短之后档案恰好是表头加上元素
+        v.shrink_to_fit();
+        assert(file_size(path) == off_t(64 + v.size() * sizeof(record)));
+    }
+    {
+        mmap_vector<record> v(path.c_str(), mmap_open_or_create);
+        check(v, ref);
+        v.clear();
+    }
+    {
+        mmap_vector<record> v(path.c_str());
+        assert(v.empty());
+    }
+
+    // 元素大小不符、档案不存在都以异常回报
+    bool threw = false;
+    try {
+        mmap_vector<long> w(path.c_str(), mmap_open);
+    }
+    catch (const runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        mmap_vector<record> w(plain.c_str(), mmap_open);
+    }
+    catch (const system_error &) {
+        threw = true;
+    }
+    assert(threw);
+    cout << "ok" << endl;
+
+    if (bench_requested(argc, argv))
+        bench();
+}
@@ -0,0 +1,206 @@
+// persistent_map：O(1) 快照，写者修改时只复制一条路径，读者持有快照不加锁读取
+
+#include "persistent_map.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <cassert>
+
+using namespace SimpleSTL;
+using namespace std;
+
+typedef SimpleSTL::persistent_map<string, int> config_map;
+typedef SimpleSTL::persistent_map<int, int> int_map;
+
+void print(const char *name, const config_map &m)
+{
+    cout << name << "(" << m.size() << "): ";
+    for (config_map::const_iterator it = m.begin(); it != m.end(); ++it)
+        cout << it->first << "=" << it->second << ' ';
+    cout << endl;
+}
+
+// 逐一比对内容与 size()
+template <class Map, class Ref>
+void check(const Map &m, const Ref &ref)
+{
+    assert(m.size() == ref.size());
+    typename Ref::const_iterator r = ref.begin();
+    for (typename Map::const_iterator it = m.begin(); it != m.end(); ++it, ++r)
+        assert(r != ref.end() && it->first == r->first && it->second == r->second);
+    assert(r == ref.end());
+}
+
+// 第 fail_at 次复制时抛出异常，live 记录存活的对象数
+static int live = 0, copies = 0, fail_at = -1;
+struct fragile
+{
+    int v;
+    fragile(int x = 0) : v(x) { ++live; }
+    fragile(const fragile &x) : v(x.v)
+    {
+        if (++copies == fail_at)
+            throw 1;
+        ++live;
+    }
+    fragile &operator=(const fragile &x)
+    {
+        v = x.v;
+        return *this;
+    }
+    ~fragile() { --live; }
+};
+bool operator==(const fragile &x, const fragile &y) { return x.v == y.v; }
+
+typedef SimpleSTL::persistent_map<int, fragile> fragile_map;
+
+// 快照存在时复制路径上的节点，在第 n 次复制时抛出异常：原容器与快照的内容都不变（删除时节点可能已经摘下）
+void throwing_copies()
+{
+    std::map<int, fragile> ref;
+    fragile_map m;
+    for (int i = 0; i < 200; ++i)
+    {
+        m.insert(fragile_map::value_type(i * 2, fragile(i)));
+        ref.insert(std::make_pair(i * 2, fragile(i)));
+    }
+    for (int n = 1; n <= 40; ++n)
+    {
+        // 插入：异常之后内容不变
+        {
+            fragile_map snap = m.snapshot();
+            copies = 0;
+            fail_at = n;
+            bool threw = false;
+            try {
+                m.insert(fragile_map::value_type(n * 10 + 1, fragile(-n)));
+            }
+            catch (int) {
+                threw = true;
+            }
+            fail_at = -1;
+            if (threw)
+                check(m, ref);
+            else
+                ref.insert(std::make_pair(n * 10 + 1, fragile(-n)));
+            snap.clear();   // 放开快照之后，原容器的节点都必须仍然有效
+            check(m, ref);
+        }
+        // 删除：异常之后节点不是仍在就是已经摘下，size() 与内容一致
+        {
+            fragile_map snap = m.snapshot();
+            std::map<int, fragile> before = ref;
+            const int k = (n * 37) % 400 / 2 * 2;
+            copies = 0;
+            fail_at = n;
+            try {
+                m.erase(k);
+                ref.erase(k);
+            }
+            catch (int) {
+                if (m.find(k) == m.end())
+                    ref.erase(k);
+            }
+            fail_at = -1;
+            check(m, ref);
+            check(snap, before);
+            snap.clear();
+            check(m, ref);
+        }
+    }
+    m.clear();
+    ref.clear();
+}
+
+int main() {
+    config_map m;
+    m["timeout"] = 30;
+    m["retries"] = 3;
+    m["threads"] = 8;
+
+    config_map v1 = m.snapshot();
+    m["timeout"] = 60;
+    m.erase("retries");
+    m.insert(config_map::value_type("port", 8080));
+    print("v1", v1);    // 快照不受之后的修改影响
+    print("m", m);
+    assert(v1.size() == 3 && v1.find("timeout")->second == 30 && v1.count("retries") == 1 && v1.count("port") == 0);
+    assert(m.size() == 3 && m.find("timeout")->second == 60 && m.count("retries") == 0 && m.find("port")->second == 8080);
+
+    // 随机插入、删除、修改，每隔一段取一次快照并记下当时的内容；最后所有快照都必须与当时相同
+    srand(1);
+    int_map w;
+    std::map<int, int> ref;
+    std::vector<int_map> snaps;
+    std::vector<std::map<int, int> > expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        int k = rand() % 2000;
+        switch (rand() % 4)
+        {
+        case 0: assert(w.insert(int_map::value_type(k, i)).second == ref.insert(std::make_pair(k, i)).second); break;
+        case 1: assert(w.erase(k) == ref.erase(k)); break;
+        case 2: w[k] = i; ref[k] = i; break;
+        default: assert(w.count(k) == ref.count(k)); break;
+        }
+        if (i % 1000 == 0)
+        {
+            snaps.push_back(w.snapshot());
+            expected.push_back(ref);
+        }
+    }
+    check(w, ref);
+    for (size_t i = 0; i < snaps.size(); ++i)
+        check(snaps[i], expected[i]);
+    w.erase(w.lower_bound(500), w.upper_bound(1500));
+    ref.erase(ref.lower_bound(500), ref.upper_bound(1500));
+    check(w, ref);
+    for (size_t i = 0; i < snaps.size(); ++i)
+        check(snaps[i], expected[i]);
+
+    throwing_copies();
+    assert(live == 0);
+
+    // 一个写者不断发布新版本；读者只在取快照时短暂加锁，之后不加锁地遍历。
+    // 每一代都写完全部 1000 个键值才发布，读者看到的快照中所有值都相同
+    mutex mu;
+    int_map published;
+    vector<thread> readers;
+    for (int r = 0; r < 4; ++r)
+        readers.push_back(thread([&] {
+            for (int i = 0; i < 200; ++i)
+            {
+                int_map s;
+                {
+                    lock_guard<mutex> g(mu);
+                    s = published;
+                }
+                assert(s.empty() || s.size() == 1000);
+                int gen = s.empty() ? 0 : s.begin()->second, k = 0;
+                for (int_map::const_iterator it = s.begin(); it != s.end(); ++it, ++k)
+                    assert(it->first == k && it->second == gen);
+            }
+        }));
+
+    int_map writer;
+    for (int gen = 1; gen <= 100; ++gen)
+    {
+        for (int k = 0; k < 1000; ++k)
+            writer[k] = gen;
+        lock_guard<mutex> g(mu);
+        published = writer;
+    }
+    for (size_t r = 0; r < readers.size(); ++r)
+        readers[r].join();
+    int_map last = published.snapshot();
+    long sum = 0;
+    for (int_map::const_iterator it = last.begin(); it != last.end(); ++it)
+        sum += it->second;
+    cout << "published sum: " << sum << endl;
+    assert(sum == 100 * 1000);
+    cout << "ok" << endl;
+}
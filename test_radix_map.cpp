@@ -0,0 +1,96 @@
+// radix_map：以自适应基数树存放字串键值，前缀扫描与最长前缀匹配
+
+#include "radix_map.h"
+#include <iostream>
+#include <string>
+#include <map>
+#include <cstdio>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+void check(radix_map<int> &m, const std::map<string, int> &ref)
+{
+    assert(m.size() == ref.size());
+    radix_map<int>::iterator x = m.begin();
+    for (std::map<string, int>::const_iterator y = ref.begin(); y != ref.end(); ++x, ++y)
+        assert(x->first == y->first && x->second == y->second);
+    assert(x == m.end());
+}
+
+int main() {
+    radix_map<int> routes;
+    routes["/"] = 0;
+    routes["/api/"] = 1;
+    routes["/api/v1/users"] = 2;
+    routes["/api/v1/users/admin"] = 3;
+    routes["/api/v2/"] = 4;
+    routes["/static/"] = 5;
+    for (radix_map<int>::iterator it = routes.begin(); it != routes.end(); ++it)
+        cout << it->first << '=' << it->second << ' ';
+    cout << endl;
+
+    cout << "prefix /api/v1: ";
+    pair<radix_map<int>::iterator, radix_map<int>::iterator> r = routes.prefix_range("/api/v1");
+    for (; r.first != r.second; ++r.first)
+        cout << r.first->first << ' ';
+    cout << endl;
+
+    const char *paths[] = {"/api/v1/users/42", "/api/v3/x", "/static/app.js", "/favicon.ico"};
+    const char *routed[] = {"/api/v1/users", "/api/", "/static/", "/"};
+    for (int i = 0; i < 4; ++i)
+    {
+        cout << paths[i] << " -> " << routes.longest_prefix(paths[i])->first << endl;
+        assert(routes.longest_prefix(paths[i])->first == routed[i]);
+    }
+
+    routes.erase("/api/v1/users");
+    assert(routes.size() == 5);
+    assert(routes.lower_bound("/api/v1")->first == "/api/v1/users/admin");
+
+    // 共享长前缀的键值：插入、删除、查找、前缀扫描都与 std::map 比对
+    radix_map<int> a;
+    std::map<string, int> ref;
+    char buf[64];
+    unsigned seed = 11;
+    for (int i = 0; i < 20000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        sprintf(buf, "/var/lib/service/data/%d/%u/%d", i % 97, (seed >> 8) % 1000, i % 5000);
+        a[buf] = i;
+        ref[buf] = i;
+    }
+    check(a, ref);
+    int erased = 0;
+    for (std::map<string, int>::iterator it = ref.begin(); it != ref.end(); )
+    {
+        if (it->second % 3 == 0)
+        {
+            assert(a.erase(it->first) == 1);
+            ref.erase(it++);
+            ++erased;
+        }
+        else
+            ++it;
+    }
+    assert(erased > 0);
+    check(a, ref);
+    for (std::map<string, int>::iterator it = ref.begin(); it != ref.end(); ++it)
+        assert(a.find(it->first)->second == it->second);
+    assert(a.find("/var/lib/service/data/") == a.end());
+
+    for (int d = 0; d < 97; d += 7)
+    {
+        sprintf(buf, "/var/lib/service/data/%d/", d);
+        const string prefix = buf;
+        size_t n = 0, expected = 0;
+        for (r = a.prefix_range(prefix); r.first != r.second; ++r.first)
+            ++n;
+        for (std::map<string, int>::iterator it = ref.lower_bound(prefix);
+             it != ref.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+            ++expected;
+        assert(n == expected);
+    }
+    cout << "ok" << endl;
+}
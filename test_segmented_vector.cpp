@@ -0,0 +1,145 @@
+// segmented_vector：扩充时不搬移元素，指向元素的指针一直有效
+// 以 --bench 执行时另外与 vector 比较 push_back、随机存取与走访的时间
+
+#include "segmented_vector.h"
+#include "vector.h"
+#include "test_bench.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+// 第 fail_at 次复制时抛出异常，live 记录存活的对象数
+static int live = 0, copies = 0, fail_at = -1;
+struct fragile
+{
+    long v;
+    fragile(long x = 0) : v(x) { ++live; }
+    fragile(const fragile &x) : v(x.v)
+    {
+        if (++copies == fail_at)
+            throw 1;
+        ++live;
+    }
+    ~fragile() { --live; }
+};
+
+void bench()
+{
+    const long N = 10000000;
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    SimpleSTL::vector<long> v;
+    for (long i = 0; i < N; ++i)
+        v.push_back(i);
+    cout << "vector push_back:           " << ms_since(t0) << " ms" << endl;
+
+    t0 = chrono::steady_clock::now();
+    segmented_vector<long> sv;
+    for (long i = 0; i < N; ++i)
+        sv.push_back(i);
+    cout << "segmented_vector push_back: " << ms_since(t0) << " ms" << endl;
+
+    // 随机存取：一次 count leading zeros 加一次查表
+    long sum1 = 0, sum2 = 0;
+    t0 = chrono::steady_clock::now();
+    for (long i = 0, j = 0; i < N; ++i, j = (j + 7919) % N)
+        sum1 += v[j];
+    cout << "vector operator[]:           " << ms_since(t0) << " ms" << endl;
+    t0 = chrono::steady_clock::now();
+    for (long i = 0, j = 0; i < N; ++i, j = (j + 7919) % N)
+        sum2 += sv[j];
+    cout << "segmented_vector operator[]: " << ms_since(t0) << " ms" << endl;
+
+    // 依序走访：迭代器在同一段中只需递增指针
+    long sum3 = 0;
+    t0 = chrono::steady_clock::now();
+    for (segmented_vector<long>::iterator it = sv.begin(); it != sv.end(); ++it)
+        sum3 += *it;
+    cout << "segmented_vector iterate:    " << ms_since(t0) << " ms" << endl;
+    cout << "sums " << sum1 << ' ' << sum2 << ' ' << sum3 << endl;
+}
+
+int main(int argc, char **argv) {
+    // 扩充时已有元素的地址不变
+    segmented_vector<long> s;
+    s.push_back(1);
+    long *first = &s[0];
+    std::vector<long *> addresses;
+    for (long i = 1; i < 1000; ++i)
+    {
+        s.push_back(i);
+        addresses.push_back(&s[i]);
+    }
+    cout << "size=" << s.size() << " capacity=" << s.capacity() << " segments=" << s.segment_count()
+         << " &s[0] unchanged=" << (first == &s[0]) << endl;
+    assert(first == &s[0]);
+    for (long i = 1; i < 1000; ++i)
+        assert(addresses[i - 1] == &s[i] && s[i] == i);
+    assert(s.capacity() == 1984 && s.segment_count() == 5);   // 64 + 128 + 256 + 512 + 1024
+
+    // 与 std::vector 比对：push_back、pop_back、resize、迭代器的前进与后退
+    const long N = 1000000;
+    segmented_vector<long> sv;
+    std::vector<long> ref;
+    for (long i = 0; i < N; ++i)
+    {
+        sv.push_back(i * 3);
+        ref.push_back(i * 3);
+    }
+    for (long i = 0, j = 0; i < N; ++i, j = (j + 7919) % N)
+        assert(sv[j] == ref[j]);
+    long k = 0;
+    for (segmented_vector<long>::iterator it = sv.begin(); it != sv.end(); ++it, ++k)
+        assert(*it == ref[k]);
+    for (segmented_vector<long>::iterator it = sv.end(); it != sv.begin(); )
+    {
+        --it;
+        --k;
+        assert(*it == ref[k] && sv.end() - it == long(ref.size()) - k);
+    }
+    for (int i = 0; i < 1000; ++i)
+    {
+        sv.pop_back();
+        ref.pop_back();
+    }
+    sv.resize(N + 500, -1);
+    ref.resize(N + 500, -1);
+    sv.push_back(7);
+    ref.push_back(7);
+    assert(sv.size() == ref.size() && sv.back() == 7 && sv[N - 1000] == -1);
+    segmented_vector<long> copy(sv);
+    for (size_t i = 0; i < ref.size(); i += 997)
+        assert(copy[i] == ref[i]);
+    sv.resize(100);
+    sv.shrink_to_fit();
+    assert(sv.segment_count() == 2 && sv.size() == 100 && sv[99] == ref[99]);   // 64 + 128
+    sv.clear();
+    assert(sv.empty());
+
+    // 复制到一半抛出异常：已复制的元素与已配置的段都要释放
+    {
+        segmented_vector<fragile> f;
+        for (long i = 0; i < 5000; ++i)
+            f.push_back(fragile(i));
+        const int before = live;
+        for (fail_at = 1; fail_at <= 5000; fail_at += 611)
+        {
+            copies = 0;
+            try {
+                segmented_vector<fragile> g(f);
+                assert(false);
+            }
+            catch (int) {}
+            assert(live == before);
+        }
+        fail_at = -1;
+    }
+    assert(live == 0);
+    cout << "ok" << endl;
+
+    if (bench_requested(argc, argv))
+        bench();
+}
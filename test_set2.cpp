@@ -0,0 +1,30 @@
+// order statistic set：rank / select 只需 O(log n)
+
+#include "set.h"
+#include <iostream>
+
+using namespace SimpleSTL;
+using namespace std;
+
+int main() {
+    int ia[8] = {90, 75, 60, 88, 100, 42, 67, 81};
+    set<int, less<int>, alloc2, __rb_tree_os_node> scores(ia, ia + 8);
+
+    // 第 k 小的分数
+    for (size_t k = 0; k < scores.size(); ++k)
+        cout << *scores.select(k) << ' ';
+    cout << endl;
+
+    // 小于 81 的分数有几个
+    cout << "rank(81)=" << scores.rank(81) << endl;
+    cout << "rank(82)=" << scores.rank(82) << endl;
+
+    scores.erase(60);
+    scores.insert(95);
+    cout << "rank(81)=" << scores.rank(81) << endl;
+    cout << "select(6)=" << *scores.select(6) << endl;
+    cout << "distance=" << scores.distance(scores.find(75), scores.end()) << endl;
+
+    if (scores.select(scores.size()) == scores.end())
+        cout << "select(size()) == end()" << endl;
+}
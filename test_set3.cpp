@@ -0,0 +1,62 @@
+// split / join 与集合运算：只搬移节点，不复制元素
+
+#include "set.h"
+#include <iostream>
+
+using namespace SimpleSTL;
+using namespace std;
+
+template <class Set>
+void print(const char *name, const Set &s)
+{
+    cout << name << "(" << s.size() << "): ";
+    for (typename Set::const_iterator it = s.begin(); it != s.end(); ++it)
+        cout << *it << ' ';
+    cout << endl;
+}
+
+int main() {
+    SimpleSTL::set<int> a, b;
+    for (int i = 0; i < 20; i += 2)
+        a.insert(i);
+    for (int i = 0; i < 20; i += 3)
+        b.insert(i);
+    print("a", a);
+    print("b", b);
+
+    // 键值不小于 10 的元素移到 hi
+    SimpleSTL::set<int> hi;
+    a.split(10, hi);
+    print("a.split(10) a", a);
+    print("a.split(10) hi", hi);
+    a.join(hi);
+    print("a.join(hi)", a);
+
+    SimpleSTL::set<int> mid;
+    a.extract_range(4, 12, mid);
+    print("a.extract_range(4, 12) a", a);
+    print("a.extract_range(4, 12) mid", mid);
+    a.merge_from(mid);
+
+    // b 中键值不重复的元素移入 u，重复的留在 b
+    SimpleSTL::set<int> u(a);
+    u.merge_from(b);
+    print("u.merge_from(b) u", u);
+    print("u.merge_from(b) b", b);
+
+    SimpleSTL::set<int> i(a);
+    i.intersect_with(u);
+    i.subtract(b);
+    print("a & u - b", i);
+
+    // 大的集合可交给多个线程：最上面两层递归各自分头进行
+    SimpleSTL::set<int> big1, big2;
+    for (int k = 0; k < 100000; ++k) {
+        big1.insert(k * 2);
+        big2.insert(k * 3);
+    }
+    big1.merge_from(big2, 2);
+    cout << "parallel merge: " << big1.size() << " + " << big2.size() << endl;
+    big1.subtract(big2, 2);
+    cout << "parallel subtract: " << big1.size() << endl;
+}
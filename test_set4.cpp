@@ -0,0 +1,98 @@
+// 紧凑节点：颜色塞进父指针最低位；索引节点：32 位下标代替指针
+
+#include "set.h"
+#include "map.h"
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+using namespace SimpleSTL;
+using namespace std;
+
+template <class Set>
+void print(const char *name, const Set &s)
+{
+    cout << name << "(" << s.size() << "): ";
+    for (typename Set::const_iterator it = s.begin(); it != s.end(); ++it)
+        cout << *it << ' ';
+    cout << endl;
+}
+
+typedef SimpleSTL::set<int, less<int>, alloc2, __rb_tree_index_node> index_set;
+
+template <class Set>
+void check(const Set &s, const std::set<int> &ref)
+{
+    assert(s.size() == ref.size());
+    std::set<int>::const_iterator r = ref.begin();
+    for (typename Set::const_iterator it = s.begin(); it != s.end(); ++it, ++r)
+        assert(*it == *r);
+}
+
+// 每个线程各自使用一棵不相干的索引节点树，所有这种节点都来自同一个节点池
+void worker(int seed)
+{
+    index_set s;
+    std::set<int> ref;
+    unsigned x = seed;
+    for (int i = 0; i < 20000; ++i)
+    {
+        x = x * 1103515245 + 12345;
+        int k = (x >> 8) % 5000;
+        if (x & 0x10000) { s.insert(k); ref.insert(k); }
+        else { s.erase(k); ref.erase(k); }
+    }
+    check(s, ref);
+}
+
+template <class Set>
+void run(const char *name)
+{
+    Set s;
+    for (int i = 0; i < 20; ++i)
+        s.insert((i * 7) % 20);
+    for (int i = 0; i < 20; i += 3)
+        s.erase(i);
+    print(name, s);
+}
+
+int main() {
+    cout << "sizeof node<int>: plain " << sizeof(__rb_tree_node<int>)
+         << ", compact " << sizeof(__rb_tree_compact_node<int>)
+         << ", index " << sizeof(__rb_tree_index_node<int>)
+         << ", os " << sizeof(__rb_tree_os_node<int>) << endl;
+
+    run<SimpleSTL::set<int> >("plain");
+    run<SimpleSTL::set<int, less<int>, alloc2, __rb_tree_compact_node> >("compact");
+    run<SimpleSTL::set<int, less<int>, alloc2, __rb_tree_index_node> >("index");
+
+    SimpleSTL::map<int, int, less<int>, alloc2, __rb_tree_index_node> m;
+    for (int i = 0; i < 100000; ++i)
+        m[i] = i * 2;
+    long long sum = 0;
+    for (SimpleSTL::map<int, int, less<int>, alloc2, __rb_tree_index_node>::iterator it = m.begin();
+         it != m.end(); ++it)
+        sum += it->second;
+    cout << "index map size " << m.size() << ", sum " << sum << endl;
+    assert(sum == 2LL * (100000LL * 99999 / 2));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.push_back(std::thread(worker, t + 1));
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    // 并行复制：多个线程同时自节点池配置节点
+    index_set big, copy;
+    std::set<int> ref;
+    for (int i = 0; i < 200000; ++i)
+    {
+        big.insert(i * 3);
+        ref.insert(i * 3);
+    }
+    copy.copy_from(big, 2);
+    check(copy, ref);
+    cout << "threads and parallel copy ok" << endl;
+}
@@ -0,0 +1,105 @@
+// small_vector：元素不超过 N 个时存放在对象内部，不配置内存
+
+#include "small_vector.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+static long allocations = 0;
+
+// 计算配置次数的配置器
+struct counting_alloc
+{
+    static void *allocate(size_t n)
+    {
+        ++allocations;
+        return alloc2::allocate(n);
+    }
+    static void deallocate(void *p, size_t n) { alloc2::deallocate(p, n); }
+};
+
+// 大量的短命小 vector：每个装 0 ~ 7 个元素
+template <class Vector>
+long churn(int rounds)
+{
+    long sum = 0;
+    for (int i = 0; i < rounds; ++i)
+    {
+        Vector v;
+        for (int j = 0; j < i % 8; ++j)
+            v.push_back(j);
+        for (typename Vector::iterator it = v.begin(); it != v.end(); ++it)
+            sum += *it;
+    }
+    return sum;
+}
+
+template <class Small>
+void check(Small &v, const std::vector<string> &ref)
+{
+    assert(v.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i)
+        assert(v[i] == ref[i]);
+}
+
+int main() {
+    small_vector<string, 4> names;
+    std::vector<string> ref;
+    names.push_back("ls");
+    names.push_back("-l");
+    cout << "size=" << names.size() << " capacity=" << names.capacity()
+         << (names.is_inline() ? " inline" : " heap") << endl;
+    assert(names.is_inline() && names.capacity() == 4);
+    names.push_back("-a");
+    names.push_back("-h");
+    names.push_back("/tmp");    // 第 5 个元素：搬到堆上
+    cout << "size=" << names.size() << " capacity=" << names.capacity()
+         << (names.is_inline() ? " inline" : " heap") << endl;
+    assert(!names.is_inline());
+    ref.push_back("ls");
+    ref.push_back("-l");
+    ref.push_back("-a");
+    ref.push_back("-h");
+    ref.push_back("/tmp");
+    check(names, ref);
+
+    // 内部空间与堆空间之间的 swap
+    small_vector<string, 4> other(2, string("x"));
+    other.swap(names);
+    check(other, ref);
+    check(names, std::vector<string>(2, "x"));
+    names.shrink_to_fit();      // swap 逐一交换元素，names 留着堆空间，直到 shrink_to_fit
+    assert(names.is_inline());
+    check(names, std::vector<string>(2, "x"));
+
+    // 插入、删除跨过内部空间的边界；shrink_to_fit 放得下时搬回内部空间
+    other.erase(other.begin() + 1, other.begin() + 3);
+    ref.erase(ref.begin() + 1, ref.begin() + 3);
+    other.insert(other.begin(), "sudo");
+    ref.insert(ref.begin(), "sudo");
+    check(other, ref);
+    other.pop_back();
+    ref.pop_back();
+    other.shrink_to_fit();
+    assert(other.is_inline());
+    check(other, ref);
+    other.resize(9, "-v");
+    ref.resize(9, "-v");
+    check(other, ref);
+    small_vector<string, 4> copy(other);
+    check(copy, ref);
+
+    // 不超过 8 个元素的 small_vector<int, 8> 完全不配置内存
+    const int N = 100000;
+    allocations = 0;
+    long s1 = churn<SimpleSTL::vector<int, counting_alloc> >(N);
+    long a_vec = allocations;
+    allocations = 0;
+    long s2 = churn<small_vector<int, 8, counting_alloc> >(N);
+    cout << "vector: " << a_vec << " allocations, small_vector<8>: " << allocations << " allocations" << endl;
+    assert(s1 == s2 && a_vec > 0 && allocations == 0);
+}
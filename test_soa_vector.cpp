@@ -0,0 +1,107 @@
+// soa_vector：每个字段各自连续存放，只用到少数字段的循环不会把整笔资料载入快取
+
+#include "soa_vector.h"
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+typedef soa_vector<int, string> orders_t;
+typedef std::vector<tuple<int, string> > reference_t;
+
+// const 容器的 operator[] 与 const_iterator 传回的代理物件只能读取
+static_assert(!is_assignable<orders_t::const_reference, orders_t::value_type>::value,
+              "const_reference must not write into a const container");
+static_assert(!is_assignable<orders_t::const_reference, orders_t::const_reference>::value,
+              "const_reference must not write into a const container");
+static_assert(!is_assignable<orders_t::const_iterator::reference, orders_t::value_type>::value,
+              "const_iterator must not write into a const container");
+static_assert(is_assignable<orders_t::reference, orders_t::value_type>::value &&
+              is_assignable<orders_t::reference, orders_t::const_reference>::value,
+              "reference writes into the container");
+
+void check(const orders_t &v, const reference_t &ref)
+{
+    assert(v.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i)
+    {
+        assert(v.get<0>(i) == get<0>(ref[i]));
+        assert(v.get<1>(i) == get<1>(ref[i]));
+    }
+}
+
+int main() {
+    orders_t orders;
+    reference_t ref;
+    orders.push_back(100, "buy");
+    orders.emplace_back(250, "sell");
+    orders.push_back(make_tuple(75, string("buy")));
+    ref.push_back(make_tuple(100, string("buy")));
+    ref.push_back(make_tuple(250, string("sell")));
+    ref.push_back(make_tuple(75, string("buy")));
+    for (orders_t::iterator it = orders.begin(); it != orders.end(); ++it)
+        cout << (*it).get<1>() << ' ' << (*it).get<0>() << endl;
+    check(orders, ref);
+
+    orders.transform<0>([](int qty) { return qty * 2; });
+    for (size_t i = 0; i < ref.size(); ++i)
+        get<0>(ref[i]) *= 2;
+    check(orders, ref);
+    cout << "total quantity=" << orders.accumulate<0>(0) << endl;
+    assert(orders.accumulate<0>(0) == 850);
+
+    // 引数就是本容器的元素：在容量已满时插入，扩充会释放旧的字段
+    for (int round = 0; round < 6; ++round)
+    {
+        while (orders.size() < orders.capacity())
+        {
+            orders.push_back(int(orders.size()), string(40, 'a' + round));
+            ref.push_back(make_tuple(int(ref.size()), string(40, 'a' + round)));
+        }
+        orders.push_back(orders.get<0>(0), orders.get<1>(0));
+        ref.push_back(ref[0]);
+        check(orders, ref);
+
+        while (orders.size() < orders.capacity())
+        {
+            orders.push_back(-1, "x");
+            ref.push_back(make_tuple(-1, string("x")));
+        }
+        orders.emplace_back(orders.get<0>(1), orders.get<1>(1));
+        ref.push_back(ref[1]);
+        check(orders, ref);
+    }
+
+    // 接上自己
+    reference_t twice(ref);
+    twice.insert(twice.end(), ref.begin(), ref.end());
+    orders.append(orders);
+    check(orders, twice);
+
+    // erase、resize、pop_back
+    orders.erase(orders.begin() + 1, orders.begin() + 4);
+    twice.erase(twice.begin() + 1, twice.begin() + 4);
+    check(orders, twice);
+    orders.pop_back();
+    twice.pop_back();
+    orders.resize(orders.size() + 3, make_tuple(7, string("hold")));
+    twice.resize(twice.size() + 3, make_tuple(7, string("hold")));
+    check(orders, twice);
+
+    // 一个字段的整段存取
+    column_span<int> qty = orders.column<0>();
+    long sum = 0, expected = 0;
+    for (size_t i = 0; i < qty.size(); ++i)
+        sum += qty[i];
+    for (size_t i = 0; i < twice.size(); ++i)
+        expected += get<0>(twice[i]);
+    assert(sum == expected);
+
+    orders_t copy(orders);
+    check(copy, twice);
+    cout << "ok" << endl;
+}
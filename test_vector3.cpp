@@ -0,0 +1,84 @@
+// 可以逐位元搬移的元素：vector 扩充空间时以 realloc 就地延伸（大区块由 mremap 重新映射），不复制元素
+
+#include "vector.h"
+#include <iostream>
+#include <vector>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+// 与 long 一样大小，但没有特化 _type_traits，扩充时仍逐一复制
+struct boxed
+{
+    long v;
+    boxed(long x = 0) : v(x) {}
+};
+
+// 只有 allocate、deallocate 的配置器：vector 改为配置新空间并复制
+struct plain_alloc
+{
+    static void *allocate(size_t n) { return alloc2::allocate(n); }
+    static void deallocate(void *p, size_t n) { alloc2::deallocate(p, n); }
+};
+
+long value_of(long x) { return x; }
+long value_of(const boxed &x) { return x.v; }
+
+template <class T, class Alloc>
+void grow(const char *name, long n)
+{
+    SimpleSTL::vector<T, Alloc> v;
+    int moves = 0, grows = 0;
+    T *last = 0;
+    size_t cap = 0;
+    for (long i = 0; i < n; ++i)
+    {
+        v.push_back(T(i));
+        if (v.capacity() != cap)
+        {
+            ++grows;
+            moves += last != 0 && v.begin() != last;
+            cap = v.capacity();
+            last = v.begin();
+        }
+    }
+    assert(long(v.size()) == n);
+    for (long i = 0; i < n; ++i)
+        assert(value_of(v[i]) == i);
+    v.reserve(2 * n);
+    v.insert(v.begin() + 1, 3, T(-1));
+    assert(value_of(v[3]) == -1 && value_of(v[4]) == 1 && value_of(v[v.size() - 1]) == n - 1);
+    cout << name << ": " << grows << " grows, buffer moved " << moves << " times" << endl;
+}
+
+int main() {
+    // 元素就是本 vector 中的元素时，扩充之后仍插入正确的值
+    SimpleSTL::vector<int> a;
+    std::vector<int> ref;
+    a.push_back(7);
+    ref.push_back(7);
+    for (int i = 0; i < 40; ++i)
+    {
+        a.push_back(a[0] + i);
+        ref.push_back(ref[0] + i);
+        a.insert(a.begin() + 1, 3, a[a.size() - 1]);
+        ref.insert(ref.begin() + 1, 3, ref[ref.size() - 1]);
+    }
+    assert(a.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i)
+        assert(a[i] == ref[i]);
+
+    // vector 本身也可逐位元搬移：外层扩充时内层 vector 不必复制
+    SimpleSTL::vector<SimpleSTL::vector<int> > vv;
+    for (int i = 0; i < 100; ++i)
+        vv.push_back(SimpleSTL::vector<int>(i % 5 + 1, i));
+    for (int i = 0; i < 100; ++i)
+        assert(vv[i].size() == size_t(i % 5 + 1) && vv[i][0] == i);
+
+    const long N = 1L << 20;
+    grow<long, alloc2>("long ", N);
+    grow<boxed, alloc2>("boxed", N);
+    grow<long, plain_alloc>("long, no reallocate", N);
+    cout << "ok" << endl;
+}
@@ -0,0 +1,104 @@
+// 成长策略：vector 与 deque 可指定扩充的倍数；slack 查看闲置空间，shrink_to_fit 归还多余的空间
+
+#include "vector.h"
+#include "small_vector.h"
+#include "deque.h"
+#include <iostream>
+#include <deque>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+// 逐一放入 n 个元素：每次扩充的新容量都由 Growth::next 决定，记录扩充次数与闲置空间的最大比例
+template <class Growth>
+void grow(const char *name, int n, double max_slack, size_t max_step)
+{
+    SimpleSTL::vector<int, alloc2, Growth> v;
+    int grows = 0;
+    double worst = 0;
+    size_t cap = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        v.push_back(i);
+        if (v.capacity() != cap)
+        {
+            ++grows;
+            assert(v.capacity() == Growth::next(cap, cap + 1));
+            assert(max_step == 0 || v.capacity() - cap <= max_step);
+            cap = v.capacity();
+        }
+        assert(v.slack() == v.capacity() - v.size());
+        double ratio = (double)v.slack() / v.capacity();
+        if (ratio > worst)
+            worst = ratio;
+    }
+    cout << name << ": capacity=" << v.capacity() << " slack=" << v.slack()
+         << " grows=" << grows << " worst slack=" << (int)(worst * 100) << "%" << endl;
+    assert(worst < max_slack);
+    v.shrink_to_fit();
+    assert(v.capacity() == size_t(n) && v.slack() == 0);
+    for (int i = 0; i < n; ++i)
+        assert(v[i] == i);
+}
+
+int main() {
+    // 策略本身：2 倍、1.5 倍、每次最多加 MaxStep
+    assert(growth_double::next(0, 1) == 1 && growth_double::next(8, 9) == 16 && growth_double::next(8, 100) == 100);
+    assert(growth_one_and_half::next(8, 9) == 12 && growth_one_and_half::next(7, 8) == 10);
+    assert((growth_factor<2, 1, 65536>::next(1 << 20, (1 << 20) + 1) == (1 << 20) + 65536));
+
+    const int N = 1000000;
+    grow<growth_double>("double     ", N, 0.5, 0);
+    grow<growth_one_and_half>("one_and_half", N, 0.34, 0);
+    grow<growth_factor<2, 1, 65536> >("capped     ", N, 0.5, 65536);
+
+    // small_vector 缩减时若放得下，元素搬回内部空间
+    small_vector<int, 8> sv;
+    for (int i = 0; i < 20; ++i)
+        sv.push_back(i);
+    assert(!sv.is_inline());
+    sv.erase(sv.begin() + 5, sv.end());
+    cout << "small_vector: size=" << sv.size() << (sv.is_inline() ? " inline" : " heap");
+    assert(!sv.is_inline());
+    sv.shrink_to_fit();
+    cout << " -> capacity=" << sv.capacity() << (sv.is_inline() ? " inline" : " heap") << endl;
+    assert(sv.is_inline() && sv.capacity() == 8 && sv.size() == 5);
+    for (int i = 0; i < 5; ++i)
+        assert(sv[i] == i);
+
+    // deque 只往一端成长时，中控器会不断扩充；清掉大部分元素后 shrink_to_fit 缩回中控器
+    SimpleSTL::deque<int> dq;
+    std::deque<int> ref;
+    for (int i = 0; i < N; ++i)
+    {
+        dq.push_back(i);
+        ref.push_back(i);
+    }
+    cout << "deque: size=" << dq.size() << " slack=" << dq.slack() << " map_slack=" << dq.map_slack() << endl;
+    while (dq.size() > 100)
+    {
+        dq.pop_front();
+        ref.pop_front();
+    }
+    const size_t before = dq.map_slack();
+    cout << "deque: size=" << dq.size() << " map_slack=" << before;
+    dq.shrink_to_fit();
+    cout << " -> map_slack=" << dq.map_slack() << " front=" << dq.front() << endl;
+    assert(dq.map_slack() < before && dq.map_slack() <= 8);
+    assert(dq.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i)
+        assert(dq[i] == ref[i]);
+    // 缩小之后两端仍可继续成长
+    for (int i = 0; i < 5000; ++i)
+    {
+        dq.push_front(-i);
+        ref.push_front(-i);
+        dq.push_back(i);
+        ref.push_back(i);
+    }
+    assert(dq.size() == ref.size() && dq.front() == ref.front() && dq.back() == ref.back());
+    for (size_t i = 0; i < ref.size(); i += 97)
+        assert(dq[i] == ref[i]);
+    cout << "ok" << endl;
+}
@@ -0,0 +1,57 @@
+// 预设初始化：马上要整块覆写的缓冲区不必先填零
+
+#include "vector.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+// 模拟 read()：把整个缓冲区写满
+void fake_read(char *buf, size_t n, char c)
+{
+    memset(buf, c, n);
+}
+
+int main() {
+    // 非 POD 的元素仍然正常构造
+    SimpleSTL::vector<string> names(3, default_init);
+    names.resize_default_init(5);
+    cout << "names: size=" << names.size() << " empty=" << names[4].empty() << endl;
+    assert(names.size() == 5);
+    for (size_t i = 0; i < names.size(); ++i)
+        assert(names[i].empty());
+    names.resize_default_init(2);
+    assert(names.size() == 2);
+
+    // 分段追加：每次在尾端取得 n 个元素的空间直接写入，与 std::vector 比对
+    SimpleSTL::vector<char> buf;
+    std::vector<char> ref;
+    for (int i = 0; i < 40; ++i)
+    {
+        const size_t n = 100 + 37 * i;
+        char *p = buf.reserve_and_construct_uninitialized(n);
+        assert(p == buf.end() - n);
+        fake_read(p, n, char('a' + i % 26));
+        ref.insert(ref.end(), n, char('a' + i % 26));
+    }
+    cout << "buf: size=" << buf.size() << " back=" << buf.back() << endl;
+    assert(buf.size() == ref.size() && memcmp(buf.begin(), ref.data(), ref.size()) == 0);
+
+    // 已有的元素不受影响；resize_default_init 也可以缩小
+    SimpleSTL::vector<int> v(10, 5);
+    v.resize_default_init(1000);
+    for (int i = 0; i < 10; ++i)
+        assert(v[i] == 5);
+    v.resize_default_init(3);
+    assert(v.size() == 3 && v[2] == 5);
+
+    SimpleSTL::vector<char> w(1 << 16, default_init);
+    assert(w.size() == size_t(1 << 16));
+    fake_read(w.begin(), w.size(), 'z');
+    assert(w.front() == 'z' && w.back() == 'z');
+    cout << "ok" << endl;
+}
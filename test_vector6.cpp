@@ -0,0 +1,91 @@
+// 对齐与大分页：aligned_vector 的元素对齐到 64 bytes，大区块以 mmap 配置并对齐到 2 MB 的边界
+
+#include "vector.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cassert>
+#include <cstdint>
+
+using namespace std;
+using namespace SimpleSTL;
+
+typedef align_alloc<64, huge_page_size> huge_alloc;
+
+void print_stats(const alloc_stats &s)
+{
+    cout << "alignment=" << s.alignment << " aligned_allocs=" << s.aligned_allocs
+         << " huge_allocs=" << s.huge_allocs << " hugetlb_allocs=" << s.hugetlb_allocs
+         << " huge_remaps=" << s.huge_remaps << " huge_bytes=" << s.huge_bytes << endl;
+}
+
+// 逐一 push_back：每次扩充之后区块都要对齐，大区块经过 mremap 之后仍要对齐到 2 MB
+void grow_and_check(size_t n)
+{
+    aligned_vector<double> v;
+    std::vector<double> ref;
+    const double *last = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        v.push_back(double(i));
+        ref.push_back(double(i));
+        if (v.begin() != last)
+        {
+            last = v.begin();
+            assert(((uintptr_t)last & 63) == 0);
+            if (v.capacity() * sizeof(double) >= huge_page_size)
+                assert(((uintptr_t)last & (huge_page_size - 1)) == 0);
+        }
+    }
+    assert(v.size() == ref.size());
+    for (size_t i = 0; i < n; ++i)
+        assert(v[i] == ref[i]);
+
+    v.resize(n / 3);
+    v.shrink_to_fit();
+    assert(((uintptr_t)v.begin() & (huge_page_size - 1)) == 0);
+    for (size_t i = 0; i < v.size(); ++i)
+        assert(v[i] == ref[i]);
+}
+
+// 多个执行绪同时配置、释放，统计数字不能错乱
+void concurrent_alloc()
+{
+    const alloc_stats before = huge_alloc::stats();
+    const int threads = 4, rounds = 200;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.push_back(std::thread([] {
+            for (int i = 0; i < rounds; ++i)
+            {
+                void *small = huge_alloc::allocate(100);
+                void *big = huge_alloc::allocate(huge_page_size);
+                assert(((uintptr_t)small & 63) == 0);
+                assert(((uintptr_t)big & (huge_page_size - 1)) == 0);
+                huge_alloc::deallocate(big, huge_page_size);
+                huge_alloc::deallocate(small, 100);
+            }
+        }));
+    for (size_t t = 0; t < workers.size(); ++t)
+        workers[t].join();
+    const alloc_stats after = huge_alloc::stats();
+    assert(after.aligned_allocs - before.aligned_allocs == size_t(threads * rounds));
+    assert(after.huge_allocs - before.huge_allocs == size_t(threads * rounds));
+    assert(after.aligned_bytes == before.aligned_bytes);
+    assert(after.huge_bytes == before.huge_bytes);
+}
+
+int main() {
+    // 小 vector 也对齐到 64 bytes
+    aligned_vector<double> small(5, 1.0);
+    cout << "small: aligned to 64=" << (((uintptr_t)small.begin() & 63) == 0) << endl;
+    assert(((uintptr_t)small.begin() & 63) == 0);
+
+    grow_and_check(4 << 20);    // 32 MB，其中大部分的扩充经过 reallocate
+    concurrent_alloc();
+
+    alloc_stats s = huge_alloc::stats();
+    print_stats(s);
+    assert(s.huge_bytes == 0);  // 大区块都已归还
+    cout << "ok" << endl;
+}
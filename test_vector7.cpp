@@ -0,0 +1,150 @@
+// 区间插入：依迭代器的种类决定做法，list、deque 这类前向区间先算出长度，只配置一次空间
+
+#include "vector.h"
+#include "list.h"
+#include "deque.h"
+#include <iostream>
+#include <vector>
+#include <cassert>
+
+using namespace std;
+using namespace SimpleSTL;
+
+static long allocations = 0;
+
+// 计算配置次数的配置器
+struct counting_alloc
+{
+    static void *allocate(size_t n)
+    {
+        ++allocations;
+        return alloc2::allocate(n);
+    }
+    static void deallocate(void *p, size_t n) { alloc2::deallocate(p, n); }
+};
+
+typedef SimpleSTL::vector<int, counting_alloc> ivector;
+
+// 只能走访一次的迭代器：vector 只能逐一插入，不能先算长度
+struct input_iter
+{
+    typedef SimpleSTL::input_iterator_tag iterator_category;
+    typedef int value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const int *pointer;
+    typedef const int &reference;
+
+    const int *p;
+    explicit input_iter(const int *x) : p(x) {}
+    const int &operator*() const { return *p; }
+    input_iter &operator++()
+    {
+        ++p;
+        return *this;
+    }
+    bool operator==(const input_iter &x) const { return p == x.p; }
+    bool operator!=(const input_iter &x) const { return p != x.p; }
+};
+
+void print(const char *name, ivector &v)
+{
+    cout << name << ":";
+    for (ivector::iterator it = v.begin(); it != v.end(); ++it)
+        cout << ' ' << *it;
+    cout << endl;
+}
+
+void check(ivector &v, const std::vector<int> &ref)
+{
+    assert(v.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i)
+        assert(v[i] == ref[i]);
+}
+
+int main() {
+    SimpleSTL::list<int> l;
+    SimpleSTL::deque<int> d;
+    std::vector<int> rl, rd;
+    for (int i = 0; i < 5; ++i) {
+        l.push_back(i);
+        d.push_back(10 + i);
+        rl.push_back(i);
+        rd.push_back(10 + i);
+    }
+
+    // 构造：前向区间只配置一次
+    allocations = 0;
+    ivector v(l.begin(), l.end());
+    assert(allocations == 1 && v.capacity() == 5);
+    print("from list", v);
+    std::vector<int> ref(rl);
+    check(v, ref);
+
+    // 插入：需要扩充时也只配置一次，传回第一个新元素的位置
+    allocations = 0;
+    ivector::iterator it = v.insert(v.begin() + 2, d.begin(), d.end());
+    assert(allocations == 1);
+    ref.insert(ref.begin() + 2, rd.begin(), rd.end());
+    print("insert deque", v);
+    check(v, ref);
+    assert(it == v.begin() + 2 && *it == 10);
+
+    // 空间足够时插入不配置
+    v.reserve(100);
+    allocations = 0;
+    v.insert(v.begin() + 7, l.begin(), l.end());
+    ref.insert(ref.begin() + 7, rl.begin(), rl.end());
+    v.insert(v.end() - 1, d.begin(), d.end());
+    ref.insert(ref.end() - 1, rd.begin(), rd.end());
+    assert(allocations == 0);
+    check(v, ref);
+
+    v.assign(d.begin(), d.end());
+    print("assign deque", v);
+    check(v, rd);
+    v.assign(3, 7);     // 整数参数是 (n, x)，不是区间
+    print("assign(3, 7)", v);
+    check(v, std::vector<int>(3, 7));
+    ivector w(4, 9);
+    check(w, std::vector<int>(4, 9));
+
+    // 只能走访一次的区间：构造、插入、赋值的结果与前向区间相同
+    int raw[300];
+    for (int i = 0; i < 300; ++i)
+        raw[i] = i * 3;
+    std::vector<int> rraw(raw, raw + 300);
+    ivector in(input_iter(raw), input_iter(raw + 300));
+    check(in, rraw);
+    in.insert(in.begin() + 100, input_iter(raw), input_iter(raw + 50));
+    rraw.insert(rraw.begin() + 100, raw, raw + 50);
+    check(in, rraw);
+    in.assign(input_iter(raw + 10), input_iter(raw + 20));     // 缩短
+    check(in, std::vector<int>(raw + 10, raw + 20));
+    in.assign(input_iter(raw), input_iter(raw + 200));         // 加长
+    check(in, std::vector<int>(raw, raw + 200));
+    input_iter none(raw);
+    ivector empty(none, none);
+    assert(empty.empty());
+    assert(in.insert(in.begin() + 3, none, none) == in.begin() + 3);
+
+    // 把一百万个元素的 list 接到 vector 尾端
+    SimpleSTL::list<int> big;
+    for (int i = 0; i < 1000000; ++i)
+        big.push_back(i);
+
+    allocations = 0;
+    ivector a;
+    for (SimpleSTL::list<int>::iterator i = big.begin(); i != big.end(); ++i)
+        a.push_back(*i);
+    cout << "push_back one by one: " << allocations << " allocations" << endl;
+    assert(allocations > 1);
+
+    allocations = 0;
+    ivector b;
+    b.insert(b.end(), big.begin(), big.end());
+    cout << "insert(end, first, last): " << allocations << " allocations, size=" << b.size() << endl;
+    assert(allocations == 1 && b.size() == 1000000 && b.capacity() == 1000000);
+    for (int i = 0; i < 1000000; i += 999)
+        assert(b[i] == i);
+    cout << "ok" << endl;
+}
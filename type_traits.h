@@ -258,6 +258,32 @@ namespace SimpleSTL
 		typedef _true_type has_trivial_destructor;
 		typedef _true_type is_POD_type;
 	};
+
+	// 可以逐位元搬移（trivially relocatable）的型别：对象的内容原样搬到另一块内存之后，
+	// 不经复制构造、析构即可继续使用。POD 都是；不持有指向自身的指针的类别（例如 vector）也是，
+	// 可以为其特化本模板。容器据此改以 realloc 扩充空间，能就地延伸时完全不必复制。
+	// 注意 libstdc++ 的 std::string 持有指向自身内部缓冲区的指针，不是
+	template <class T>
+	struct _is_trivially_relocatable
+	{
+		typedef typename _type_traits<T>::is_POD_type type;
+	};
+
+	// 判断型别是否为整数：容器的 (first, last) 区间函数以此区分 vector<int> v(5, 1) 这类「个数、初值」的呼叫
+	template <class T> struct _is_integer { typedef _false_type _integral; };
+	template <> struct _is_integer<bool> { typedef _true_type _integral; };
+	template <> struct _is_integer<char> { typedef _true_type _integral; };
+	template <> struct _is_integer<signed char> { typedef _true_type _integral; };
+	template <> struct _is_integer<unsigned char> { typedef _true_type _integral; };
+	template <> struct _is_integer<wchar_t> { typedef _true_type _integral; };
+	template <> struct _is_integer<short> { typedef _true_type _integral; };
+	template <> struct _is_integer<unsigned short> { typedef _true_type _integral; };
+	template <> struct _is_integer<int> { typedef _true_type _integral; };
+	template <> struct _is_integer<unsigned int> { typedef _true_type _integral; };
+	template <> struct _is_integer<long> { typedef _true_type _integral; };
+	template <> struct _is_integer<unsigned long> { typedef _true_type _integral; };
+	template <> struct _is_integer<long long> { typedef _true_type _integral; };
+	template <> struct _is_integer<unsigned long long> { typedef _true_type _integral; };
 }
 
 #endif
\ No newline at end of file
@@ -6,10 +6,53 @@
 #include "./memory.h"
 #include "./algorithm.h"
 #include "./stl_iterator.h"
+#include "./stl_growth.h"
 
 namespace SimpleSTL {
-	template<class T, class Alloc = alloc2>
-	class vector {
+    // 构造函数与 resize 的标记：元素只做预设初始化（default-initialize）。
+    // 默认构造函数是 trivial 的型别（int、double、POD 结构）因此完全不写入内存，适合马上就要整块覆写的缓冲区
+    struct default_init_t {};
+    const default_init_t default_init = default_init_t();
+
+    // small_vector 所用的配置器：空间配置与 Alloc 完全相同，只用来告诉 vector 另有 N 个元素的内部空间
+    template <size_t N, class Alloc>
+    struct __inline_alloc : public Alloc {};
+
+    // 配置器是否提供 reallocate。SimpleSTL 的配置器都有；使用者自订的配置器可以只有 allocate、deallocate
+    template <class Alloc>
+    struct __has_reallocate
+    {
+        template <class A> static _true_type test(decltype(&A::reallocate));
+        template <class A> static _false_type test(...);
+        typedef decltype(test<Alloc>(0)) type;
+    };
+
+    // 元素可以逐位元搬移、配置器又提供 reallocate 时，vector 扩充时才改用 reallocate
+    template <class T, class Alloc, class Relocatable = typename _is_trivially_relocatable<T>::type>
+    struct __vector_can_reallocate { typedef _false_type type; };
+    template <class T, class Alloc>
+    struct __vector_can_reallocate<T, Alloc, _true_type> { typedef typename __has_reallocate<Alloc>::type type; };
+
+    // vector 的内部空间。一般的 vector 没有内部空间，这个空的基类不占任何内存，
+    // 以下两个函数也都是常数，相关的判断会被编译器消去
+    template <class T, class Alloc>
+    struct __vector_inline_storage
+    {
+        T *inline_buffer() const { return 0; }
+        static size_t inline_capacity() { return 0; }
+    };
+
+    template <class T, size_t N, class Alloc>
+    struct __vector_inline_storage<T, __inline_alloc<N, Alloc> >
+    {
+        alignas(T) unsigned char buffer[sizeof(T) * N];
+
+        T *inline_buffer() const { return (T *)buffer; }
+        static size_t inline_capacity() { return N; }
+    };
+
+	template<class T, class Alloc = alloc2, class Growth = growth_double>
+	class vector : protected __vector_inline_storage<T, Alloc> {
 	public:
 		// vector 的嵌套型别定义
 		typedef T           value_type;
@@ -29,16 +72,56 @@ namespace SimpleSTL {
 		iterator end_of_storage;   //表示目前可用空间的尾
 
 		iterator insert_aux(iterator position, const T& x);
+		iterator reallocate_insert_aux(iterator position, const T& x);
+		// 元素放在内部空间时不必释放
+		bool is_inline() const {
+			return this->inline_capacity() != 0 && start == this->inline_buffer();
+		}
 		void deallocate() {
-			if (start) {
+			if (start && !is_inline()) {
 				data_allocator::deallocate(start, end_of_storage - start);
 			}
 		}
+		// 构造时配置容纳 n 个元素的空间：内部空间够用就用内部空间
+		iterator allocate_storage(size_type n) {
+			return n <= this->inline_capacity() ? this->inline_buffer()
+			                                    : data_allocator::allocate(n);
+		}
+		void set_storage(iterator p, size_type n) {
+			start = p;
+			finish = p + n;
+			end_of_storage = is_inline() ? p + this->inline_capacity() : finish;
+		}
+		void swap_elements(vector<T, Alloc, Growth>& __x);
+
+		// 元素可以逐位元搬移、且空间是向 malloc 配置来的，扩充时就改用 reallocate。
+		// 不超过 __MAX_BYTES 的小区块由 alloc2 的记忆池供应，realloc 无从就地延伸，仍照常复制
+		typedef typename __vector_can_reallocate<T, Alloc>::type reallocate_tag;
+		bool can_reallocate() const { return can_reallocate(reallocate_tag()); }
+		bool can_reallocate(_false_type) const { return false; }
+		bool can_reallocate(_true_type) const {
+			return capacity() * sizeof(T) > (size_t)alloc2::__MAX_BYTES && !is_inline();
+		}
+		void reallocate_storage(size_type n) { reallocate_storage(n, reallocate_tag()); }
+		void reallocate_storage(size_type n, _true_type) {
+			const size_type old_size = size();
+			start = data_allocator::reallocate(start, capacity(), n);
+			finish = start + old_size;
+			end_of_storage = start + n;
+		}
+		// 配置器没有 reallocate：配置新空间、复制元素
+		void reallocate_storage(size_type n, _false_type) {
+			const size_type old_size = size();
+			iterator tmp = allocate_and_copy(n, start, finish);
+			destroy(start, finish);
+			deallocate();
+			start = tmp;
+			finish = tmp + old_size;
+			end_of_storage = tmp + n;
+		}
         
         void fill_initialize(size_type n, const T& value) {
-        	start = allocate_and_fill(n, value);
-        	finish = start + n;
-        	end_of_storage = finish;
+        	set_storage(allocate_and_fill(n, value), n);
         }
 
     public:
@@ -46,35 +129,43 @@ namespace SimpleSTL {
         iterator end() const  { return finish; }
         size_type size() const { return size_type(end() - begin()); }
         size_type capacity() const { return size_type(end_of_storage - begin()); }
+        // 已配置而未使用的元素个数
+        size_type slack() const { return size_type(end_of_storage - end()); }
         bool empty() const { return begin() == end(); }
         reference operator[](size_type n) { return *(begin() + n); }
 
-        vector() : start(0), finish(0), end_of_storage(0) {}
+        vector() { set_storage(this->inline_buffer(), 0); }
         vector(size_type n, const T& value) { fill_initialize(n, value);}
         vector(int n, const T& value) { fill_initialize(n, value);} 
         vector(long n, const T& value) { fill_initialize(n, value);}
         vector(const std::initializer_list<T> v) {
-            auto _start = v.begin();
-            auto _end = v.end();
-            size_type n = v.size();
-            fill_initialize(n, T());
-            finish = SimpleSTL::copy(_start, _end, start);            
-        }
-        vector(T* first, T* last) {
-            auto _start = first;
-            auto _end = last;
-            size_type n = last - first + 1;
-            fill_initialize(n, T());
-            this->finish = SimpleSTL::copy(_start, _end, start);
+            range_initialize(v.begin(), v.end(), forward_iterator_tag());
+        }
+        // 以 [first, last) 初始化：前向以上的迭代器先算出长度，一次配置；
+        // 两个引数都是整数时（vector<double> v(5, 1)）视为个数与初值
+        template <class InputIterator>
+        vector(InputIterator first, InputIterator last) {
+            typedef typename _is_integer<InputIterator>::_integral _Integral;
+            initialize_aux(first, last, _Integral());
         }
         explicit vector(size_type n) { fill_initialize(n, T()); }
+        vector(size_type n, default_init_t) {
+            set_storage(allocate_storage(n), n);
+            finish = SimpleSTL::uninitialized_default_n(start, n);
+        }
 
-        // TO DO 缺少一个拷贝构造函数，需要补写
-        vector(const vector<T, Alloc>& __x) 
+        vector(const vector<T, Alloc, Growth>& __x) 
         { 
             size_type n = __x.size();
-            fill_initialize(n, T());
-            finish = uninitialized_copy(__x.begin(), __x.end(), start); 
+            set_storage(allocate_and_copy(n, __x.begin(), __x.end()), n);
+        }
+
+        vector<T, Alloc, Growth>& operator=(const vector<T, Alloc, Growth>& __x) {
+            if (this != &__x) {
+                vector<T, Alloc, Growth> tmp(__x);
+                swap(tmp);
+            }
+            return *this;
         }
 
         ~vector() {
@@ -111,20 +202,46 @@ namespace SimpleSTL {
         }
         
         void resize(size_type new_size) { resize(new_size, T());}
+        // 与 resize 相同，但新增的元素只做预设初始化，内容未定，须由呼叫端自行写入
+        void resize_default_init(size_type new_size) {
+            if (new_size <= size()) {
+                erase(begin() + new_size, end());
+                return;
+            }
+            if (new_size > capacity())
+                reserve(Growth::next(capacity(), new_size));
+            finish = SimpleSTL::uninitialized_default_n(finish, new_size - size());
+        }
+        // 在尾端追加 n 个预设初始化的元素，传回其中第一个的位置，例如 read(fd, v.reserve_and_construct_uninitialized(n), n)
+        iterator reserve_and_construct_uninitialized(size_type n) {
+            const size_type old_size = size();
+            resize_default_init(old_size + n);
+            return start + old_size;
+        }
         void clear() { erase(begin(), end());}
         void reserve(size_type n) {
-            if (capacity() < n) {
+            if (capacity() < n && can_reallocate()) {
+                reallocate_storage(n);
+            }
+            else if (capacity() < n) {
                 const size_type old_size = size();
                 iterator tmp = allocate_and_copy(n, start, finish);
                 destroy(start, finish);
-                data_allocator::deallocate(start, end_of_storage - start);
+                deallocate();
                 start = tmp;
                 finish = tmp + old_size;
                 end_of_storage = start + n;
             }
         }
         
-        void swap(vector<T>& __x) {
+        void shrink_to_fit();
+
+        void swap(vector<T, Alloc, Growth>& __x) {
+            // 元素在内部空间中时无法交换指针，只能交换元素
+            if (is_inline() || __x.is_inline()) {
+                swap_elements(__x);
+                return;
+            }
             std::swap(start, __x.start);
             std::swap(finish, __x.finish);
             std::swap(end_of_storage, __x.end_of_storage);
@@ -132,13 +249,74 @@ namespace SimpleSTL {
 
         iterator insert(iterator position, const T& x);
         iterator insert(iterator position, size_type n, const T& x);
-        iterator insert(iterator position, iterator first, iterator last);
+        // 插入 [first, last)，传回第一个新元素的位置。[first, last) 不可指向本 vector
+        template <class InputIterator>
+        iterator insert(iterator position, InputIterator first, InputIterator last) {
+            typedef typename _is_integer<InputIterator>::_integral _Integral;
+            return insert_dispatch(position, first, last, _Integral());
+        }
+
+        void assign(size_type n, const T& x);
+        template <class InputIterator>
+        void assign(InputIterator first, InputIterator last) {
+            typedef typename _is_integer<InputIterator>::_integral _Integral;
+            assign_dispatch(first, last, _Integral());
+        }
 
     protected:
+        template <class Integer>
+        void initialize_aux(Integer n, Integer value, _true_type) {
+            fill_initialize(n, value);
+        }
+        template <class InputIterator>
+        void initialize_aux(InputIterator first, InputIterator last, _false_type) {
+            range_initialize(first, last, iterator_category(first));
+        }
+        // 只能走访一次的区间无法事先得知长度，只能逐一放入
+        template <class InputIterator>
+        void range_initialize(InputIterator first, InputIterator last, input_iterator_tag) {
+            set_storage(this->inline_buffer(), 0);
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+        template <class ForwardIterator>
+        void range_initialize(ForwardIterator first, ForwardIterator last, forward_iterator_tag) {
+            size_type n = SimpleSTL::distance(first, last);
+            set_storage(allocate_and_copy(n, first, last), n);
+        }
+
+        template <class Integer>
+        iterator insert_dispatch(iterator position, Integer n, Integer x, _true_type) {
+            return insert(position, (size_type)n, (T)x);
+        }
+        template <class InputIterator>
+        iterator insert_dispatch(iterator position, InputIterator first, InputIterator last, _false_type) {
+            return range_insert(position, first, last, iterator_category(first));
+        }
+        template <class InputIterator>
+        iterator range_insert(iterator position, InputIterator first, InputIterator last,
+                              input_iterator_tag);
+        template <class ForwardIterator>
+        iterator range_insert(iterator position, ForwardIterator first, ForwardIterator last,
+                              forward_iterator_tag);
+
+        template <class Integer>
+        void assign_dispatch(Integer n, Integer x, _true_type) {
+            assign((size_type)n, (T)x);
+        }
+        template <class InputIterator>
+        void assign_dispatch(InputIterator first, InputIterator last, _false_type) {
+            range_assign(first, last, iterator_category(first));
+        }
+        template <class InputIterator>
+        void range_assign(InputIterator first, InputIterator last, input_iterator_tag);
+        template <class ForwardIterator>
+        void range_assign(ForwardIterator first, ForwardIterator last, forward_iterator_tag);
+
         iterator allocate_and_fill(size_type n, const T& x) {
-        	iterator result = data_allocator::allocate(n);
+        	iterator result = allocate_storage(n);
             //在获取到的内存上创建对象
-            uninitialized_fill_n(result, n, x);
+            SimpleSTL::uninitialized_fill_n(result, n, x);
             return result;
         }
 
@@ -146,18 +324,46 @@ namespace SimpleSTL {
         iterator allocate_and_copy(size_type n, ForwardIterator first, 
                                                        ForwardIterator last)
         {
-            iterator result = data_allocator::allocate(n);
-            uninitialized_copy(first, last, result);
+            iterator result = allocate_storage(n);
+            SimpleSTL::uninitialized_copy(first, last, result);
             return result;
         }
 	};
 
 
+    // 至少一方的元素在内部空间中：经由一个暂存的副本交换元素
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::swap_elements(vector<T, Alloc, Growth>& __x) {
+        vector<T, Alloc, Growth> tmp(__x);
+        __x.clear();
+        __x.reserve(size());
+        __x.finish = SimpleSTL::uninitialized_copy(start, finish, __x.start);
+        clear();
+        reserve(tmp.size());
+        finish = SimpleSTL::uninitialized_copy(tmp.start, tmp.finish, start);
+    }
+
+    // 释放闲置的空间：元素放得进内部空间就搬回内部空间，否则重新配置恰好容纳 size() 个元素的空间
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::shrink_to_fit() {
+        if (finish == end_of_storage || is_inline())
+            return;
+        const size_type n = size();
+        if (n != 0 && n > this->inline_capacity() && can_reallocate()) {
+            reallocate_storage(n);
+            return;
+        }
+        iterator tmp = allocate_and_copy(n, start, finish);
+        destroy(start, finish);
+        deallocate();
+        set_storage(tmp, n);
+    }
+
     /**************************** erase ****************************/
     // 给人感觉erase就是移动元素的位置
     // 清除某个位置上的元素
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator position) {
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(iterator position) {
     	if (position + 1 != end())
     		SimpleSTL::copy(position + 1, finish, position);
         --finish;
@@ -166,8 +372,8 @@ namespace SimpleSTL {
     }
 
     // 清除[first, last)中的所有元素
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::erase
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase
     (iterator first, iterator last) {
 	    iterator i = SimpleSTL::copy(last, finish, first);
         destroy(i, finish);
@@ -177,8 +383,8 @@ namespace SimpleSTL {
 
     /**************************** insert ****************************/
     // single element (1)	
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(
         iterator position, const T& x)
     {
         // return insert_aux(position, x); 有bug
@@ -187,8 +393,8 @@ namespace SimpleSTL {
     
 
     // fill(2)
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(
         iterator position, size_type n, const T& x) 
     {
         if (n <= 0) return position;
@@ -214,29 +420,35 @@ namespace SimpleSTL {
             
             // 书中的算法过于繁琐，下面的逻辑很简单
             T x_copy = x;
-            uninitialized_fill_n(finish, n, x_copy);    // 初始化未初始化内存
+            SimpleSTL::uninitialized_fill_n(finish, n, x_copy);    // 初始化未初始化内存
             // 注意这里要使用copy_backword，不然会覆盖后面要移动的值
             SimpleSTL::copy_backward(position, finish, finish + n);             
             SimpleSTL::fill(position, position + n, x_copy);               
             finish += n;
             return position;
         } 
+        else if (can_reallocate()) {
+            // x 可能就是本 vector 的元素，reallocate 之后即失效
+            T x_copy = x;
+            const difference_type off = position - start;
+            reallocate_storage(Growth::next(capacity(), size() + n));
+            return insert(start + off, n, x_copy);
+        }
         else {
             // 备用空间小于新增元素个数（必须配置额外的内存）
             const size_type old_size = size();
-            // const size_type new_size = old_size + std::max(old_size, n);
-            const size_type new_size = old_size != 0 ? 2 * old_size : 1;
+            const size_type new_size = Growth::next(capacity(), old_size + n);
             // 以下配置新的 vector 空间
             iterator new_start = data_allocator::allocate(new_size);
             iterator new_finish = new_start;
             try {
                 // 首先将旧vector的插入点之前的元素复制到新空间
                 if (start != position)
-                    new_finish = uninitialized_copy(start, position, new_start);                   
+                    new_finish = SimpleSTL::uninitialized_copy(start, position, new_start);                   
                 // 再将新增元素（初值皆为n）填入新空间
-                new_finish = uninitialized_fill_n(new_finish, n, x);
+                new_finish = SimpleSTL::uninitialized_fill_n(new_finish, n, x);
                 // 再将旧vector的插入点之后的元素复制到新空间
-                new_finish = uninitialized_copy(position, finish, new_finish);                               
+                new_finish = SimpleSTL::uninitialized_copy(position, finish, new_finish);                               
             }
             catch(...) {
                 // 如有异常发生，实现“commit or rollback” semantics
@@ -259,8 +471,8 @@ namespace SimpleSTL {
 
     /*  这个算法使用 insert_aux，简单但不高效。
     // fill(2)
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(
         iterator position, size_type n, const T& x)
     {
         iterator iter = position;
@@ -272,66 +484,61 @@ namespace SimpleSTL {
     }
     */
 
-    // range (3)	
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(
-        iterator position, iterator _first, iterator _last)
+    // range (3)：只能走访一次的区间逐一插入
+    template<class T, class Alloc, class Growth>
+    template<class InputIterator>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::range_insert(
+        iterator position, InputIterator first, InputIterator last, input_iterator_tag)
     {
-        int n = _last - _first;
-        if (n <= 0) return position;
-        if (size_type(end_of_storage - finish) >= n)
-        {
-            uninitialized_fill_n(finish, n, T());    // 初始化未初始化内存
-            // 注意这里要使用copy_backword，不然会覆盖后面要移动的值
-            SimpleSTL::copy_backward(position, finish, finish + n);               
-            iterator cur = position;
-            for (int i = 0; i < n; ++i)
-                *(cur+i) = *(_first++);                
-            finish += n;
-            return position;
-           /*
+        const difference_type off = position - start;
+        for (iterator cur = position; first != last; ++first) {
+            cur = insert(cur, *first);
+            ++cur;
+        }
+        return start + off;
+    }
+
+    // range (3)：前向以上的区间先算出长度，至多重新配置一次，新元素直接构造在最终的位置上
+    template<class T, class Alloc, class Growth>
+    template<class ForwardIterator>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::range_insert(
+        iterator position, ForwardIterator first, ForwardIterator last, forward_iterator_tag)
+    {
+        if (first == last) return position;
+        const size_type n = SimpleSTL::distance(first, last);
+        if (size_type(end_of_storage - finish) < n && can_reallocate()) {
+            const difference_type off = position - start;
+            reallocate_storage(Growth::next(capacity(), size() + n));
+            position = start + off;
+        }
+        if (size_type(end_of_storage - finish) >= n) {
             const size_type elems_after = finish - position;
             iterator old_finish = finish;
-            if (elems_after > n) {  // 插入点之后的现有元素大于新增元素个数
+            if (elems_after > n) {  // 插入点之后的现有元素多于新增元素个数
                 SimpleSTL::uninitialized_copy(finish - n, finish, finish);
                 finish += n;
                 SimpleSTL::copy_backward(position, old_finish - n, old_finish);
-                // SimpleSTL::fill(position, position + n, x_copy);  // 从插入点开始填入新值
-                iterator cur = position;
-                for (int i = 0; i < n; ++i)
-                    *(cur+i) = *(_first++);
+                SimpleSTL::copy(first, last, position);
             }
-            else { // 插入点之后的现有元素小于新增元素个数
-                SimpleSTL::uninitialized_fill_n(finish, n - elems_after, T());
-                finish += n - elems_after;
-                SimpleSTL::uninitialized_copy(position, old_finish, finish);
-                finish += elems_after;
-                // SimpleSTL::fill(position, old_finish, x_copy);  // 从插入点开始填入新值
-                iterator cur = position;
-                for (int i = 0; i < n; ++i)
-                    *(cur+i) = *(_first++);
+            else {  // 新增元素有一部分落在未初始化的空间上
+                ForwardIterator mid = first;
+                SimpleSTL::advance(mid, elems_after);
+                finish = SimpleSTL::uninitialized_copy(mid, last, finish);
+                finish = SimpleSTL::uninitialized_copy(position, old_finish, finish);
+                SimpleSTL::copy(first, mid, position);
             }
-            */
+            return position;
         }
         else {
             // 备用空间小于新增元素个数（必须配置额外的内存）
             const size_type old_size = size();
-            // const size_type new_size = old_size + std::max(old_size, n);
-            const size_type new_size = old_size != 0 ? 2 * old_size : 1;
-            // 以下配置新的 vector 空间
+            const size_type new_size = Growth::next(capacity(), old_size + n);
             iterator new_start = data_allocator::allocate(new_size);
             iterator new_finish = new_start;
             try {
-                // 1.首先将旧vector的插入点之前的元素复制到新空间
-                new_finish = uninitialized_copy(start, position, new_start);  
-                // 2.再将新增元素填入新空间
-                new_finish = uninitialized_fill_n(new_finish, n, T());
-                iterator cur = new_finish - n;  // 这里必须要减n，前面new_finish的值由于填充增加了。
-                for (int i = 0; i < n; ++i) { 
-                    *(cur++) = *(_first++);
-                }
-                // 3.再将旧vector的插入点之后的元素复制到新空间
-                new_finish = uninitialized_copy(position, finish, new_finish);                                   
+                new_finish = SimpleSTL::uninitialized_copy(start, position, new_start);
+                new_finish = SimpleSTL::uninitialized_copy(first, last, new_finish);
+                new_finish = SimpleSTL::uninitialized_copy(position, finish, new_finish);
             }
             catch(...) {
                 // 如有异常发生，实现“commit or rollback” semantics
@@ -339,23 +546,88 @@ namespace SimpleSTL {
                 data_allocator::deallocate(new_start, new_size);
                 throw;
             }
-            
+
             // 以下清除并释放旧的vector
             destroy(start, finish);
             deallocate();
-            iterator ret = new_start + (position - start + 1);
+            iterator ret = new_start + (position - start);
             start = new_start;
             finish = new_finish;
             end_of_storage = new_start + new_size;
-            
+
             return ret;
         }
     }
 
-    
+    /**************************** assign ****************************/
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::assign(size_type n, const T& x) {
+        if (n > capacity()) {
+            vector<T, Alloc, Growth> tmp(n, x);
+            swap(tmp);
+        }
+        else if (n > size()) {
+            T x_copy = x;   // x 可能就是本 vector 的元素
+            SimpleSTL::fill(start, finish, x_copy);
+            finish = SimpleSTL::uninitialized_fill_n(finish, n - size(), x_copy);
+        }
+        else {
+            erase(SimpleSTL::fill_n(start, n, x), finish);
+        }
+    }
+
+    // 只能走访一次的区间：先覆写现有元素，多出来的再逐一插入
+    template<class T, class Alloc, class Growth>
+    template<class InputIterator>
+    void vector<T, Alloc, Growth>::range_assign(InputIterator first, InputIterator last,
+                                                input_iterator_tag) {
+        iterator cur = start;
+        for (; first != last && cur != finish; ++first, ++cur)
+            *cur = *first;
+        if (first == last)
+            erase(cur, finish);
+        else
+            range_insert(finish, first, last, input_iterator_tag());
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class ForwardIterator>
+    void vector<T, Alloc, Growth>::range_assign(ForwardIterator first, ForwardIterator last,
+                                                forward_iterator_tag) {
+        const size_type n = SimpleSTL::distance(first, last);
+        if (n > capacity()) {
+            iterator tmp = allocate_and_copy(n, first, last);
+            destroy(start, finish);
+            deallocate();
+            set_storage(tmp, n);
+        }
+        else if (n > size()) {
+            ForwardIterator mid = first;
+            SimpleSTL::advance(mid, size());
+            SimpleSTL::copy(first, mid, start);
+            finish = SimpleSTL::uninitialized_copy(mid, last, finish);
+        }
+        else {
+            erase(SimpleSTL::copy(first, last, start), finish);
+        }
+    }
+
     /**************************** insert_aux ****************************/
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::insert_aux(
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::reallocate_insert_aux(
+        iterator position, const T& x) {
+        T x_copy = x;   // x 可能就是本 vector 的元素，reallocate 之后即失效
+        const difference_type off = position - start;
+        reallocate_storage(Growth::next(capacity(), size() + 1));
+        if (start + off == finish) {    // push_back
+            construct(finish, x_copy);
+            return finish++;
+        }
+        return insert_aux(start + off, x_copy);
+    }
+
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert_aux(
         iterator position, const T& x) {
         if (finish != end_of_storage) { // 还有备用空间            
             construct(finish, *(finish - 1));   //在备用空间起始处构建一个对象，并以vector的最后一个元素值为其初值
@@ -366,20 +638,23 @@ namespace SimpleSTL {
             
             return position;
         } 
+        else if (can_reallocate()) {    // 就地延伸，或由 realloc 整块搬移
+            return reallocate_insert_aux(position, x);
+        }
         else {  // 已无备用空间
             const size_type old_size = size();
-            const size_type new_size = old_size != 0 ? 2 * old_size : 1;
-            // 以上配置原则：如果远大小为0，则配置1；如果原大小不为0，则配置为原大小的两倍
+            const size_type new_size = Growth::next(capacity(), old_size + 1);
+            // 以上配置原则由 Growth 决定；预设的 growth_double：如果原容量为0，则配置1，否则配置为原容量的两倍
             // 前半段用来放置原数据，后半段准备用来放置新数据
             
             iterator new_start = data_allocator::allocate(new_size);
             iterator new_finish = new_start;
             try {
-                new_finish = uninitialized_copy(start, position, new_start);
+                new_finish = SimpleSTL::uninitialized_copy(start, position, new_start);
                 construct(new_finish, x);
                 ++new_finish;
                 // 将安插点之后的原内容拷贝过来（提示：本函数也可能被insert(p,x)调用）
-                new_finish = uninitialized_copy(position, finish, new_finish);
+                new_finish = SimpleSTL::uninitialized_copy(position, finish, new_finish);
             } 
             catch (...) {
                 // "commit or rollback" semantics
@@ -398,6 +673,17 @@ namespace SimpleSTL {
             return ret;
         }
     }
+
+    // vector 只持有指向堆空间的指针，可以逐位元搬移；元素可能位于内部空间的 small_vector 不行
+    template <class T, class Alloc, class Growth>
+    struct _is_trivially_relocatable<vector<T, Alloc, Growth> > { typedef _true_type type; };
+    template <class T, size_t N, class Alloc, class Growth>
+    struct _is_trivially_relocatable<vector<T, __inline_alloc<N, Alloc>, Growth> > { typedef _false_type type; };
+
+    // 元素对齐到 Align bytes、不小于 HugeThreshold 的空间改用大分页的 vector，例如 aligned_vector<double, 64>。
+    // 配置的统计数字见 align_alloc<Align, HugeThreshold>::stats()
+    template <class T, size_t Align = 64, size_t HugeThreshold = huge_page_size, class Growth = growth_double>
+    using aligned_vector = vector<T, align_alloc<Align, HugeThreshold>, Growth>;
 }
 
 #endif
\ No newline at end of file